@@ -0,0 +1,497 @@
+#include "sal.h"
+
+// sal_bench: times SAL on synthetic WAVE files and prints the results as JSON so runs can be diffed.
+//
+// usage: sal_bench [--dir DIR] [--max-size SIZE] [--min-time SECONDS] [--out FILE] [--no-openal]
+//
+//  --dir       where the synthetic files are written. one at a time, each is deleted when done. (default .)
+//  --max-size  largest data chunk to try. sizes go 1K, 32K, 1M, 32M, 1G and 2G. K, M and G suffixes work. (default 32M)
+//  --min-time  how long each measurement keeps repeating for. (default 0.25)
+//  --out       write the JSON here instead of stdout.
+//  --no-openal skip everything that needs a device.
+//
+// the OpenAL parts use the OpenAL Soft null backend unless ALSOFT_DRIVERS says otherwise,
+// so this runs fine on a headless box. parse numbers are with the file in the page cache.
+
+#ifndef SAL_VERSION
+#define SAL_VERSION "unknown"
+#endif // SAL_VERSION
+
+#define BENCH_SAMPLE_RATE 48000
+#define BENCH_BLOCK_FRAMES 4096
+#define BENCH_KERNEL_BYTES (8 << 20)
+#define BENCH_LATENCY_RUNS 25
+#define BENCH_LATENCY_MAX_SIZE (32ull << 20)
+#define BENCH_FILE_NAME "sal_bench.wav"
+
+static const SLuint bench_pcm_types[] = { SL_UNSIGNED_8PCM, SL_SIGNED_16PCM, SL_SIGNED_24PCM, SL_SIGNED_32PCM, SL_FLOAT_32PCM, SL_FLOAT_64PCM };
+static const SLushort bench_channels[] = { 1, 2, 6 };
+static const SLullong bench_sizes[] = { 1ull << 10, 32ull << 10, 1ull << 20, 32ull << 20, 1ull << 30, 2ull << 30 };
+
+typedef SL_RETURN_CODE (*BENCH_FN)(void* ctx);
+
+typedef struct bench_timing {
+    SLdouble best; // fastest single run in seconds.
+    SLdouble total; // all runs together in seconds.
+    SLuint runs;
+} BENCH_TIMING;
+
+typedef struct bench_options {
+    const char* dir;
+    SLullong maxSize;
+    SLdouble minTime;
+    const char* out;
+    SLbool openal;
+} BENCH_OPTIONS;
+
+// everything one measurement needs. only the fields its function uses are filled in
+typedef struct bench_ctx {
+    const char* path;
+    SL_WAV_FILE* wav;
+    const void* src;
+    SLvoid dst;
+    SLuint srcType;
+    SLuint dstType;
+    SLullong size;
+} BENCH_CTX;
+
+static FILE* bench_out;
+static SLbool bench_first;
+
+static const char* bench_pcm_name(SLuint pcmType) {
+    switch (pcmType) {
+        case SL_UNSIGNED_8PCM: return "u8";
+        case SL_SIGNED_16PCM: return "s16";
+        case SL_SIGNED_24PCM: return "s24";
+        case SL_SIGNED_32PCM: return "s32";
+        case SL_FLOAT_32PCM: return "f32";
+        case SL_FLOAT_64PCM: return "f64";
+        default: return "unknown";
+    }
+}
+
+static const char* bench_simd_name(SLuint level) {
+    switch (level) {
+        case SL_SIMD_SSE2: return "sse2";
+        case SL_SIMD_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+static void bench_json_string(const char* str) {
+    fputc('"', bench_out);
+    for (; str != NULL && *str; str++) {
+        if (*str == '"' || *str == '\\') fprintf(bench_out, "\\%c", *str);
+        else if ((unsigned char) *str < 0x20) fprintf(bench_out, "\\u%04x", (unsigned char) *str);
+        else fputc(*str, bench_out);
+    }
+    fputc('"', bench_out);
+}
+
+// starts a result object. the caller adds its own fields and closes it with bench_end_result
+static void bench_begin_result(const char* bench, const char* simd, SLuint pcmType, SLushort channels, SLullong bytes) {
+    fprintf(bench_out, "%s\n    {\"bench\": ", bench_first ? "" : ",");
+    bench_first = 0;
+
+    bench_json_string(bench);
+    if (simd != NULL) {
+        fprintf(bench_out, ", \"simd\": ");
+        bench_json_string(simd);
+    }
+    fprintf(bench_out, ", \"pcm\": \"%s\"", bench_pcm_name(pcmType));
+    if (channels != 0) fprintf(bench_out, ", \"channels\": %u", channels);
+    fprintf(bench_out, ", \"bytes\": %llu", (unsigned long long) bytes);
+}
+
+static void bench_end_result(void) {
+    fputc('}', bench_out);
+    fflush(bench_out);
+}
+
+static void bench_throughput_result(const char* bench, const char* simd, SLuint pcmType, SLushort channels, SLullong bytes, SL_RETURN_CODE ret, const BENCH_TIMING* timing) {
+    bench_begin_result(bench, simd, pcmType, channels, bytes);
+
+    if (ret != SL_SUCCESS) fprintf(bench_out, ", \"error\": %d", ret);
+    else fprintf(bench_out, ", \"runs\": %u, \"best_mb_s\": %.2f, \"mean_mb_s\": %.2f",
+                 timing->runs, bytes / timing->best / 1e6, bytes * timing->runs / timing->total / 1e6);
+
+    bench_end_result();
+}
+
+// keeps calling fn until minTime has passed. it always runs at least once
+static SL_RETURN_CODE bench_run(BENCH_FN fn, void* ctx, SLdouble minTime, BENCH_TIMING* timing) {
+    memset(timing, 0, sizeof(BENCH_TIMING));
+
+    do {
+        SLdouble start = sl_get_time();
+        SL_RETURN_CODE ret = fn(ctx);
+        SLdouble elapsed = sl_get_time() - start;
+
+        if (ret != SL_SUCCESS) return ret;
+
+        // the clock can't tell apart runs this short. don't divide by 0 later
+        if (elapsed <= 0) elapsed = 1e-9;
+
+        if (timing->runs == 0 || elapsed < timing->best) timing->best = elapsed;
+        timing->total += elapsed;
+        timing->runs++;
+    } while (timing->total < minTime);
+
+    return SL_SUCCESS;
+}
+
+static SL_RETURN_CODE bench_parse(void* ctx) {
+    BENCH_CTX* bench = (BENCH_CTX*) ctx;
+    SL_WAV_FILE wav;
+
+    SL_RETURN_CODE ret = sl_read_wave_file(bench->path, &wav);
+    if (ret == SL_SUCCESS) sl_cleanup_wave_file(&wav);
+
+    return ret;
+}
+
+static SL_RETURN_CODE bench_convert(void* ctx) {
+    BENCH_CTX* bench = (BENCH_CTX*) ctx;
+    SLullong frames = bench->size / sl_pcm_type_size(bench->srcType);
+
+    return sl_convert_samples(bench->src, bench->srcType, bench->dst, bench->dstType, frames, 1, SL_CONVERT_DEFAULT);
+}
+
+static SL_RETURN_CODE bench_swap(void* ctx) {
+    BENCH_CTX* bench = (BENCH_CTX*) ctx;
+    SLuint foreign = sl_get_native_endianness() == SL_LITTLE_ENDIAN ? SL_BIG_ENDIAN : SL_LITTLE_ENDIAN;
+
+    return sl_ensure_endianness(bench->dst, bench->size, bench->srcType, foreign);
+}
+
+#ifdef SL_OPENAL_WRAPPER
+static SL_RETURN_CODE bench_gen_sound(void* ctx) {
+    BENCH_CTX* bench = (BENCH_CTX*) ctx;
+    SL_SOUND sound;
+
+    SL_RETURN_CODE ret = sl_gen_sound_a(&sound, bench->wav, 1.f, 1.f);
+
+    // only the conversion is ours. the wave file is used again next run
+    sl_free(sound.converted);
+
+    return ret;
+}
+#endif // SL_OPENAL_WRAPPER
+
+// fills the buffer with a quiet sine in every channel, converted to pcmType
+static SL_RETURN_CODE bench_make_block(SLvoid block, SLuint pcmType, SLushort channels, SLullong startFrame) {
+    SLfloat samples[BENCH_BLOCK_FRAMES];
+
+    for (SLuint i = 0; i < BENCH_BLOCK_FRAMES; i++)
+        samples[i] = 0.5f * (SLfloat) sin(2.0 * 3.14159265358979 * 440.0 * (SLdouble) (startFrame + i) / BENCH_SAMPLE_RATE);
+
+    // one channel at a time so the whole block is the same wave
+    for (SLushort c = 0; c < channels; c++) {
+        SLuint size = sl_pcm_type_size(pcmType);
+        SLuchar mono[BENCH_BLOCK_FRAMES * sizeof(SLdouble)];
+
+        SL_RETURN_CODE ret = sl_convert_samples(samples, SL_FLOAT_32PCM, mono, pcmType, BENCH_BLOCK_FRAMES, 1, SL_CONVERT_DEFAULT);
+        if (ret != SL_SUCCESS) return ret;
+
+        for (SLuint i = 0; i < BENCH_BLOCK_FRAMES; i++)
+            memcpy((SLuchar*) block + ((SLullong) i * channels + c) * size, mono + (SLullong) i * size, size);
+    }
+
+    return SL_SUCCESS;
+}
+
+static SL_RETURN_CODE bench_write_file(const char* path, SLuint pcmType, SLushort channels, SLullong size) {
+    SL_WAV_WRITER writer;
+    SLuint blockAlign = sl_pcm_type_size(pcmType) * channels;
+    SLullong frames = size / blockAlign;
+    SLvoid block = malloc((SLullong) BENCH_BLOCK_FRAMES * blockAlign);
+    SL_RETURN_CODE ret;
+
+    if (block == NULL) return SL_MALLOC_FAIL;
+
+    ret = sl_open_wave_writer(&writer, path, pcmType, channels, BENCH_SAMPLE_RATE, SL_WRITE_DEFAULT);
+    if (ret != SL_SUCCESS) goto exit;
+
+    for (SLullong done = 0; done < frames && ret == SL_SUCCESS; done += BENCH_BLOCK_FRAMES) {
+        SLullong count = frames - done < BENCH_BLOCK_FRAMES ? frames - done : BENCH_BLOCK_FRAMES;
+
+        ret = bench_make_block(block, pcmType, channels, done);
+        if (ret == SL_SUCCESS) ret = sl_write_wave_frames(&writer, block, count);
+    }
+
+    if (sl_close_wave_writer(&writer) != SL_SUCCESS && ret == SL_SUCCESS) ret = SL_FILE_ERROR;
+
+    exit:
+        free(block);
+        return ret;
+}
+
+// converting to and from f32 is what every kernel does, and swapping is what RIFX files need
+static void bench_kernels(const BENCH_OPTIONS* options) {
+    SLvoid src = malloc(BENCH_KERNEL_BYTES);
+    SLvoid dst = malloc(BENCH_KERNEL_BYTES * 2);
+    SLuint maxLevel = sl_get_simd_level();
+
+    if (src == NULL || dst == NULL) goto exit;
+
+    for (SLuint level = SL_SIMD_SCALAR; level <= maxLevel; level++) {
+        sl_set_simd_level((SLint) level);
+        if (sl_get_simd_level() != level) continue;
+
+        for (SLuint t = 0; t < sizeof(bench_pcm_types) / sizeof(bench_pcm_types[0]); t++) {
+            SLuint pcmType = bench_pcm_types[t];
+            SLuint sampleSize = sl_pcm_type_size(pcmType);
+            SLullong samples = BENCH_KERNEL_BYTES / sizeof(SLdouble);
+            BENCH_CTX ctx;
+            BENCH_TIMING timing;
+            SL_RETURN_CODE ret;
+
+            for (SLullong i = 0; i < samples; i += BENCH_BLOCK_FRAMES) bench_make_block((SLuchar*) src + i * sampleSize, pcmType, 1, i);
+
+            memset(&ctx, 0, sizeof(BENCH_CTX));
+            ctx.src = src;
+            ctx.dst = dst;
+            ctx.srcType = pcmType;
+            ctx.dstType = SL_FLOAT_32PCM;
+            ctx.size = samples * sampleSize;
+
+            if (pcmType != SL_FLOAT_32PCM) {
+                ret = bench_run(bench_convert, &ctx, options->minTime, &timing);
+                bench_throughput_result("decode", bench_simd_name(level), pcmType, 0, ctx.size, ret, &timing);
+
+                // encode goes the other way, from the f32 decode just made
+                ctx.src = dst;
+                ctx.dst = src;
+                ctx.srcType = SL_FLOAT_32PCM;
+                ctx.dstType = pcmType;
+                ctx.size = samples * sizeof(SLfloat);
+
+                ret = bench_run(bench_convert, &ctx, options->minTime, &timing);
+                bench_throughput_result("encode", bench_simd_name(level), pcmType, 0, ctx.size, ret, &timing);
+            }
+
+            if (sampleSize > 1) {
+                ctx.dst = src;
+                ctx.srcType = pcmType;
+                ctx.size = samples * sampleSize;
+
+                ret = bench_run(bench_swap, &ctx, options->minTime, &timing);
+                bench_throughput_result("swap", bench_simd_name(level), pcmType, 0, ctx.size, ret, &timing);
+            }
+        }
+    }
+
+    exit:
+        sl_set_simd_level(-1);
+        free(src);
+        free(dst);
+}
+
+#ifdef SL_OPENAL_WRAPPER
+static int bench_compare_doubles(const void* a, const void* b) {
+    SLdouble x = *(const SLdouble*) a, y = *(const SLdouble*) b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_latency_result(const char* bench, SLuint pcmType, SLushort channels, SLullong bytes, SL_RETURN_CODE ret, SLdouble* times, SLuint runs) {
+    bench_begin_result(bench, NULL, pcmType, channels, bytes);
+
+    if (ret != SL_SUCCESS) {
+        fprintf(bench_out, ", \"error\": %d", ret);
+    } else {
+        qsort(times, runs, sizeof(SLdouble), bench_compare_doubles);
+        fprintf(bench_out, ", \"runs\": %u, \"min_us\": %.1f, \"median_us\": %.1f, \"max_us\": %.1f",
+                runs, times[0] * 1e6, times[runs / 2] * 1e6, times[runs - 1] * 1e6);
+    }
+
+    bench_end_result();
+}
+
+// time from asking for a sound to OpenAL saying it is playing
+static SL_RETURN_CODE bench_wait_playing(SL_SOUND* sound, SLdouble start, SLdouble* elapsed) {
+    ALint state = AL_INITIAL;
+
+    // virtual engine voices don't have a source to ask
+    while (sound->source != 0 && state != AL_PLAYING) {
+        alGetSourcei(sound->source, AL_SOURCE_STATE, &state);
+        if (state == AL_STOPPED) break;
+        if (sl_get_time() - start > 1.0) return SL_FAIL;
+    }
+
+    *elapsed = sl_get_time() - start;
+    return SL_SUCCESS;
+}
+
+// sl_start_sound opens its own device every time, the engine has its sources ready. both are worth knowing
+static void bench_play_start(SL_ENGINE* engine, const char* path, SLuint pcmType, SLushort channels, SLullong bytes) {
+    SLdouble times[BENCH_LATENCY_RUNS];
+    SL_WAV_FILE wav;
+    SL_SOUND sound;
+    SL_RETURN_CODE ret;
+
+    memset(&sound, 0, sizeof(SL_SOUND));
+    ret = sl_read_wave_file(path, &wav);
+    if (ret == SL_SUCCESS) ret = sl_gen_sound_a(&sound, &wav, 1.f, 1.f);
+
+    for (SLuint i = 0; i < BENCH_LATENCY_RUNS && ret == SL_SUCCESS; i++) {
+        SLdouble start = sl_get_time();
+
+        ret = sl_start_sound(&sound, NULL);
+        if (ret == SL_SUCCESS) ret = bench_wait_playing(&sound, start, &times[i]);
+        sl_stop_sound(&sound);
+    }
+
+    bench_latency_result("play_start", pcmType, channels, bytes, ret, times, BENCH_LATENCY_RUNS);
+    if (sound.waveBuf != NULL) sl_cleanup_sound(&sound);
+    else sl_cleanup_wave_file(&wav);
+
+    if (engine == NULL) return;
+
+    memset(&sound, 0, sizeof(SL_SOUND));
+    ret = sl_read_wave_file(path, &wav);
+    if (ret == SL_SUCCESS) ret = sl_engine_gen_sound(engine, &sound, &wav, 1.f, 1.f);
+
+    for (SLuint i = 0; i < BENCH_LATENCY_RUNS && ret == SL_SUCCESS; i++) {
+        SLdouble start = sl_get_time();
+
+        ret = sl_engine_play_sound(engine, &sound);
+        if (ret == SL_SUCCESS) ret = bench_wait_playing(&sound, start, &times[i]);
+        sl_stop_sound(&sound);
+    }
+
+    bench_latency_result("engine_play_start", pcmType, channels, bytes, ret, times, BENCH_LATENCY_RUNS);
+    if (sound.waveBuf != NULL) sl_cleanup_sound(&sound);
+    else sl_cleanup_wave_file(&wav);
+}
+#endif // SL_OPENAL_WRAPPER
+
+static void bench_files(const BENCH_OPTIONS* options, SL_ENGINE* engine) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s", options->dir, BENCH_FILE_NAME);
+
+    for (SLuint s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]) && bench_sizes[s] <= options->maxSize; s++) {
+        for (SLuint t = 0; t < sizeof(bench_pcm_types) / sizeof(bench_pcm_types[0]); t++) {
+            for (SLuint c = 0; c < sizeof(bench_channels) / sizeof(bench_channels[0]); c++) {
+                SLuint pcmType = bench_pcm_types[t];
+                SLushort channels = bench_channels[c];
+                SLuint blockAlign = sl_pcm_type_size(pcmType) * channels;
+                SLullong bytes = bench_sizes[s] / blockAlign * blockAlign;
+                BENCH_CTX ctx;
+                BENCH_TIMING timing;
+                SL_RETURN_CODE ret;
+
+                ret = bench_write_file(path, pcmType, channels, bytes);
+                if (ret != SL_SUCCESS) {
+                    bench_throughput_result("write", NULL, pcmType, channels, bytes, ret, &timing);
+                    continue;
+                }
+
+                memset(&ctx, 0, sizeof(BENCH_CTX));
+                ctx.path = path;
+
+                ret = bench_run(bench_parse, &ctx, options->minTime, &timing);
+                bench_throughput_result("parse", NULL, pcmType, channels, bytes, ret, &timing);
+
+                #ifdef SL_OPENAL_WRAPPER
+                {
+                    SL_WAV_FILE wav;
+
+                    ret = sl_read_wave_file(path, &wav);
+                    if (ret == SL_SUCCESS) {
+                        ctx.wav = &wav;
+                        ret = bench_run(bench_gen_sound, &ctx, options->minTime, &timing);
+                        sl_cleanup_wave_file(&wav);
+                    }
+                    bench_throughput_result("gen_sound", NULL, pcmType, channels, bytes, ret, &timing);
+
+                    if (options->openal && bytes <= BENCH_LATENCY_MAX_SIZE) bench_play_start(engine, path, pcmType, channels, bytes);
+                }
+                #endif // SL_OPENAL_WRAPPER
+
+                remove(path);
+            }
+        }
+    }
+}
+
+static SLullong bench_parse_size(const char* str) {
+    char* end;
+    SLullong size = strtoull(str, &end, 10);
+
+    switch (*end) {
+        case 'k': case 'K': return size << 10;
+        case 'm': case 'M': return size << 20;
+        case 'g': case 'G': return size << 30;
+        default: return size;
+    }
+}
+
+int main(int argc, char** argv) {
+    BENCH_OPTIONS options = { ".", 32ull << 20, 0.25, NULL, 1 };
+    SL_ENGINE* engine = NULL;
+    const char* device = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) options.dir = argv[++i];
+        else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) options.maxSize = bench_parse_size(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) options.minTime = strtod(argv[++i], NULL);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) options.out = argv[++i];
+        else if (strcmp(argv[i], "--no-openal") == 0) options.openal = 0;
+        else {
+            fprintf(stderr, "usage: %s [--dir DIR] [--max-size SIZE] [--min-time SECONDS] [--out FILE] [--no-openal]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bench_out = options.out != NULL ? fopen(options.out, "w") : stdout;
+    if (bench_out == NULL) {
+        fprintf(stderr, "Failed to open \"%s\".\n", options.out);
+        return 1;
+    }
+
+    #ifdef SL_OPENAL_WRAPPER
+    if (options.openal) {
+        // no sound card needed. set ALSOFT_DRIVERS yourself to use the wave writer or a real device instead
+        #ifdef _WIN32
+            if (getenv("ALSOFT_DRIVERS") == NULL) _putenv_s("ALSOFT_DRIVERS", "null");
+        #else
+            setenv("ALSOFT_DRIVERS", "null", 0);
+        #endif // _WIN32
+
+        engine = (SL_ENGINE*) malloc(sizeof(SL_ENGINE));
+        if (engine != NULL && sl_create_engine(engine, NULL) != SL_SUCCESS) {
+            free(engine);
+            engine = NULL;
+        }
+        if (engine != NULL) device = alcGetString(engine->device, ALC_DEVICE_SPECIFIER);
+    }
+    #endif // SL_OPENAL_WRAPPER
+
+    fprintf(bench_out, "{\n  \"sal_version\": ");
+    bench_json_string(SAL_VERSION);
+    fprintf(bench_out, ",\n  \"simd\": ");
+    bench_json_string(bench_simd_name(sl_get_simd_level()));
+    fprintf(bench_out, ",\n  \"openal_drivers\": ");
+    if (options.openal && getenv("ALSOFT_DRIVERS") != NULL) bench_json_string(getenv("ALSOFT_DRIVERS"));
+    else fprintf(bench_out, "null");
+    fprintf(bench_out, ",\n  \"openal_device\": ");
+    if (device != NULL) bench_json_string(device);
+    else fprintf(bench_out, "null");
+    fprintf(bench_out, ",\n  \"max_size\": %llu,\n  \"min_time\": %g,\n  \"results\": [", (unsigned long long) options.maxSize, options.minTime);
+
+    bench_first = 1;
+    bench_kernels(&options);
+    bench_files(&options, engine);
+
+    fprintf(bench_out, "\n  ]\n}\n");
+
+    #ifdef SL_OPENAL_WRAPPER
+    if (engine != NULL) {
+        sl_destroy_engine(engine);
+        free(engine);
+    }
+    #endif // SL_OPENAL_WRAPPER
+
+    if (bench_out != stdout) fclose(bench_out);
+    return 0;
+}
@@ -28,19 +28,44 @@
 extern "C" {
 #endif // __cplusplus
 
+// O_DIRECT is a GNU extension, so it is only there when the build defines _GNU_SOURCE. see the README.
+// without it SL_WRITE_DIRECT and SL_LOADER_DIRECT go through the page cache like everything else
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include <math.h>
 
 #ifdef _WIN32
 
 #include <windows.h>
+#include <malloc.h>
 
 #elif defined(__linux__) || defined(__APPLE__)
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <dirent.h>
+
+// SL_LOADER uses io_uring when the kernel headers have it. it talks to the kernel directly so liburing isn't needed
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#ifdef __NR_io_uring_setup
+#define SL_HAS_IO_URING
+#endif // __NR_io_uring_setup
+#endif // __has_include
+#endif // __linux__
 
 #endif // _WIN32
 
@@ -72,6 +97,11 @@ extern "C" {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #define SL_OPENAL_WRAPPER
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+///////////////// Controls if SAL counts what it does for sl_get_stats. Off unless you turn it on. ///////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+// #define SL_ENABLE_STATS // un-comment this if you want SAL to keep performance counters
+
 ///////////////////////////////////////////////////////////////////////////
 ///////////////// Define some compiler specific things. ///////////////////
 ///////////////////////////////////////////////////////////////////////////
@@ -91,6 +121,7 @@ DLL_EXPORT typedef int16_t     SLshort;
 DLL_EXPORT typedef uint16_t    SLushort;
 DLL_EXPORT typedef int32_t     SLint;
 DLL_EXPORT typedef uint32_t    SLuint;
+DLL_EXPORT typedef int64_t     SLllong;
 DLL_EXPORT typedef uint64_t    SLullong;
 DLL_EXPORT typedef float       SLfloat;
 DLL_EXPORT typedef double      SLdouble;
@@ -105,10 +136,14 @@ DLL_EXPORT typedef enum {
     SL_SUCCESS = 69420,
     SL_FAIL = 66666,
     SL_MALLOC_FAIL = 66667,
+    SL_MAP_FAIL = 66668,
     SL_INVALID_VALUE = 61616,
+    SL_BUFFER_TOO_SMALL = 61617,
 
     SL_FILE_ERROR = 62636,
     SL_INVALID_WAVE_FORMAT = 63293,
+    SL_INVALID_CATALOG = 64444,
+    SL_INVALID_BANK = 64445,
 
     SL_INVALID_CHUNK_DESCRIPTOR_ID = 10000,
     SL_INVALID_CHUNK_DESCRIPTOR_SIZE = 11111,
@@ -164,6 +199,559 @@ DLL_EXPORT static void sl_sleep(float duration) {
     #endif // _WIN32
 }
 
+// seconds since some point in the past that never jumps around. only useful for measuring time between two calls
+DLL_EXPORT static SLdouble sl_get_time(void) {
+    #ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (SLdouble) counter.QuadPart / (SLdouble) frequency.QuadPart;
+    #else
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (SLdouble) now.tv_sec + (SLdouble) now.tv_nsec / 1e9;
+    #endif // _WIN32
+}
+
+// number of cores the OS will run us on. never less than 1
+DLL_EXPORT static SLuint sl_get_cpu_count(void) {
+    #ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (SLuint) info.dwNumberOfProcessors : 1;
+    #elif defined(__linux__) || defined(__APPLE__)
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (SLuint) count : 1;
+    #else
+        return 1;
+    #endif // _WIN32
+}
+
+/////////////////////////////////////////////////////////////
+///////////////// Threading helpers /////////////////////////
+/////////////////////////////////////////////////////////////
+
+// Just enough threading for SAL's background work. pthreads everywhere except Windows.
+#ifdef _WIN32
+
+DLL_EXPORT typedef HANDLE             SL_THREAD;
+DLL_EXPORT typedef SRWLOCK            SL_MUTEX;
+DLL_EXPORT typedef CONDITION_VARIABLE SL_COND;
+
+#define SL_MUTEX_INIT SRWLOCK_INIT
+#define SL_COND_INIT CONDITION_VARIABLE_INIT
+
+#elif defined(__linux__) || defined(__APPLE__)
+
+DLL_EXPORT typedef pthread_t       SL_THREAD;
+DLL_EXPORT typedef pthread_mutex_t SL_MUTEX;
+DLL_EXPORT typedef pthread_cond_t  SL_COND;
+
+#define SL_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define SL_COND_INIT PTHREAD_COND_INITIALIZER
+
+#endif // _WIN32
+
+DLL_EXPORT typedef void (*SL_THREAD_FUNC)(SLvoid arg);
+
+// the allocator comes further down, but thread starts go through it too
+DLL_EXPORT static SLvoid sl_malloc(SLullong size);
+DLL_EXPORT static void sl_free(SLvoid ptr);
+
+// what a new thread needs to know. freed by the thread once it starts
+DLL_EXPORT typedef struct sl_thread_start {
+    SL_THREAD_FUNC func;
+    SLvoid arg;
+} SL_THREAD_START;
+
+#ifdef _WIN32
+DLL_EXPORT static DWORD WINAPI sl_thread_entry(LPVOID param) {
+#else
+DLL_EXPORT static void* sl_thread_entry(void* param) {
+#endif // _WIN32
+    SL_THREAD_START start = *(SL_THREAD_START*) param;
+    sl_free(param);
+
+    start.func(start.arg);
+    return 0;
+}
+
+// starts a thread running func(arg). returns SL_SUCCESS if it started
+DLL_EXPORT static SL_RETURN_CODE sl_thread_create(SL_THREAD* thread, SL_THREAD_FUNC func, SLvoid arg) {
+    SL_THREAD_START* start = (SL_THREAD_START*) sl_malloc(sizeof(SL_THREAD_START));
+    if (start == NULL) return SL_MALLOC_FAIL;
+
+    start->func = func;
+    start->arg = arg;
+
+    #ifdef _WIN32
+        *thread = CreateThread(NULL, 0, sl_thread_entry, start, 0, NULL);
+        if (*thread == NULL) {
+            sl_free(start);
+            return SL_FAIL;
+        }
+    #else
+        if (pthread_create(thread, NULL, sl_thread_entry, start) != 0) {
+            sl_free(start);
+            return SL_FAIL;
+        }
+    #endif // _WIN32
+
+    return SL_SUCCESS;
+}
+
+// waits for a thread to finish
+DLL_EXPORT static void sl_thread_join(SL_THREAD thread) {
+    #ifdef _WIN32
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+    #else
+        pthread_join(thread, NULL);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_mutex_init(SL_MUTEX* mutex) {
+    #ifdef _WIN32
+        InitializeSRWLock(mutex);
+    #else
+        pthread_mutex_init(mutex, NULL);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_mutex_destroy(SL_MUTEX* mutex) {
+    #ifndef _WIN32
+        pthread_mutex_destroy(mutex); // SRW locks don't need it
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_mutex_lock(SL_MUTEX* mutex) {
+    #ifdef _WIN32
+        AcquireSRWLockExclusive(mutex);
+    #else
+        pthread_mutex_lock(mutex);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_mutex_unlock(SL_MUTEX* mutex) {
+    #ifdef _WIN32
+        ReleaseSRWLockExclusive(mutex);
+    #else
+        pthread_mutex_unlock(mutex);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_cond_init(SL_COND* cond) {
+    #ifdef _WIN32
+        InitializeConditionVariable(cond);
+    #else
+        pthread_cond_init(cond, NULL);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_cond_destroy(SL_COND* cond) {
+    #ifndef _WIN32
+        pthread_cond_destroy(cond);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_cond_wait(SL_COND* cond, SL_MUTEX* mutex) {
+    #ifdef _WIN32
+        SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+    #else
+        pthread_cond_wait(cond, mutex);
+    #endif // _WIN32
+}
+
+// waits at most milliseconds. spurious wakeups happen so always re-check what you are waiting for
+DLL_EXPORT static void sl_cond_timed_wait(SL_COND* cond, SL_MUTEX* mutex, SLuint milliseconds) {
+    #ifdef _WIN32
+        SleepConditionVariableSRW(cond, mutex, milliseconds, 0);
+    #else
+        struct timeval now;
+        struct timespec until;
+        gettimeofday(&now, NULL);
+
+        SLullong nsec = (SLullong) now.tv_usec * 1000 + (SLullong) (milliseconds % 1000) * 1000000;
+        until.tv_sec = now.tv_sec + milliseconds / 1000 + (time_t) (nsec / 1000000000);
+        until.tv_nsec = (long) (nsec % 1000000000);
+
+        pthread_cond_timedwait(cond, mutex, &until);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_cond_signal(SL_COND* cond) {
+    #ifdef _WIN32
+        WakeConditionVariable(cond);
+    #else
+        pthread_cond_signal(cond);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_cond_broadcast(SL_COND* cond) {
+    #ifdef _WIN32
+        WakeAllConditionVariable(cond);
+    #else
+        pthread_cond_broadcast(cond);
+    #endif // _WIN32
+}
+
+// atomics for the lock-free parts of SAL. GCC and Clang have builtins, MSVC has the Interlocked functions
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SL_MSVC_ATOMICS
+#endif // _MSC_VER
+
+// loads a value other threads write. nothing after it moves before it
+DLL_EXPORT static SLullong sl_atomic_load(volatile SLullong* value) {
+    #ifdef SL_MSVC_ATOMICS
+        return (SLullong) InterlockedOr64((volatile LONG64*) value, 0);
+    #else
+        return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+    #endif // SL_MSVC_ATOMICS
+}
+
+// stores a value other threads read. nothing before it moves after it
+DLL_EXPORT static void sl_atomic_store(volatile SLullong* value, SLullong desired) {
+    #ifdef SL_MSVC_ATOMICS
+        InterlockedExchange64((volatile LONG64*) value, (LONG64) desired);
+    #else
+        __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+    #endif // SL_MSVC_ATOMICS
+}
+
+// sets value to desired if it is still expected. if it isn't, expected gets what it was instead. returns 1 if it was set
+DLL_EXPORT static SLbool sl_atomic_cas(volatile SLullong* value, SLullong* expected, SLullong desired) {
+    #ifdef SL_MSVC_ATOMICS
+        SLullong old = (SLullong) InterlockedCompareExchange64((volatile LONG64*) value, (LONG64) desired, (LONG64) *expected);
+        if (old == *expected) return 1;
+
+        *expected = old;
+        return 0;
+    #else
+        return __atomic_compare_exchange_n(value, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    #endif // SL_MSVC_ATOMICS
+}
+
+/////////////////////////////////////////////////////////////
+///////////////// Statistics ////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// number of buckets in a SL_STATS_HISTOGRAM.
+#define SL_STATS_BUCKETS 20
+
+// How long something took, in buckets that double in size. Bucket 0 counts anything under 1 microsecond,
+// bucket i anything under 2^i microseconds and the last bucket everything longer.
+DLL_EXPORT typedef struct sl_stats_histogram {
+    SLullong count;
+    SLullong totalNs; // all of them added up, in nanoseconds.
+    SLullong buckets[SL_STATS_BUCKETS];
+} SL_STATS_HISTOGRAM;
+
+// What SAL did since it started or since the last sl_reset_stats. Only counted when SL_ENABLE_STATS is defined.
+DLL_EXPORT typedef struct sl_stats {
+    SLullong filesParsed; // WAVE files read, mapped or parsed from memory without an error.
+    SLullong filesProbed; // WAVE files sl_probe_wave_file or sl_probe_wave_io looked at without an error.
+    SLullong bytesRead; // bytes read from files.
+    SL_STATS_HISTOGRAM descriptorTime; // sl_read_wave_descriptor.
+    SL_STATS_HISTOGRAM chunkTime; // sl_parse_wave_chunks. this includes reading the samples.
+    SL_STATS_HISTOGRAM dataReadTime; // reading the samples.
+    SL_STATS_HISTOGRAM endiannessTime; // flipping samples to the native byte order. only counted when they needed it.
+    SLullong allocations;
+    SLullong allocatedBytes;
+    SLullong uploadedBytes; // bytes handed to alBufferData.
+    SL_STATS_HISTOGRAM uploadTime; // alBufferData.
+    SL_STATS_HISTOGRAM deviceOpenTime; // alcOpenDevice.
+    SLllong activeVoices; // sounds, streams and mixer voices playing right now. sl_reset_stats leaves this alone.
+} SL_STATS;
+
+#ifdef SL_ENABLE_STATS
+
+#ifdef _MSC_VER
+#define SL_THREAD_LOCAL __declspec(thread)
+#else
+#define SL_THREAD_LOCAL __thread
+#endif // _MSC_VER
+
+// One thread's counters. A thread only ever adds to its own, so counting never takes a lock.
+DLL_EXPORT typedef struct sl_stats_block {
+    SL_STATS stats;
+    SLbool owned; // a thread is using it. blocks of threads that ended are handed to new ones, their counts just keep going.
+    struct sl_stats_block* next;
+} SL_STATS_BLOCK;
+
+static SL_STATS_BLOCK* sl_stats_blocks = NULL;
+static SL_STATS sl_stats_baseline; // totals at the last sl_reset_stats.
+static SL_MUTEX sl_stats_mutex = SL_MUTEX_INIT;
+static SL_THREAD_LOCAL SL_STATS_BLOCK* sl_stats_local = NULL;
+
+#ifdef _WIN32
+static DWORD sl_stats_key = FLS_OUT_OF_INDEXES;
+#else
+static pthread_key_t sl_stats_key;
+static SLbool sl_stats_key_made = 0;
+#endif // _WIN32
+
+// runs when a thread that counted something ends
+#ifdef _WIN32
+static VOID WINAPI sl_stats_release(PVOID block) {
+#else
+static void sl_stats_release(void* block) {
+#endif // _WIN32
+    sl_mutex_lock(&sl_stats_mutex);
+    ((SL_STATS_BLOCK*) block)->owned = 0;
+    sl_mutex_unlock(&sl_stats_mutex);
+}
+
+// gets the calling thread's counters. only the first call on a thread takes the lock. returns NULL if there is no memory for them
+DLL_EXPORT static SL_STATS* sl_stats_get_local(void) {
+    SL_STATS_BLOCK* block;
+
+    if (sl_stats_local != NULL) return &sl_stats_local->stats;
+
+    sl_mutex_lock(&sl_stats_mutex);
+
+    for (block = sl_stats_blocks; block != NULL && block->owned; block = block->next);
+
+    if (block == NULL) {
+        // blocks are never freed, only handed to the next thread. they would outlive an allocator that is swapped later, so they skip it
+        block = (SL_STATS_BLOCK*) calloc(1, sizeof(SL_STATS_BLOCK));
+        if (block == NULL) {
+            sl_mutex_unlock(&sl_stats_mutex);
+            return NULL;
+        }
+
+        block->next = sl_stats_blocks;
+        sl_stats_blocks = block;
+    }
+    block->owned = 1;
+
+    // without the key the block just stays with this thread forever
+    #ifdef _WIN32
+        if (sl_stats_key == FLS_OUT_OF_INDEXES) sl_stats_key = FlsAlloc(sl_stats_release);
+        if (sl_stats_key != FLS_OUT_OF_INDEXES) FlsSetValue(sl_stats_key, block);
+    #else
+        if (!sl_stats_key_made) sl_stats_key_made = pthread_key_create(&sl_stats_key, sl_stats_release) == 0;
+        if (sl_stats_key_made) pthread_setspecific(sl_stats_key, block);
+    #endif // _WIN32
+
+    sl_mutex_unlock(&sl_stats_mutex);
+
+    sl_stats_local = block;
+    return &block->stats;
+}
+
+// only the owning thread writes a counter so this doesn't need to be a real atomic add. the atomics only keep sl_get_stats from seeing half a value
+DLL_EXPORT static void sl_stats_add(volatile SLullong* counter, SLullong value) {
+    sl_atomic_store(counter, sl_atomic_load(counter) + value);
+}
+
+DLL_EXPORT static void sl_stats_record(SL_STATS_HISTOGRAM* histogram, SLdouble seconds) {
+    SLullong ns = seconds > 0 ? (SLullong) (seconds * 1e9) : 0;
+    SLullong us = ns / 1000;
+    SLuint bucket = 0;
+
+    while (us > 0 && bucket < SL_STATS_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+
+    sl_stats_add(&histogram->count, 1);
+    sl_stats_add(&histogram->totalNs, ns);
+    sl_stats_add(&histogram->buckets[bucket], 1);
+}
+
+// adds up every thread's counters. sl_stats_mutex has to be held
+DLL_EXPORT static void sl_stats_sum(SL_STATS* out) {
+    SLullong* total = (SLullong*) out;
+
+    memset(out, 0, sizeof(SL_STATS));
+
+    // every field is 8 bytes, so the whole thing can be walked like an array
+    for (SL_STATS_BLOCK* block = sl_stats_blocks; block != NULL; block = block->next) {
+        volatile SLullong* counters = (volatile SLullong*) &block->stats;
+        for (SLullong i = 0; i < sizeof(SL_STATS) / sizeof(SLullong); i++) total[i] += sl_atomic_load(&counters[i]);
+    }
+}
+
+// adds value to one of the calling thread's counters
+#define SL_STATS_ADD(field, value) do { \
+        SL_STATS* sl_stats_ = sl_stats_get_local(); \
+        if (sl_stats_ != NULL) sl_stats_add((volatile SLullong*) &sl_stats_->field, (SLullong) (value)); \
+    } while (0)
+
+// runs statement and adds how long it took to a histogram
+#define SL_STATS_TIME(field, statement) do { \
+        SLdouble sl_start_ = sl_get_time(); \
+        SL_STATS* sl_stats_; \
+        statement; \
+        sl_stats_ = sl_stats_get_local(); \
+        if (sl_stats_ != NULL) sl_stats_record(&sl_stats_->field, sl_get_time() - sl_start_); \
+    } while (0)
+
+#else
+
+#define SL_STATS_ADD(field, value) do {} while (0)
+#define SL_STATS_TIME(field, statement) do { statement; } while (0)
+
+#endif // SL_ENABLE_STATS
+
+/**
+ * @brief Gets what SAL counted, added up over every thread.
+ * @param stats - Where the counts go. All zero without SL_ENABLE_STATS.
+ * @return SL_SUCCESS if it succeeded. SL_FAIL if SAL was built without SL_ENABLE_STATS.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_get_stats(SL_STATS* stats) {
+    #ifdef SL_ENABLE_STATS
+        SLullong* total = (SLullong*) stats;
+        const SLullong* baseline = (const SLullong*) &sl_stats_baseline;
+
+        sl_mutex_lock(&sl_stats_mutex);
+
+        sl_stats_sum(stats);
+        for (SLullong i = 0; i < sizeof(SL_STATS) / sizeof(SLullong); i++) total[i] -= baseline[i];
+
+        sl_mutex_unlock(&sl_stats_mutex);
+        return SL_SUCCESS;
+    #else
+        memset(stats, 0, sizeof(SL_STATS));
+        return SL_FAIL;
+    #endif // SL_ENABLE_STATS
+}
+
+/**
+ * @brief Starts counting from zero again. activeVoices is left alone since those voices are still playing.
+ */
+DLL_EXPORT static void sl_reset_stats(void) {
+    #ifdef SL_ENABLE_STATS
+        // the threads keep adding to their own counters. we only remember where they were
+        sl_mutex_lock(&sl_stats_mutex);
+        sl_stats_sum(&sl_stats_baseline);
+        sl_stats_baseline.activeVoices = 0;
+        sl_mutex_unlock(&sl_stats_mutex);
+    #endif // SL_ENABLE_STATS
+}
+
+/////////////////////////////////////////////////////////////
+///////////////// Memory ////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+// alignment of every sample buffer SAL allocates. enough for any SIMD load.
+#define SL_SAMPLE_ALIGN 64
+
+// Where SAL gets its memory from. Give sl_set_allocator one of these to send everything SAL allocates to your own heap.
+DLL_EXPORT typedef struct sl_allocator {
+    SLvoid (*alloc)(SLvoid user, SLullong size); // returns NULL if it failed.
+    void (*free)(SLvoid user, SLvoid ptr); // gets memory from both alloc and alignedAlloc. never gets NULL.
+    SLvoid (*alignedAlloc)(SLvoid user, SLullong size, SLullong alignment); // alignment is a power of two. returns NULL if it failed.
+    SLvoid user; // handed to all three.
+} SL_ALLOCATOR;
+
+// windows needs _aligned_free for aligned memory, so there everything is aligned to keep a single free
+DLL_EXPORT static SLvoid sl_default_alloc(SLvoid user, SLullong size) {
+    (void) user;
+
+    #ifdef _WIN32
+        return _aligned_malloc((size_t) size, 16);
+    #else
+        return malloc((size_t) size);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static void sl_default_free(SLvoid user, SLvoid ptr) {
+    (void) user;
+
+    #ifdef _WIN32
+        _aligned_free(ptr);
+    #else
+        free(ptr);
+    #endif // _WIN32
+}
+
+DLL_EXPORT static SLvoid sl_default_aligned_alloc(SLvoid user, SLullong size, SLullong alignment) {
+    (void) user;
+
+    #ifdef _WIN32
+        return _aligned_malloc((size_t) size, (size_t) alignment);
+    #else
+        void* ptr = NULL;
+        if (alignment < sizeof(void*)) alignment = sizeof(void*);
+        return posix_memalign(&ptr, (size_t) alignment, (size_t) (size ? size : 1)) == 0 ? ptr : NULL;
+    #endif // _WIN32
+}
+
+static SL_ALLOCATOR sl_allocator = {sl_default_alloc, sl_default_free, sl_default_aligned_alloc, NULL};
+
+/**
+ * @brief Sets where SAL gets its memory from. Do this before anything else, memory has to go back to the allocator it came from.
+ * @param allocator - The allocator to use. It is copied. NULL goes back to malloc and free.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_VALUE if one of the functions is missing.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_set_allocator(const SL_ALLOCATOR* allocator) {
+    if (allocator == NULL) {
+        sl_allocator.alloc = sl_default_alloc;
+        sl_allocator.free = sl_default_free;
+        sl_allocator.alignedAlloc = sl_default_aligned_alloc;
+        sl_allocator.user = NULL;
+        return SL_SUCCESS;
+    }
+
+    if (allocator->alloc == NULL || allocator->free == NULL || allocator->alignedAlloc == NULL) return SL_INVALID_VALUE;
+
+    sl_allocator = *allocator;
+    return SL_SUCCESS;
+}
+
+/**
+ * @brief Gets the allocator SAL is using.
+ * @param allocator - Where it is copied to.
+ */
+DLL_EXPORT static void sl_get_allocator(SL_ALLOCATOR* allocator) {
+    *allocator = sl_allocator;
+}
+
+// everything SAL allocates goes through these so it can be counted and sent to the allocator
+DLL_EXPORT static SLvoid sl_malloc(SLullong size) {
+    SLvoid ptr = sl_allocator.alloc(sl_allocator.user, size);
+
+    if (ptr != NULL) {
+        SL_STATS_ADD(allocations, 1);
+        SL_STATS_ADD(allocatedBytes, size);
+    }
+
+    return ptr;
+}
+
+DLL_EXPORT static SLvoid sl_calloc(SLullong count, SLullong size) {
+    SLvoid ptr;
+
+    if (size != 0 && count > (SLullong) -1 / size) return NULL;
+
+    ptr = sl_malloc(count * size);
+    if (ptr != NULL) memset(ptr, 0, count * size);
+
+    return ptr;
+}
+
+// for memory that needs more than SL_SAMPLE_ALIGN, like buffers for direct I/O. alignment is a power of two
+DLL_EXPORT static SLvoid sl_aligned_malloc_b(SLullong size, SLullong alignment) {
+    SLvoid ptr = sl_allocator.alignedAlloc(sl_allocator.user, size, alignment);
+
+    if (ptr != NULL) {
+        SL_STATS_ADD(allocations, 1);
+        SL_STATS_ADD(allocatedBytes, size);
+    }
+
+    return ptr;
+}
+
+// for samples. SIMD loops can use aligned loads on anything from here
+DLL_EXPORT static SLvoid sl_aligned_malloc(SLullong size) {
+    return sl_aligned_malloc_b(size, SL_SAMPLE_ALIGN);
+}
+
+DLL_EXPORT static void sl_free(SLvoid ptr) {
+    if (ptr != NULL) sl_allocator.free(sl_allocator.user, ptr);
+}
+
 ////////////////////////////////////////////////////////////////
 ///////////////// Wave File Parser Pcm types ///////////////////
 ////////////////////////////////////////////////////////////////
@@ -174,7 +762,8 @@ DLL_EXPORT typedef enum {
     SL_SIGNED_24PCM = 3,
     SL_SIGNED_32PCM = 4,
     SL_FLOAT_32PCM = 5,
-    SL_FLOAT_64PCM = 6
+    SL_FLOAT_64PCM = 6,
+    SL_IMA_ADPCM = 7 // 4 bit IMA ADPCM blocks. files are only left like this when asked to, see SL_READ_KEEP_COMPRESSED.
 } SL_WAVE_PCM_TYPE;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -182,14 +771,14 @@ DLL_EXPORT typedef enum {
 //////////////                          Thanks to http://soundfile.sapp.org/doc/WaveFormat/ and https://wavefilegem.com/how_wave_files_work.html for this.                          //////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////                                                                          WAVE Descriptor Chunk                                                                       //////////////
-//////////////                 Big Endian Chunk ID contains the letters "RIFF" in ASCII form. It can be something else like RIFX, but this parser only support RIFF.                //////////////
+//////////////                     Big Endian Chunk ID contains the letters "RIFF" in ASCII form. "RIFX" means every number in the file is big endian instead.                      //////////////
 //////////////                                                 Little Endian Chunk Size contains the size of the rest of the chunk.                                                 //////////////
 //////////////                          Big Endian Format contains WAVE. I don't know if this can be anything else, but this parser will only support WAVE.                         //////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////                                                                            WAVE Format Chunk                                                                         //////////////
 //////////////                                                   Big Endian Chunk ID contains the letters "fmt " (with the space).                                                  //////////////
 //////////////                                                  Little Endian Chunk Size contains the size of the rest of the chunk.                                                //////////////
-//////////////                           Little Endian Audio Format contains the format of the audio. 1 for pcm, 3 for float, and there's probably a lot more.                      //////////////
+//////////////                       Little Endian Audio Format contains the format of the audio. 1 for pcm, 3 for float, 0x11 for IMA ADPCM and there's a lot more.                //////////////
 //////////////                                                   Little Endian Number of Channels contains the number of channels.                                                  //////////////
 //////////////                                                   Little Endian Sample rate contains the sample rate of the audio.                                                   //////////////
 //////////////                                                     Little Endian Byte rate contains the byte rate of the audio.                                                     //////////////
@@ -212,6 +801,7 @@ DLL_EXPORT typedef struct sl_wav_descriptor {
     SLuint descriptorChunkSize;
     SLuchar descriptorId[4];
     SLuchar chunkFormat[4];
+    SLuint endianness; // SL_ENDIANNESS of everything in the file. SL_BIG_ENDIAN for RIFX.
 } SL_WAV_DESCRIPTOR;
 
 DLL_EXPORT typedef struct sl_wav_fmt {
@@ -224,6 +814,7 @@ DLL_EXPORT typedef struct sl_wav_fmt {
     SLushort bitsPerSample;
     SLushort extensionSize;
     SLuchar fmtId[4];
+    SLushort samplesPerBlock; // frames in each block of an IMA ADPCM file. 0 for PCM.
 } SL_WAV_FMT;
 
 DLL_EXPORT typedef struct sl_wav_data {
@@ -231,14 +822,427 @@ DLL_EXPORT typedef struct sl_wav_data {
     SLuint pcmType;
     SLuchar dataId[4];
     SLvoid  waveformData;
+    SLullong dataOffset; // byte offset of the waveform data from the start of the file.
 } SL_WAV_DATA;
 
+// Where the waveform data of a SL_WAV_FILE lives. sl_cleanup_wave_file uses this to know how to let go of it.
+DLL_EXPORT typedef enum {
+    SL_STORAGE_OWNED = 0, // malloc'd by SAL.
+    SL_STORAGE_MAPPED = 1, // points into a memory mapping of the file.
+    SL_STORAGE_BORROWED = 2 // points into memory owned by the caller. see sl_read_wave_memory.
+} SL_WAV_STORAGE;
+
 DLL_EXPORT typedef struct sl_wav_file {
     SL_WAV_DESCRIPTOR descriptorChunk;
     SL_WAV_FMT formatChunk;
     SL_WAV_DATA dataChunk;
+
+    SLuint storage; // one of SL_WAV_STORAGE.
+    SLvoid storageBase; // start of the mapping for SL_STORAGE_MAPPED.
+    SLullong storageSize; // size of the mapping for SL_STORAGE_MAPPED.
 } SL_WAV_FILE;
 
+// Access pattern hints for mapped WAVE files. These map to madvise() where it exists.
+DLL_EXPORT typedef enum {
+    SL_MAP_ADVICE_NORMAL = 0,
+    SL_MAP_ADVICE_SEQUENTIAL = 1,
+    SL_MAP_ADVICE_RANDOM = 2,
+    SL_MAP_ADVICE_WILLNEED = 3,
+    SL_MAP_ADVICE_DONTNEED = 4
+} SL_MAP_ADVICE;
+
+// Where the parser gets its bytes from. SAL has one for FILE* and one for memory, but anything that can read, seek and tell works.
+DLL_EXPORT typedef struct sl_io {
+    SLullong (*read)(SLvoid user, SLvoid dst, SLullong size); // returns the number of bytes read.
+    SLint (*seek)(SLvoid user, SLllong offset, SLint origin); // origin is SEEK_SET, SEEK_CUR or SEEK_END. returns 0 if it worked.
+    SLllong (*tell)(SLvoid user); // returns -1 if it failed.
+    SLvoid user;
+} SL_IO;
+
+// State for reading a block of memory through a SL_IO.
+DLL_EXPORT typedef struct sl_memory_io {
+    const SLuchar* data;
+    SLullong size;
+    SLullong pos;
+} SL_MEMORY_IO;
+
+// how much SL_HANDLE_IO reads at once to serve the small reads of the parser.
+#define SL_HANDLE_IO_BUFFER_SIZE 4096
+
+// State for reading a file through a SL_IO with the OS instead of stdio. It can live on the stack, so reading through it
+// allocates nothing. Small reads come out of the buffer, big ones go straight into the caller's memory.
+DLL_EXPORT typedef struct sl_handle_io {
+    #ifdef _WIN32
+        HANDLE file;
+    #else
+        int file;
+    #endif // _WIN32
+    SLullong size; // size of the file.
+    SLullong pos; // where the next read starts.
+    SLullong bufferPos; // where buffer starts in the file.
+    SLullong bufferUsed; // bytes in buffer.
+    SLuchar buffer[SL_HANDLE_IO_BUFFER_SIZE];
+} SL_HANDLE_IO;
+
+// A WAVE file that is read a block at a time instead of all at once.
+DLL_EXPORT typedef struct sl_wav_stream {
+    SL_WAV_FILE header; // everything but the samples. waveformData is always NULL.
+    SL_IO io;
+    SL_HANDLE_IO* handle; // only set when the stream opened the file itself. freed by sl_close_wave_stream.
+    SLullong frameCount; // total number of frames in the data chunk.
+    SLullong framePos; // next frame that will be read.
+} SL_WAV_STREAM;
+
+// How sl_read_wave_file_b reads a file.
+DLL_EXPORT typedef enum {
+    SL_READ_DEFAULT = 0,
+    SL_READ_KEEP_COMPRESSED = 1 // leave IMA ADPCM samples compressed instead of decoding them to 16 bit. a quarter of the memory, decoded a block at a time when uploaded or mixed.
+} SL_READ_FLAGS;
+
+// most channels an IMA ADPCM file can have. every channel needs its own predictor while decoding.
+#define SL_ADPCM_MAX_CHANNELS 8
+
+// Where decoding an IMA ADPCM file got up to, so reading the frames after it carries on instead of going back to the start of the block.
+// Zero it before the first use. A zeroed decoder works for any frame, it just starts over from the block.
+DLL_EXPORT typedef struct sl_adpcm_decoder {
+    SLullong frame; // next frame the predictors are ready for.
+    SLint predictor[SL_ADPCM_MAX_CHANNELS];
+    SLint index[SL_ADPCM_MAX_CHANNELS]; // into the step table.
+} SL_ADPCM_DECODER;
+
+// size of the buffer a SL_WAV_WRITER collects samples in before they go to the file.
+#define SL_WAV_WRITER_BUFFER_SIZE (1 << 20)
+
+// alignment of the writer's buffer, and of every write when SL_WRITE_DIRECT is used. 4096 covers the sector size of about every disk.
+#define SL_WAV_WRITER_ALIGN 4096
+
+// size of the header a SL_WAV_WRITER puts in front of the samples.
+#define SL_WAV_HEADER_SIZE 44
+
+// How a SL_WAV_WRITER writes to the disk.
+DLL_EXPORT typedef enum {
+    SL_WRITE_DEFAULT = 0,
+    SL_WRITE_DIRECT = 1 // skip the OS file cache (O_DIRECT, F_NOCACHE or FILE_FLAG_NO_BUFFERING). good for huge renders nobody reads right away.
+} SL_WRITE_FLAGS;
+
+// A WAVE file that is written a block of frames at a time. The sizes in the header are filled in when it is closed.
+DLL_EXPORT typedef struct sl_wav_writer {
+    #ifdef _WIN32
+        HANDLE file;
+    #else
+        int file;
+    #endif // _WIN32
+    SLuint pcmType;
+    SLushort numChannels;
+    SLuint sampleRate;
+    SLuint blockAlign;
+    SLbool direct; // 1 if the file really was opened for direct I/O.
+    SLvoid bufferBase; // what was malloc'd. buffer is aligned inside of it.
+    SLuchar* buffer; // SL_WAV_WRITER_BUFFER_SIZE bytes.
+    SLuchar* head; // copy of the first SL_WAV_WRITER_ALIGN bytes of the file so direct writers can patch the header.
+    SLullong bufferUsed;
+    SLullong fileOffset; // where the buffer goes in the file.
+    SLullong dataSize; // bytes of samples written so far.
+} SL_WAV_WRITER;
+
+// Options for sl_read_wave_files.
+DLL_EXPORT typedef struct sl_batch_options {
+    SLuint threadCount; // threads parsing files, counting the calling thread. 0 means one per core.
+} SL_BATCH_OPTIONS;
+
+// What every thread of a sl_read_wave_files call shares.
+DLL_EXPORT typedef struct sl_batch_job {
+    const SLstr* paths;
+    SL_WAV_FILE* out;
+    SL_RETURN_CODE* results;
+    SLullong count;
+    SLullong next; // next file nobody has started on yet.
+    SLullong failed;
+    SL_MUTEX mutex;
+} SL_BATCH_JOB;
+
+// number of hash buckets a new cache starts with. must be a power of two.
+#define SL_WAV_CACHE_INITIAL_BUCKETS 64
+
+// A loaded WAVE file in a SL_WAV_CACHE. file is first so a SL_WAV_FILE* from the cache can be turned back into its entry.
+DLL_EXPORT typedef struct sl_wav_cache_entry {
+    SL_WAV_FILE file;
+    char* key;
+    SLullong hash;
+    SLullong size; // bytes this entry counts against the budget.
+    SLuint refCount;
+    struct sl_wav_cache_entry* hashNext;
+    struct sl_wav_cache_entry* lruPrev; // more recently used.
+    struct sl_wav_cache_entry* lruNext; // less recently used.
+} SL_WAV_CACHE_ENTRY;
+
+// Keeps loaded WAVE files around by path so playing the same file again doesn't touch the disk.
+// Files nobody is using are thrown out, least recently used first, once the cache is over its budget.
+DLL_EXPORT typedef struct sl_wav_cache {
+    SL_MUTEX mutex; // guards everything below.
+    SL_WAV_CACHE_ENTRY** buckets;
+    SLuint bucketCount;
+    SLuint entryCount;
+    SL_WAV_CACHE_ENTRY* lruHead; // most recently used.
+    SL_WAV_CACHE_ENTRY* lruTail; // least recently used.
+    SLullong budget; // bytes.
+    SLullong bytes; // bytes in use.
+    SLullong hits;
+    SLullong misses;
+    SLullong evictions;
+} SL_WAV_CACHE;
+
+// A copy of the counters of a SL_WAV_CACHE.
+DLL_EXPORT typedef struct sl_wav_cache_stats {
+    SLullong hits;
+    SLullong misses;
+    SLullong evictions;
+    SLullong bytes;
+    SLullong budget;
+    SLuint entryCount;
+} SL_WAV_CACHE_STATS;
+
+// first 8 bytes of every catalog file.
+#define SL_CATALOG_MAGIC "SALCATLG"
+
+// bump this whenever SL_CATALOG_HEADER or SL_CATALOG_ENTRY change. catalogs of other versions get rebuilt.
+#define SL_CATALOG_VERSION 1
+
+// longest path the catalog builder handles, the directory included. longer ones are left out.
+#define SL_CATALOG_MAX_PATH 4096
+
+// The start of a catalog file. After it come entryCount SL_CATALOG_ENTRY, bucketCount SLuint and namesSize bytes of names.
+// Everything is in the byte order of the machine that built it.
+DLL_EXPORT typedef struct sl_catalog_header {
+    SLuchar magic[8]; // SL_CATALOG_MAGIC.
+    SLuint version; // SL_CATALOG_VERSION.
+    SLuint endianness; // SL_ENDIANNESS of the machine that built it.
+    SLullong entryCount;
+    SLullong bucketCount; // a power of two, at least twice entryCount.
+    SLullong namesSize; // bytes of names, 0s included.
+    SLullong reserved[3];
+} SL_CATALOG_HEADER;
+
+// One WAVE file in a catalog. Everything but the name and the file times is what sl_probe_wave_file found.
+DLL_EXPORT typedef struct sl_catalog_entry {
+    SLullong hash; // sl_hash_string of the name.
+    SLullong nameOffset; // where the name starts in the names.
+    SLllong modifiedTime; // last write time in whatever units the OS uses. only ever compared.
+    SLullong fileSize;
+    SLullong dataOffset;
+    SLuint dataChunkSize;
+    SLuint descriptorChunkSize;
+    SLuint fmtChunkSize;
+    SLuint sampleRate;
+    SLuint byteRate;
+    SLuint pcmType;
+    SLuint endianness;
+    SLushort audioFormat;
+    SLushort numChannels;
+    SLushort blockAlign;
+    SLushort bitsPerSample;
+    SLushort extensionSize;
+    SLushort samplesPerBlock;
+} SL_CATALOG_ENTRY;
+
+// A catalog file mapped into memory. Lookups read straight out of the mapping, so opening one costs the same for any size.
+DLL_EXPORT typedef struct sl_catalog {
+    SLvoid base; // start of the mapping.
+    SLullong size; // size of the mapping.
+    const SL_CATALOG_HEADER* header;
+    const SL_CATALOG_ENTRY* entries;
+    const SLuint* buckets; // index + 1 of an entry, 0 for an empty bucket. full buckets move on to the next one.
+    const char* names; // relative to the directory the catalog was built from, with '/' between folders.
+    SLullong entryCount;
+} SL_CATALOG;
+
+// What a sl_build_catalog call did.
+DLL_EXPORT typedef struct sl_catalog_scan_stats {
+    SLullong fileCount; // WAVE files in the new catalog.
+    SLullong reused; // files that hadn't changed since the old catalog and weren't opened.
+    SLullong probed; // new or changed files that were parsed.
+    SLullong failed; // WAVE files that didn't parse. they are left out.
+} SL_CATALOG_SCAN_STATS;
+
+// Everything a sl_build_catalog call needs while it walks the directory.
+DLL_EXPORT typedef struct sl_catalog_builder {
+    SL_CATALOG old; // the catalog from last time. base is NULL if there wasn't a usable one.
+    SL_CATALOG_ENTRY* entries;
+    SLullong entryCount;
+    SLullong entryCapacity;
+    char* names;
+    SLullong namesSize;
+    SLullong namesCapacity;
+    SLullong rootLength; // length of the directory at the start of path, the '/' after it included.
+    char path[SL_CATALOG_MAX_PATH]; // path of whatever is being looked at.
+    SL_CATALOG_SCAN_STATS stats;
+} SL_CATALOG_BUILDER;
+
+// first 8 bytes of every sound bank.
+#define SL_BANK_MAGIC "SALBANK1"
+
+// bump this whenever SL_BANK_HEADER or SL_BANK_ENTRY change.
+#define SL_BANK_VERSION 1
+
+// every payload in a bank starts on a multiple of this, so it starts on a page of the mapping.
+#define SL_BANK_ALIGN 4096
+
+// The start of a sound bank. The first SL_BANK_ALIGN bytes are reserved for it, then come the payloads.
+// At tocOffset there are entryCount SL_BANK_ENTRY, bucketCount SLuint and namesSize bytes of names.
+// Everything, samples included, is in the byte order of the machine that built it.
+DLL_EXPORT typedef struct sl_bank_header {
+    SLuchar magic[8]; // SL_BANK_MAGIC. all zeros until the writer is closed.
+    SLuint version; // SL_BANK_VERSION.
+    SLuint endianness; // SL_ENDIANNESS of the machine that built it.
+    SLullong entryCount;
+    SLullong bucketCount; // a power of two, at least twice entryCount.
+    SLullong tocOffset;
+    SLullong namesSize; // bytes of names, 0s included.
+    SLullong reserved[2];
+} SL_BANK_HEADER;
+
+// One sound in a bank.
+DLL_EXPORT typedef struct sl_bank_entry {
+    SLullong hash; // sl_hash_string of the name.
+    SLullong nameOffset; // where the name starts in the names.
+    SLullong dataOffset; // where the samples start in the file. a multiple of SL_BANK_ALIGN.
+    SLullong dataSize; // bytes of samples.
+    SLuint pcmType;
+    SLuint reserved;
+    SL_WAV_FMT format; // the format chunk, already parsed.
+} SL_BANK_ENTRY;
+
+// Builds a sound bank one sound at a time. The payloads go to the file as they are added, the table when it is closed.
+DLL_EXPORT typedef struct sl_bank_writer {
+    FILE* file;
+    SL_BANK_ENTRY* entries;
+    SLullong entryCount;
+    SLullong entryCapacity;
+    char* names;
+    SLullong namesSize;
+    SLullong namesCapacity;
+    SLullong fileSize; // bytes written so far.
+    SLbool failed; // a write went wrong. the bank is not finished when it is closed.
+} SL_BANK_WRITER;
+
+// A sound bank mapped into memory. Every sound in it is a SL_WAV_FILE pointing straight into the mapping.
+DLL_EXPORT typedef struct sl_bank {
+    SLvoid base; // start of the mapping.
+    SLullong size; // size of the mapping.
+    const SL_BANK_HEADER* header;
+    const SL_BANK_ENTRY* entries;
+    const SLuint* buckets; // index + 1 of an entry, 0 for an empty bucket. full buckets move on to the next one.
+    const char* names;
+    SL_WAV_FILE* files; // one per entry in the same order. don't clean them up, sl_close_bank does.
+    SLullong entryCount;
+} SL_BANK;
+
+// files a SL_LOADER keeps in flight at once through io_uring unless told otherwise.
+#define SL_LOADER_DEFAULT_DEPTH 256
+
+// how much of the start of a file SL_LOADER reads to find the samples. one block, so it can be read with O_DIRECT too.
+#define SL_LOADER_HEADER_SIZE 4096
+
+// the most a single io_uring read asks for. bigger data chunks take a few.
+#define SL_LOADER_MAX_READ (1 << 30)
+
+// How a SL_LOADER reads files.
+DLL_EXPORT typedef enum {
+    SL_LOADER_DEFAULT = 0,
+    SL_LOADER_DIRECT = 1, // open files with O_DIRECT so they skip the page cache. only io_uring does this, and files on file systems that say no are read normally.
+    SL_LOADER_NO_URING = 2, // always use the thread pool, even where io_uring works.
+    SL_LOADER_KEEP_COMPRESSED = 4 // same as SL_READ_KEEP_COMPRESSED.
+} SL_LOADER_FLAGS;
+
+// Options for sl_create_loader.
+DLL_EXPORT typedef struct sl_loader_options {
+    SLuint depth; // files in flight at once with io_uring. 0 means SL_LOADER_DEFAULT_DEPTH.
+    SLuint threadCount; // threads of the pool used when io_uring isn't there. 0 means one per core.
+    SLuint flags; // SL_LOADER_FLAGS.
+} SL_LOADER_OPTIONS;
+
+// A file a SL_LOADER is done with.
+DLL_EXPORT typedef struct sl_loader_result {
+    SL_WAV_FILE file; // clean it up with sl_cleanup_wave_file. empty if result is not SL_SUCCESS.
+    SL_RETURN_CODE result; // what sl_read_wave_file would have returned.
+    SLvoid user; // what was given to sl_loader_submit.
+} SL_LOADER_RESULT;
+
+// What a file read through io_uring is waiting on.
+DLL_EXPORT typedef enum {
+    SL_LOAD_HEADER = 0, // the first SL_LOADER_HEADER_SIZE bytes.
+    SL_LOAD_DATA = 1 // the samples.
+} SL_LOAD_STAGE;
+
+// One file given to sl_loader_submit.
+DLL_EXPORT typedef struct sl_load_request {
+    SL_LOADER_RESULT result;
+    char* path;
+    struct sl_load_request* next;
+
+    // only used with io_uring
+    int fd;
+    SLuint stage; // SL_LOAD_STAGE.
+    SLuint slot; // which header buffer it reads into.
+    SLbool direct; // fd was opened with O_DIRECT, so reads have to be whole blocks.
+    SLuchar* buffer; // where the samples are read to. with O_DIRECT it starts on the block before them.
+    SLullong readOffset; // where in the file buffer starts.
+    SLullong readSize; // bytes buffer is read with.
+    SLullong readDone; // bytes read so far.
+    SLullong fileSize;
+} SL_LOAD_REQUEST;
+
+// An io_uring mapped into memory. The pointers point into the rings the kernel shares with us.
+DLL_EXPORT typedef struct sl_uring {
+    int fd;
+    SLuint entries;
+    volatile SLuint* sqHead; // the kernel moves this.
+    volatile SLuint* sqTail; // we move this.
+    SLuint sqMask;
+    SLuint* sqArray;
+    SLvoid sqes; // struct io_uring_sqe[entries].
+    volatile SLuint* cqHead; // we move this.
+    volatile SLuint* cqTail; // the kernel moves this.
+    SLuint cqMask;
+    SLvoid cqes; // struct io_uring_cqe[].
+    SLvoid sqRing;
+    SLullong sqRingSize;
+    SLvoid cqRing; // same as sqRing when the kernel maps both at once.
+    SLullong cqRingSize;
+    SLullong sqesSize;
+} SL_URING;
+
+// Loads many WAVE files at once and hands them back as they finish.
+// On Linux with io_uring one thread keeps up to depth files in flight. Everywhere else a pool of threads runs sl_read_wave_file.
+// sl_loader_submit and sl_loader_poll are meant to be called from the same thread.
+DLL_EXPORT typedef struct sl_loader {
+    SLbool uring; // 1 when io_uring is used, 0 for the thread pool.
+    SLuint flags;
+    SLullong pending; // submitted and not handed back yet.
+    SL_LOAD_REQUEST* queuedHead; // not started yet. oldest first.
+    SL_LOAD_REQUEST* queuedTail;
+    SL_LOAD_REQUEST* doneHead; // finished and waiting for sl_loader_poll. oldest first.
+    SL_LOAD_REQUEST* doneTail;
+
+    // io_uring
+    SL_URING ring;
+    SLuint depth;
+    SLuchar* headers; // depth * SL_LOADER_HEADER_SIZE bytes, one per file in flight.
+    SLbool registered; // headers is registered with the ring, so header reads skip mapping the pages every time.
+    SLuint* freeSlots; // header buffers nobody uses.
+    SLuint freeCount;
+    SLuint inFlight; // reads handed to the ring that haven't completed.
+    SLuint unsubmitted; // reads in the ring the kernel hasn't been told about.
+
+    // thread pool
+    SL_MUTEX mutex; // guards the lists and stopping.
+    SL_COND wake; // workers wait on it for files.
+    SL_COND done; // sl_loader_poll waits on it for results.
+    SL_THREAD* threads;
+    SLuint threadCount;
+    SLbool stopping;
+} SL_LOADER;
+
 ///////////////////////////////////////////////////////////////////////////
 ///////////////// Wave File Parser Function Definitions ///////////////////
 ///////////////////////////////////////////////////////////////////////////
@@ -253,1066 +1257,8202 @@ DLL_EXPORT typedef struct sl_wav_file {
 DLL_EXPORT static SL_RETURN_CODE sl_read_wave_file(SLstr path, SL_WAV_FILE* wavBuf);
 
 /**
- * @brief Frees the memory associated with the WAVE file.
- * @param buf - Buffer of WAVE file to free.
+ * @brief Parses a wave file from anything that can be read through a SL_IO.
+ * Unlike sl_read_wave_file there is no check on the file extension, the bytes have to speak for themselves.
+ * @param io - Where to read the WAVE file from. It should be at the start of the RIFF header.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @return SL_SUCCESS if succeeded. Anything else means the file is bad or could not be read.
  */
-DLL_EXPORT static void sl_cleanup_wave_file(SL_WAV_FILE* wavBuf);
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_io(SL_IO* io, SL_WAV_FILE* wavBuf);
 
 /**
- * @brief Reads WAVE descriptor chunk. This is a helper function and should not be used except by SAL.
- * @param file - File ptr to WAVE file.
+ * @brief Parses wave file at the path, with SL_READ_FLAGS.
+ * IMA ADPCM files are decoded to 16 bit PCM while they are read unless SL_READ_KEEP_COMPRESSED is given.
+ * Compressed files still play and mix, they get decoded a block at a time right before that.
+ * @param path - Path of WAVE file to parse.
  * @param wavBuf - Buffer for the WAVE file.
- * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ * @param flags - SL_READ_FLAGS or'd together.
+ * @return SL_SUCCESS if succeeded. Anything else means the file is bad or could not be read.
  */
-DLL_EXPORT static SL_RETURN_CODE sl_read_wave_descriptor(FILE* file, SL_WAV_FILE* wavBuf);
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_file_b(SLstr path, SL_WAV_FILE* wavBuf, SLuint flags);
 
 /**
- * @brief Parses WAVE chunks. This is a helper function and should not be used except by SAL.
- * @param file - File ptr to WAVE file.
+ * @brief Parses a wave file from a SL_IO, with SL_READ_FLAGS. See sl_read_wave_file_b.
+ * @param io - Where to read the WAVE file from. It should be at the start of the RIFF header.
  * @param wavBuf - Buffer for the WAVE file.
- * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ * @param flags - SL_READ_FLAGS or'd together.
+ * @return SL_SUCCESS if succeeded. Anything else means the file is bad or could not be read.
  */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_wave_chunks(FILE* file, SL_WAV_FILE* wavBuf);
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_io_b(SL_IO* io, SL_WAV_FILE* wavBuf, SLuint flags);
 
 /**
- * @brief Reads WAVE format chunk. This is a helper function and should not be used except by SAL.
- * @param file - File ptr to WAVE file.
+ * @brief Parses a wave file that is already in memory.
+ * When alias is 1 waveformData points into data instead of a copy, so data has to outlive the buffer and must not be changed while it is used.
+ * Aliasing only happens when the file's byte order matches the system's. Otherwise the samples are copied so they can be flipped.
+ * IMA ADPCM files are never aliased either, they are decoded to 16 bit PCM in a buffer of their own like sl_read_wave_io does.
+ * @param data - Start of the WAVE file.
+ * @param size - Size of the WAVE file in bytes.
  * @param wavBuf - Buffer for the WAVE file.
- * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ * @param alias - 1 to point into data, 0 to copy the samples.
+ * @return SL_SUCCESS if succeeded. Anything else means the file is bad.
  */
-DLL_EXPORT static SL_RETURN_CODE sl_read_wave_format_chunk(FILE* file, SL_WAV_FILE* wavBuf);
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_memory(const void* data, SLullong size, SL_WAV_FILE* wavBuf, SLbool alias);
 
 /**
- * @brief Reads WAVE data chunk. This is a helper function and should not be used except by SAL.
- * @param file - File ptr to WAVE file.
- * @param wavBuf - Buffer for the WAVE file.
- * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ * @brief Parses a WAVE file into a buffer you own instead of one SAL allocates. Nothing is allocated at all.
+ * IMA ADPCM files are refused since decoding them would need a second buffer. Read those with sl_read_wave_file_b.
+ * @param path - Path to the WAVE file.
+ * @param wavBuf - Buffer for the WAVE file. waveformData points into buffer and sl_cleanup_wave_file leaves it alone.
+ * @param buffer - Where the samples go. Use sl_probe_wave_file or a first call with a capacity of 0 to find out how big it needs to be.
+ * @param capacity - Size of buffer in bytes.
+ * @return SL_SUCCESS if it succeeded. SL_BUFFER_TOO_SMALL if the samples don't fit, wavBuf->dataChunk.dataChunkSize says how many bytes they need.
+ * SL_INVALID_CHUNK_FMT_AUDIO_FORMAT if the file is IMA ADPCM. Anything else means a failure.
  */
-DLL_EXPORT static SL_RETURN_CODE sl_read_wave_data_chunk(FILE* file, SL_WAV_FILE* wavBuf);
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_file_into(SLstr path, SL_WAV_FILE* wavBuf, SLvoid buffer, SLullong capacity);
 
 /**
- * @brief Ensures WAVE data ends on a proper byte boundary. This is a helper function and should not be used except by SAL.
- * @param wavBuf - Buffer for the WAVE file.
- * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ * @brief Same as sl_read_wave_file_into but reads from a SL_IO.
+ * @param io - Where to read the WAVE file from. It has to be able to seek.
+ * @param wavBuf - Buffer for the WAVE file. waveformData points into buffer and sl_cleanup_wave_file leaves it alone.
+ * @param buffer - Where the samples go.
+ * @param capacity - Size of buffer in bytes.
+ * @return SL_SUCCESS if it succeeded. SL_BUFFER_TOO_SMALL if the samples don't fit. SL_INVALID_CHUNK_FMT_AUDIO_FORMAT if the file is IMA ADPCM.
+ * Anything else means a failure.
  */
-DLL_EXPORT static SL_RETURN_CODE sl_validate_wave_data(SL_WAV_FILE* wavBuf);
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_io_into(SL_IO* io, SL_WAV_FILE* wavBuf, SLvoid buffer, SLullong capacity);
 
 /**
- * @brief Ensures WAVE data endian-ness is correct. This is a helper function and should not be used except by SAL.
- * @param wavBuf - Buffer for the WAVE file.
+ * @brief Reads only the header of a WAVE file: the format and where the samples are. The samples themselves are not read.
+ * Most files take a single read of the first SL_HANDLE_IO_BUFFER_SIZE bytes. A format chunk after the samples costs one more.
+ * @param path - Path to the WAVE file.
+ * @param wavBuf - Buffer for the header. waveformData stays NULL, dataChunk.dataOffset and dataChunk.dataChunkSize say where the samples are. It does not need cleaning up.
+ * @return SL_SUCCESS if the file would parse. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_probe_wave_file(SLstr path, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Same as sl_probe_wave_file but reads from a SL_IO.
+ * @param io - Where to read the WAVE file from. It has to be able to seek.
+ * @param wavBuf - Buffer for the header. waveformData stays NULL.
+ * @return SL_SUCCESS if the file would parse. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_probe_wave_io(SL_IO* io, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Parses only some of the frames of the wave file at the path.
+ * The header is parsed as usual, then only the bytes of the frames asked for are read, so a piece of a huge file costs as much as the piece.
+ * The data chunk of wavBuf holds just those frames and dataOffset says where in the file they start.
+ * IMA ADPCM files have the blocks around the frames read and come back as 16 bit PCM.
+ * @param path - Path of WAVE file to parse.
+ * @param firstFrame - First frame to read.
+ * @param frameCount - Number of frames to read. Cut short at the end of the data.
+ * @param wavBuf - Buffer for the frames.
+ * @return SL_SUCCESS if succeeded. SL_INVALID_VALUE if firstFrame is past the end or frameCount is 0. Anything else means the file is bad or could not be read.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_range(SLstr path, SLullong firstFrame, SLullong frameCount, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Parses only some of the frames of a wave file read through a SL_IO. See sl_read_wave_range.
+ * @param io - Where to read the WAVE file from. It should be at the start of the RIFF header.
+ * @param firstFrame - First frame to read.
+ * @param frameCount - Number of frames to read. Cut short at the end of the data.
+ * @param wavBuf - Buffer for the frames.
+ * @return SL_SUCCESS if succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_range_io(SL_IO* io, SLullong firstFrame, SLullong frameCount, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Parses a lot of wave files at once, spread over a pool of threads.
+ * Each file goes through the same steps as sl_read_wave_file. A file failing does not stop the others.
+ * @param paths - Paths of the WAVE files to parse.
+ * @param count - Number of paths.
+ * @param out - Buffers for the WAVE files, one per path. Files that failed are left empty so sl_cleanup_wave_file is safe on all of them.
+ * @param results - Gets the SL_RETURN_CODE of each file. Can be NULL.
+ * @param opts - Options for the load. Can be NULL for the defaults.
+ * @return SL_SUCCESS if every file was parsed. SL_FAIL if any file failed, check results to see which. SL_INVALID_VALUE if the arguments are bad.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_files(const SLstr* paths, SLullong count, SL_WAV_FILE* out, SL_RETURN_CODE* results, const SL_BATCH_OPTIONS* opts);
+
+/**
+ * @brief Sets up a SL_IO that reads from an open file. The file is not closed by SAL.
+ * @param io - SL_IO to set up.
+ * @param file - File to read from. Should be opened in binary mode.
+ */
+DLL_EXPORT static void sl_io_from_file(SL_IO* io, FILE* file);
+
+/**
+ * @brief Sets up a SL_IO that reads from a block of memory.
+ * @param io - SL_IO to set up.
+ * @param mem - State for the reads. Has to live as long as io is used.
+ * @param data - Start of the memory.
+ * @param size - Size of the memory in bytes.
+ */
+DLL_EXPORT static void sl_io_from_memory(SL_IO* io, SL_MEMORY_IO* mem, const void* data, SLullong size);
+
+/**
+ * @brief Opens a file for reading through a SL_IO without stdio. Close it with sl_close_handle_io.
+ * @param handle - State for the reads. Has to live as long as the SL_IO is used.
+ * @param path - Path of the file.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_open_handle_io(SL_HANDLE_IO* handle, SLstr path);
+
+/**
+ * @brief Closes a file opened with sl_open_handle_io.
+ * @param handle - File to close.
+ */
+DLL_EXPORT static void sl_close_handle_io(SL_HANDLE_IO* handle);
+
+/**
+ * @brief Sets up a SL_IO that reads from a file opened with sl_open_handle_io.
+ * @param io - SL_IO to set up.
+ * @param handle - File to read from.
+ */
+DLL_EXPORT static void sl_io_from_handle(SL_IO* io, SL_HANDLE_IO* handle);
+
+/**
+ * @brief Frees the memory associated with the WAVE file.
+ * Mapped WAVE files are unmapped, so this is safe to call on anything SAL loaded.
+ * @param buf - Buffer of WAVE file to free.
+ */
+DLL_EXPORT static void sl_cleanup_wave_file(SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Maps the wave file at the path into memory instead of reading it.
+ * The waveformData of the buffer points straight into the mapping, so nothing is copied and the pages are shared with every other process mapping the same file.
+ * The file goes through the same validation as sl_read_wave_file.
+ * IMA ADPCM files are decoded to 16 bit PCM in a buffer of their own like sl_read_wave_file does, and the file is unmapped again.
+ * @param path - Path of WAVE file to map.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @param advice - How the data is going to be accessed. Use SL_MAP_ADVICE_NORMAL if you don't know.
+ * @return SL_SUCCESS if succeeded. SL_MAP_FAIL if the file could not be mapped. Anything else means the file itself is bad.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_map_wave_file(SLstr path, SL_WAV_FILE* wavBuf, SL_MAP_ADVICE advice);
+
+/**
+ * @brief Unmaps a WAVE file that was loaded with sl_map_wave_file.
+ * @param wavBuf - Buffer of the mapped WAVE file.
+ */
+DLL_EXPORT static void sl_unmap_wave_file(SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Gives the OS a new access pattern hint for a mapped WAVE file.
+ * Does nothing for WAVE files that are not mapped or on systems without madvise().
+ * @param wavBuf - Buffer of the mapped WAVE file.
+ * @param advice - How the data is going to be accessed.
+ * @return SL_SUCCESS if succeeded. SL_INVALID_VALUE if the buffer is not mapped.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_advise_wave_file(SL_WAV_FILE* wavBuf, SL_MAP_ADVICE advice);
+
+/**
+ * @brief Reads WAVE descriptor chunk. This is a helper function and should not be used except by SAL.
+ * @param io - Where to read the WAVE file from.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_descriptor(SL_IO* io, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Parses WAVE chunks. This is a helper function and should not be used except by SAL.
+ * @param io - Where to read the WAVE file from.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_wave_chunks(SL_IO* io, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Parses WAVE chunks, optionally skipping over the waveform data. This is a helper function and should not be used except by SAL.
+ * When readData is 0 only the size and offset of the data chunk are recorded and waveformData stays NULL.
+ * @param io - Where to read the WAVE file from.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @param readData - 1 to read the waveform data, 0 to skip it.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_wave_chunks_b(SL_IO* io, SL_WAV_FILE* wavBuf, SLbool readData);
+
+/**
+ * @brief Reads WAVE format chunk. This is a helper function and should not be used except by SAL.
+ * @param io - Where to read the WAVE file from.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_format_chunk(SL_IO* io, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Reads WAVE data chunk. This is a helper function and should not be used except by SAL.
+ * @param io - Where to read the WAVE file from.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_data_chunk(SL_IO* io, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Reads the size of the WAVE data chunk and records where its data starts. This is a helper function and should not be used except by SAL.
+ * @param io - Where to read the WAVE file from. Must be right after the data chunk id.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_read_wave_data_chunk_size(SL_IO* io, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Ensures WAVE data ends on a proper byte boundary. This is a helper function and should not be used except by SAL.
+ * @param wavBuf - Buffer for the WAVE file.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_validate_wave_data(SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Ensures WAVE data endian-ness is correct. This is a helper function and should not be used except by SAL.
+ * @param wavBuf - Buffer for the WAVE file.
  * @return SL_SUCCESS if it succeeded. Anything else means a failure.
  */
 DLL_EXPORT static SL_RETURN_CODE sl_ensure_wave_endianness(SL_WAV_FILE* wavBuf);
 
 /**
- * @brief This is just for checking if the path provided ends with ".wav" or ".wave".
- * @param str - Path to check.
- * @return SL_SUCCESS the file has the proper wav extension. SL_FAIL otherwise.
+ * @brief Ensures the endian-ness of a block of samples is correct. This is a helper function and should not be used except by SAL.
+ * @param waveformData - Samples to fix in place.
+ * @param size - Size of the samples in bytes.
+ * @param pcmType - PCM type of the samples.
+ * @param endianness - SL_ENDIANNESS the samples are stored in.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
  */
-DLL_EXPORT static SL_RETURN_CODE sl_is_wave_file(SLstr path);
+DLL_EXPORT static SL_RETURN_CODE sl_ensure_endianness(SLvoid waveformData, SLullong size, SLuint pcmType, SLuint endianness);
 
 /**
- * @brief Converts a SLuchar* buf to a SLushort, but takes into account the system's native endian-ness.
- * @param buf - Buffer to convert. This MUST be at least 2 bytes and valid.
- * @param bufLen - Length of SLuchar buffer to convert.
- * @return The value of the buffer represented as a SLushort taking into account the system's native endian-ness. Returns zero if it fails. I know it's not helpful, but you can debug!
+ * @brief Opens the wave file at the path for streaming.
+ * Only the chunks before the samples are read. The samples are read later with sl_read_wave_stream.
+ * @param path - Path of WAVE file to stream.
+ * @param stream - Buffer for the stream.
+ * @return SL_SUCCESS if succeeded. Anything else means the file could not be opened or is bad.
  */
-DLL_EXPORT static SLushort sl_buf_to_native_ushort(const SLuchar* buf, SLullong bufLen);
+DLL_EXPORT static SL_RETURN_CODE sl_open_wave_stream(SLstr path, SL_WAV_STREAM* stream);
 
 /**
- * @brief Converts a SLuchar* buf to a SLuint, but takes into account the system's native endian-ness.
- * @param buf - Buffer to convert. This MUST be at least 4 bytes and valid.
- * @param bufLen - Length of SLuchar buffer to convert.
- * @return The value of the buffer represented as a SLuint taking into account the system's native endian-ness. Returns zero if it fails. I know it's not helpful, but you can debug!
+ * @brief Opens a wave file that is read through a SL_IO for streaming.
+ * The SL_IO is copied into the stream, but whatever its user points to has to live until the stream is closed.
+ * @param io - Where to read the WAVE file from. It should be at the start of the RIFF header.
+ * @param stream - Buffer for the stream.
+ * @return SL_SUCCESS if succeeded. Anything else means the file is bad.
  */
-DLL_EXPORT static SLuint sl_buf_to_native_uint(const SLuchar* buf, SLullong bufLen);
+DLL_EXPORT static SL_RETURN_CODE sl_open_wave_stream_io(SL_IO* io, SL_WAV_STREAM* stream);
 
 /**
- * @brief Flips the endian-ness of a SLshort.
- * @param s SLshort to flip.
- * @return SLshort with the endian-ness flipped.
+ * @brief Reads the next frames of a stream. The samples are in native endian-ness.
+ * @param stream - Stream to read from.
+ * @param dst - Where to put the frames. Must hold frameCount * blockAlign bytes.
+ * @param frameCount - Number of frames to read.
+ * @return Number of frames read. Less than frameCount at the end of the data or if the file is cut short.
  */
-DLL_EXPORT static SLshort sl_flip_endian_short(SLshort s);
+DLL_EXPORT static SLullong sl_read_wave_stream(SL_WAV_STREAM* stream, SLvoid dst, SLullong frameCount);
 
 /**
- * @brief Flips the endian-ness of a SLint.
- * @param i SLint to flip.
- * @return SLint with the endian-ness flipped.
+ * @brief Moves a stream so the next read starts at a frame. Only the read position changes, nothing is read.
+ * @param stream - Stream to seek.
+ * @param frame - Frame the next sl_read_wave_stream starts at. frameCount seeks to the end.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_VALUE if the frame is past the end. SL_FILE_ERROR if the SL_IO couldn't seek.
  */
-DLL_EXPORT static SLint sl_flip_endian_int(SLint i);
+DLL_EXPORT static SL_RETURN_CODE sl_seek_wave_stream(SL_WAV_STREAM* stream, SLullong frame);
 
 /**
- * @brief Flips the endian-ness of a SLfloat.
- * @param f SLfloat to flip.
- * @return SLfloat with the endian-ness flipped.
+ * @brief Closes a stream opened with sl_open_wave_stream or sl_open_wave_stream_io.
+ * @param stream - Stream to close.
  */
-DLL_EXPORT static SLfloat sl_flip_endian_float(SLfloat f);
+DLL_EXPORT static void sl_close_wave_stream(SL_WAV_STREAM* stream);
 
 /**
- * @brief Flips the endian-ness of a SLdouble.
- * @param d SLdouble to flip.
- * @return SLdouble with the endian-ness flipped.
+ * @brief Writes a whole WAVE file. The samples are written as the PCM type they are in, so a read and a write round trips.
+ * @param path - Path of the file to make. It is replaced if it exists.
+ * @param wavBuf - WAVE file to write. Only the sample rate, channels and data chunk are looked at.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
  */
-DLL_EXPORT static SLdouble sl_flip_endian_double(SLdouble d);
+DLL_EXPORT static SL_RETURN_CODE sl_write_wave_file(SLstr path, const SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Same as sl_write_wave_file with SL_WRITE_FLAGS.
+ * @param path - Path of the file to make. It is replaced if it exists.
+ * @param wavBuf - WAVE file to write.
+ * @param flags - SL_WRITE_FLAGS or'd together.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_write_wave_file_b(SLstr path, const SL_WAV_FILE* wavBuf, SLuint flags);
+
+/**
+ * @brief Makes a WAVE file to write frames to with sl_write_wave_frames.
+ * If SL_WRITE_DIRECT is asked for but the file system can't do it, the writer quietly goes through the file cache instead.
+ * @param writer - Buffer for the writer.
+ * @param path - Path of the file to make. It is replaced if it exists.
+ * @param pcmType - SL_WAVE_PCM_TYPE of the samples.
+ * @param numChannels - Number of channels in a frame.
+ * @param sampleRate - Frames per second.
+ * @param flags - SL_WRITE_FLAGS or'd together.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_open_wave_writer(SL_WAV_WRITER* writer, SLstr path, SLuint pcmType, SLushort numChannels, SLuint sampleRate, SLuint flags);
+
+/**
+ * @brief Adds frames to the end of a WAVE file being written.
+ * @param writer - Writer to add to.
+ * @param frames - Interleaved samples in native endian-ness, the same as the parser gives them.
+ * @param frameCount - Number of frames.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_CHUNK_DATA_SIZE if the file would go over the 4GB a WAVE file can hold. SL_FILE_ERROR if a write failed.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_write_wave_frames(SL_WAV_WRITER* writer, const void* frames, SLullong frameCount);
+
+/**
+ * @brief Writes what is left, fills in the sizes in the header and closes the file. The writer is freed even if this fails.
+ * @param writer - Writer to close.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR if the file could not be finished.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_close_wave_writer(SL_WAV_WRITER* writer);
+
+/**
+ * @brief Adds bytes to a writer's buffer and writes it out whenever it fills up. This is a helper function and should not be used except by SAL.
+ * @param writer - Writer to add to.
+ * @param data - Bytes to add. Already little endian.
+ * @param size - Number of bytes.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_append_wave_writer(SL_WAV_WRITER* writer, const void* data, SLullong size);
+
+/**
+ * @brief Writes the buffer of a writer to its file. This is a helper function and should not be used except by SAL.
+ * @param writer - Writer to flush.
+ * @param size - Bytes of the buffer to write. Must be a multiple of SL_WAV_WRITER_ALIGN for direct writers.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_flush_wave_writer(SL_WAV_WRITER* writer, SLullong size);
+
+/**
+ * @brief Writes all of a block of memory at an offset of a writer's file. This is a helper function and should not be used except by SAL.
+ * @param writer - Writer whose file to write to.
+ * @param data - Bytes to write.
+ * @param size - Number of bytes.
+ * @param offset - Where in the file they go.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_write_file_at(SL_WAV_WRITER* writer, const void* data, SLullong size, SLullong offset);
+
+/**
+ * @brief Builds the 44 byte header of a writer's file with the sizes so far. This is a helper function and should not be used except by SAL.
+ * @param writer - Writer to build the header of.
+ * @param header - Where the header goes. Must hold SL_WAV_HEADER_SIZE bytes.
+ */
+DLL_EXPORT static void sl_build_wave_header(const SL_WAV_WRITER* writer, SLuchar* header);
+
+/**
+ * @brief Stores a value in a buffer in little endian. This is a helper function and should not be used except by SAL.
+ * @param buf - Where to store it. Must hold 4 bytes.
+ * @param value - Value to store.
+ */
+DLL_EXPORT static void sl_native_to_buf_uint(SLuchar* buf, SLuint value);
+
+/**
+ * @brief Stores a value in a buffer in little endian. This is a helper function and should not be used except by SAL.
+ * @param buf - Where to store it. Must hold 2 bytes.
+ * @param value - Value to store.
+ */
+DLL_EXPORT static void sl_native_to_buf_ushort(SLuchar* buf, SLushort value);
+
+/**
+ * @brief Creates an empty WAVE file cache.
+ * @param cache - Buffer for the cache.
+ * @param budget - How many bytes of WAVE files the cache may hold before it throws out unused ones.
+ * @return SL_SUCCESS if succeeded. SL_MALLOC_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_wav_cache(SL_WAV_CACHE* cache, SLullong budget);
+
+/**
+ * @brief Frees every WAVE file in the cache and the cache itself.
+ * Nothing from the cache may be in use anymore.
+ * @param cache - Cache to destroy.
+ */
+DLL_EXPORT static void sl_destroy_wav_cache(SL_WAV_CACHE* cache);
+
+/**
+ * @brief Gets the WAVE file at the path from the cache, loading it with sl_read_wave_file if it is not there yet.
+ * Safe to call from any thread. Every successful call must be paired with sl_cache_release.
+ * @param cache - Cache to look in.
+ * @param path - Path of the WAVE file. Any unique string works as long as it is also a path SAL can load.
+ * @param wavBuf - Gets the WAVE file. Don't clean it up yourself.
+ * @return SL_SUCCESS if succeeded. Anything else is what sl_read_wave_file returned.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_cache_acquire(SL_WAV_CACHE* cache, SLstr path, SL_WAV_FILE** wavBuf);
+
+/**
+ * @brief Gives back a WAVE file from sl_cache_acquire.
+ * Once nothing uses it anymore it may be thrown out if the cache is over its budget.
+ * @param cache - Cache the file came from.
+ * @param wavBuf - WAVE file to give back.
+ */
+DLL_EXPORT static void sl_cache_release(SL_WAV_CACHE* cache, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Gets a copy of the cache counters.
+ * @param cache - Cache to look at.
+ * @param stats - Gets the counters.
+ */
+DLL_EXPORT static void sl_get_wav_cache_stats(SL_WAV_CACHE* cache, SL_WAV_CACHE_STATS* stats);
+
+/**
+ * @brief Throws out least recently used files nobody is using until the cache fits its budget. This is a helper function and should not be used except by SAL.
+ * @param cache - Cache to trim. Must be locked.
+ */
+DLL_EXPORT static void sl_cache_trim(SL_WAV_CACHE* cache);
+
+/**
+ * @brief Builds a catalog of every WAVE file under a directory and writes it to indexPath.
+ * If indexPath already holds a catalog, files with the same size and last write time as before are taken from it without being opened.
+ * Everything else goes through sl_probe_wave_file. The new catalog replaces the old one in a single rename.
+ * @param directory - Directory to look through, folders inside it included.
+ * @param indexPath - Where the catalog file goes.
+ * @param stats - Gets what was reused and what was parsed. Can be NULL.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR if the directory can't be read or the catalog can't be written. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_build_catalog(SLstr directory, SLstr indexPath, SL_CATALOG_SCAN_STATS* stats);
+
+/**
+ * @brief Maps a catalog file written by sl_build_catalog. Nothing is read until it is looked up.
+ * @param catalog - Buffer for the catalog.
+ * @param indexPath - Path of the catalog file.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_CATALOG if the file is not a catalog of this version and machine, rebuild it then. SL_FILE_ERROR or SL_MAP_FAIL if it can't be mapped.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_open_catalog(SL_CATALOG* catalog, SLstr indexPath);
+
+/**
+ * @brief Unmaps a catalog from sl_open_catalog. Entries and names from it can't be used anymore.
+ * @param catalog - Catalog to close.
+ */
+DLL_EXPORT static void sl_close_catalog(SL_CATALOG* catalog);
+
+/**
+ * @brief Finds a file in a catalog by name.
+ * @param catalog - Catalog to look in.
+ * @param name - Path of the file relative to the catalog's directory, with '/' between folders.
+ * @return The entry of the file. NULL if it is not in the catalog.
+ */
+DLL_EXPORT static const SL_CATALOG_ENTRY* sl_catalog_find(const SL_CATALOG* catalog, SLstr name);
+
+/**
+ * @brief Finds a file in a catalog by name and fills in a WAVE buffer the way sl_probe_wave_file would, without touching the file.
+ * @param catalog - Catalog to look in.
+ * @param name - Path of the file relative to the catalog's directory, with '/' between folders.
+ * @param wavBuf - Buffer for the header. waveformData stays NULL. It does not need cleaning up.
+ * @return SL_SUCCESS if the file is in the catalog. SL_FAIL if it isn't.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_catalog_lookup(const SL_CATALOG* catalog, SLstr name, SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Gets the name of a catalog entry.
+ * @param catalog - Catalog the entry is from.
+ * @param entry - Entry to get the name of.
+ * @return The name, relative to the catalog's directory. It lives in the mapping.
+ */
+DLL_EXPORT static SLstr sl_catalog_name(const SL_CATALOG* catalog, const SL_CATALOG_ENTRY* entry);
+
+/**
+ * @brief Starts a new sound bank. Add sounds to it with sl_bank_writer_add and finish it with sl_close_bank_writer.
+ * @param writer - Buffer for the writer.
+ * @param path - Where the bank goes. An existing file is replaced.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR if the file can't be created.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_open_bank_writer(SL_BANK_WRITER* writer, SLstr path);
+
+/**
+ * @brief Adds a sound to a bank. Its samples are written right away so wavBuf can be cleaned up after.
+ * @param writer - Writer to add to.
+ * @param name - Name to find the sound by in the bank. Every name has to be different.
+ * @param wavBuf - The sound, with its samples in the native byte order like sl_read_wave_file leaves them.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_VALUE if wavBuf has no samples. SL_FILE_ERROR if writing failed. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_bank_writer_add(SL_BANK_WRITER* writer, SLstr name, const SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Reads a WAVE file with sl_read_wave_file and adds it to a bank.
+ * @param writer - Writer to add to.
+ * @param name - Name to find the sound by in the bank. NULL uses the path.
+ * @param path - Path of the WAVE file.
+ * @return SL_SUCCESS if it succeeded. Anything else is what sl_read_wave_file or sl_bank_writer_add returned.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_bank_writer_add_file(SL_BANK_WRITER* writer, SLstr name, SLstr path);
+
+/**
+ * @brief Writes the table of a bank and closes it. The writer can't be used after this, even if it failed.
+ * @param writer - Writer to close.
+ * @return SL_SUCCESS if the bank is complete. SL_INVALID_VALUE if two sounds had the same name. SL_FILE_ERROR if writing failed. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_close_bank_writer(SL_BANK_WRITER* writer);
+
+/**
+ * @brief Opens a sound bank with one mapping. Nothing is copied, bank->files has a SL_WAV_FILE for every sound that points into the mapping.
+ * @param bank - Buffer for the bank.
+ * @param path - Path of the bank.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_BANK if it is not a bank of this version and byte order or it is broken. SL_FILE_ERROR or SL_MAP_FAIL if it can't be mapped. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_open_bank(SL_BANK* bank, SLstr path);
+
+/**
+ * @brief Unmaps a sound bank. Nothing may use its sounds anymore, sounds made with sl_gen_sound included.
+ * @param bank - Bank to close.
+ */
+DLL_EXPORT static void sl_close_bank(SL_BANK* bank);
+
+/**
+ * @brief Finds a sound in a bank by name.
+ * @param bank - Bank to look in.
+ * @param name - Name the sound was added with.
+ * @return The sound. NULL if it is not in the bank.
+ */
+DLL_EXPORT static SL_WAV_FILE* sl_bank_find(const SL_BANK* bank, SLstr name);
+
+/**
+ * @brief Gets the name of a sound in a bank.
+ * @param bank - Bank to look in.
+ * @param index - Index of the sound, less than bank->entryCount.
+ * @return The name. It lives in the mapping.
+ */
+DLL_EXPORT static SLstr sl_bank_name(const SL_BANK* bank, SLullong index);
+
+/**
+ * @brief Creates a loader that reads many WAVE files at once. io_uring is used where the kernel has it, a thread pool everywhere else.
+ * @param loader - Buffer for the loader.
+ * @param opts - Options. NULL uses the defaults.
+ * @return SL_SUCCESS if it succeeded. SL_MALLOC_FAIL if out of memory. SL_FAIL if no threads could be started.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_loader(SL_LOADER* loader, const SL_LOADER_OPTIONS* opts);
+
+/**
+ * @brief Stops a loader. Files still loading are waited for and thrown away with everything nobody polled.
+ * @param loader - Loader to destroy.
+ */
+DLL_EXPORT static void sl_destroy_loader(SL_LOADER* loader);
+
+/**
+ * @brief Queues a WAVE file to be loaded. It comes back from sl_loader_poll with user.
+ * @param loader - Loader to load it with.
+ * @param path - Path of the WAVE file. It is copied.
+ * @param user - Anything. Handed back in the result.
+ * @return SL_SUCCESS if it was queued. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_loader_submit(SL_LOADER* loader, SLstr path, SLvoid user);
+
+/**
+ * @brief Starts queued files and hands back finished ones, oldest first. With io_uring this is also what moves the reads along, so call it often.
+ * @param loader - Loader to poll.
+ * @param results - Gets the finished files.
+ * @param max - How many results fit.
+ * @param wait - 1 to wait until at least one file is done, unless nothing is pending. 0 to return right away.
+ * @return Number of results.
+ */
+DLL_EXPORT static SLuint sl_loader_poll(SL_LOADER* loader, SL_LOADER_RESULT* results, SLuint max, SLbool wait);
+
+/**
+ * @brief Gets how many submitted files haven't been handed back yet.
+ * @param loader - Loader to look at.
+ * @return Number of files.
+ */
+DLL_EXPORT static SLullong sl_loader_pending(const SL_LOADER* loader);
+
+/**
+ * @brief Loads queued files until the loader is destroyed. This is a helper function and should not be used except by SAL.
+ * @param arg - The SL_LOADER.
+ */
+DLL_EXPORT static void sl_loader_worker(SLvoid arg);
+
+/**
+ * @brief Puts a file on the finished list. This is a helper function and should not be used except by SAL.
+ * @param loader - Loader the file belongs to. In the thread pool it must be locked.
+ * @param request - The finished file.
+ */
+DLL_EXPORT static void sl_loader_push_done(SL_LOADER* loader, SL_LOAD_REQUEST* request);
+
+#ifdef SL_HAS_IO_URING
+/**
+ * @brief Sets up an io_uring and maps its rings. This is a helper function and should not be used except by SAL.
+ * @param ring - Buffer for the ring.
+ * @param entries - Reads the ring has to hold at once.
+ * @return SL_SUCCESS if it succeeded. SL_FAIL if the kernel has no io_uring or won't give us one.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_uring_init(SL_URING* ring, SLuint entries);
+
+/**
+ * @brief Unmaps and closes an io_uring. This is a helper function and should not be used except by SAL.
+ * @param ring - Ring to close. Nothing may be in flight.
+ */
+DLL_EXPORT static void sl_uring_destroy(SL_URING* ring);
+
+/**
+ * @brief Queues a read of a file through the ring. This is a helper function and should not be used except by SAL.
+ * @param loader - Loader with the ring.
+ * @param request - File the read is for. It comes back with the completion.
+ * @param dst - Where the bytes go.
+ * @param size - Number of bytes.
+ * @param offset - Where in the file to start.
+ * @param fixed - 1 if dst is in the registered header buffers.
+ */
+DLL_EXPORT static void sl_uring_read(SL_LOADER* loader, SL_LOAD_REQUEST* request, SLvoid dst, SLuint size, SLullong offset, SLbool fixed);
+
+/**
+ * @brief Starts queued files, tells the kernel about new reads and handles completed ones. This is a helper function and should not be used except by SAL.
+ * @param loader - Loader to move along.
+ * @param wait - 1 to block until at least one file is finished, if anything is in flight.
+ * @return SL_SUCCESS if it succeeded. SL_FAIL if the kernel stopped taking reads.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_loader_pump(SL_LOADER* loader, SLbool wait);
+
+/**
+ * @brief Opens a file and reads its header through the ring. This is a helper function and should not be used except by SAL.
+ * @param loader - Loader to read it with. Must have a free header buffer.
+ * @param request - File to start.
+ */
+DLL_EXPORT static void sl_loader_start(SL_LOADER* loader, SL_LOAD_REQUEST* request);
+
+/**
+ * @brief Handles a completed read of a file. This is a helper function and should not be used except by SAL.
+ * @param loader - Loader the file belongs to.
+ * @param request - File the read was for.
+ * @param res - What the read returned. Bytes read or a negative errno.
+ */
+DLL_EXPORT static void sl_loader_complete(SL_LOADER* loader, SL_LOAD_REQUEST* request, SLint res);
+
+/**
+ * @brief Finds the samples in the header of a file and starts reading them. This is a helper function and should not be used except by SAL.
+ * @param loader - Loader the file belongs to.
+ * @param request - File whose header was read.
+ * @param headerSize - Bytes of header that were read.
+ * @return SL_SUCCESS if the samples are on their way or already there. Anything else means the file failed.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_loader_read_data(SL_LOADER* loader, SL_LOAD_REQUEST* request, SLullong headerSize);
+
+/**
+ * @brief Closes a file of the ring, gives back its header buffer and puts it on the finished list. This is a helper function and should not be used except by SAL.
+ * @param loader - Loader the file belongs to.
+ * @param request - The file.
+ * @param result - How it went. Anything but SL_SUCCESS frees the samples.
+ */
+DLL_EXPORT static void sl_loader_finish(SL_LOADER* loader, SL_LOAD_REQUEST* request, SL_RETURN_CODE result);
+#endif // SL_HAS_IO_URING
+
+/**
+ * @brief Writes bytes to a bank, counting them and remembering if it failed. This is a helper function and should not be used except by SAL.
+ * @param writer - Writer to write to.
+ * @param data - Bytes to write. NULL writes zeros.
+ * @param size - Number of bytes.
+ */
+DLL_EXPORT static void sl_bank_write(SL_BANK_WRITER* writer, const void* data, SLullong size);
+
+/**
+ * @brief Adds everything under the folder in builder->path to the catalog being built. This is a helper function and should not be used except by SAL.
+ * @param builder - The catalog being built.
+ * @param pathLength - Length of the folder in builder->path, ending with a '/'.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR if the folder can't be read. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_catalog_walk(SL_CATALOG_BUILDER* builder, SLullong pathLength);
+
+/**
+ * @brief Adds the WAVE file in builder->path to the catalog being built. This is a helper function and should not be used except by SAL.
+ * @param builder - The catalog being built.
+ * @param pathLength - Length of the path in builder->path.
+ * @param modifiedTime - Last write time of the file.
+ * @param fileSize - Size of the file.
+ * @return SL_SUCCESS if it succeeded, even if the file didn't parse. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_catalog_add_file(SL_CATALOG_BUILDER* builder, SLullong pathLength, SLllong modifiedTime, SLullong fileSize);
+
+/**
+ * @brief Writes a built catalog to a file. This is a helper function and should not be used except by SAL.
+ * @param builder - The catalog that was built.
+ * @param indexPath - Where it goes.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR if it couldn't be written. SL_MALLOC_FAIL if out of memory.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_catalog_write(SL_CATALOG_BUILDER* builder, SLstr indexPath);
+
+/**
+ * @brief Hashes a string with FNV-1a. This is a helper function and should not be used except by SAL.
+ * @param str - String to hash.
+ * @return Hash of the string.
+ */
+DLL_EXPORT static SLullong sl_hash_string(SLstr str);
+
+/**
+ * @brief This is just for checking if the path provided ends with ".wav" or ".wave".
+ * @param str - Path to check.
+ * @return SL_SUCCESS the file has the proper wav extension. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_is_wave_file(SLstr path);
+
+/**
+ * @brief Checks if a path ends with an extension, ignoring case. This is a helper function and should not be used except by SAL.
+ * @param path - Path to check.
+ * @param extension - Extension with its dot, in lower case.
+ * @return 1 if it does. 0 otherwise.
+ */
+DLL_EXPORT static SLbool sl_has_extension(SLstr path, SLstr extension);
+
+/**
+ * @brief SL_IO read for FILE*. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLullong sl_file_io_read(SLvoid user, SLvoid dst, SLullong size);
+
+/**
+ * @brief SL_IO seek for FILE*. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLint sl_file_io_seek(SLvoid user, SLllong offset, SLint origin);
+
+/**
+ * @brief SL_IO tell for FILE*. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLllong sl_file_io_tell(SLvoid user);
+
+/**
+ * @brief SL_IO read for memory. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLullong sl_memory_io_read(SLvoid user, SLvoid dst, SLullong size);
+
+/**
+ * @brief SL_IO seek for memory. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLint sl_memory_io_seek(SLvoid user, SLllong offset, SLint origin);
+
+/**
+ * @brief SL_IO tell for memory. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLllong sl_memory_io_tell(SLvoid user);
+
+/**
+ * @brief SL_IO read for SL_HANDLE_IO. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLullong sl_handle_io_read(SLvoid user, SLvoid dst, SLullong size);
+
+/**
+ * @brief SL_IO seek for SL_HANDLE_IO. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLint sl_handle_io_seek(SLvoid user, SLllong offset, SLint origin);
+
+/**
+ * @brief SL_IO tell for SL_HANDLE_IO. This is a helper function and should not be used except by SAL.
+ */
+DLL_EXPORT static SLllong sl_handle_io_tell(SLvoid user);
+
+/**
+ * @brief Reads as much of a block as the file has at an offset. This is a helper function and should not be used except by SAL.
+ * @param handle - File to read from.
+ * @param dst - Where the bytes go.
+ * @param size - Number of bytes wanted.
+ * @param offset - Where in the file to start.
+ * @return Number of bytes read. Less than size at the end of the file or if reading failed.
+ */
+DLL_EXPORT static SLullong sl_read_file_at(SL_HANDLE_IO* handle, SLvoid dst, SLullong size, SLullong offset);
+
+/**
+ * @brief Parses files of a sl_read_wave_files call until there are none left. This is a helper function and should not be used except by SAL.
+ * @param arg - The SL_BATCH_JOB.
+ */
+DLL_EXPORT static void sl_batch_worker(SLvoid arg);
+
+/**
+ * @brief Maps a whole file into memory as copy-on-write. This is a helper function and should not be used except by SAL.
+ * @param path - Path of the file to map.
+ * @param base - Gets the start of the mapping.
+ * @param size - Gets the size of the mapping.
+ * @return SL_SUCCESS if it succeeded. SL_FILE_ERROR if the file can't be opened, SL_MAP_FAIL if it can't be mapped.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_map_file(SLstr path, SLvoid* base, SLullong* size);
+
+/**
+ * @brief Unmaps a mapping made by sl_map_file. This is a helper function and should not be used except by SAL.
+ * @param base - Start of the mapping.
+ * @param size - Size of the mapping.
+ */
+DLL_EXPORT static void sl_unmap_file(SLvoid base, SLullong size);
+
+/**
+ * @brief Passes an access pattern hint for part of a mapping to the OS. This is a helper function and should not be used except by SAL.
+ * @param addr - Start of the range. Does not need to be page aligned.
+ * @param len - Length of the range.
+ * @param advice - How the range is going to be accessed.
+ */
+DLL_EXPORT static void sl_advise_mapping(SLvoid addr, SLullong len, SL_MAP_ADVICE advice);
+
+/**
+ * @brief Converts a SLuchar* buf to a SLushort, but takes into account the system's native endian-ness.
+ * @param buf - Buffer to convert. This MUST be at least 2 bytes and valid.
+ * @param bufLen - Length of SLuchar buffer to convert.
+ * @return The value of the buffer represented as a SLushort taking into account the system's native endian-ness. Returns zero if it fails. I know it's not helpful, but you can debug!
+ */
+DLL_EXPORT static SLushort sl_buf_to_native_ushort(const SLuchar* buf, SLullong bufLen);
+
+/**
+ * @brief Converts a SLuchar* buf to a SLuint, but takes into account the system's native endian-ness.
+ * @param buf - Buffer to convert. This MUST be at least 4 bytes and valid.
+ * @param bufLen - Length of SLuchar buffer to convert.
+ * @return The value of the buffer represented as a SLuint taking into account the system's native endian-ness. Returns zero if it fails. I know it's not helpful, but you can debug!
+ */
+DLL_EXPORT static SLuint sl_buf_to_native_uint(const SLuchar* buf, SLullong bufLen);
+
+/**
+ * @brief Same as sl_buf_to_native_ushort for a buffer of either endian-ness.
+ * @param buf - Buffer to convert. This MUST be at least 2 bytes and valid.
+ * @param bufLen - Length of SLuchar buffer to convert.
+ * @param endianness - SL_ENDIANNESS the value is stored in.
+ * @return The value of the buffer as a native SLushort. Returns zero if it fails.
+ */
+DLL_EXPORT static SLushort sl_buf_to_native_ushort_b(const SLuchar* buf, SLullong bufLen, SLuint endianness);
+
+/**
+ * @brief Same as sl_buf_to_native_uint for a buffer of either endian-ness.
+ * @param buf - Buffer to convert. This MUST be at least 4 bytes and valid.
+ * @param bufLen - Length of SLuchar buffer to convert.
+ * @param endianness - SL_ENDIANNESS the value is stored in.
+ * @return The value of the buffer as a native SLuint. Returns zero if it fails.
+ */
+DLL_EXPORT static SLuint sl_buf_to_native_uint_b(const SLuchar* buf, SLullong bufLen, SLuint endianness);
+
+/**
+ * @brief Flips the endian-ness of a SLshort.
+ * @param s SLshort to flip.
+ * @return SLshort with the endian-ness flipped.
+ */
+DLL_EXPORT static SLshort sl_flip_endian_short(SLshort s);
+
+/**
+ * @brief Flips the endian-ness of a SLint.
+ * @param i SLint to flip.
+ * @return SLint with the endian-ness flipped.
+ */
+DLL_EXPORT static SLint sl_flip_endian_int(SLint i);
+
+/**
+ * @brief Flips the endian-ness of a SLfloat.
+ * @param f SLfloat to flip.
+ * @return SLfloat with the endian-ness flipped.
+ */
+DLL_EXPORT static SLfloat sl_flip_endian_float(SLfloat f);
+
+/**
+ * @brief Flips the endian-ness of a SLdouble.
+ * @param d SLdouble to flip.
+ * @return SLdouble with the endian-ness flipped.
+ */
+DLL_EXPORT static SLdouble sl_flip_endian_double(SLdouble d);
+
+///////////////////////////////////////////////////////////////////
+///////////////// Sample Conversion SIMD Support //////////////////
+///////////////////////////////////////////////////////////////////
+// #define SL_NO_SIMD // un-comment this if you only want the plain C conversion loops
+
+#if !defined(SL_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SL_SSE2
+#include <emmintrin.h>
+
+// AVX2 loops are always built and only used when the CPU has it, so no -mavx2 needed
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define SL_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif
+
+#endif
+
+#if defined(SL_AVX2) && defined(__GNUC__)
+#define SL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SL_TARGET_AVX2
+#endif
+
+///////////////////////////////////////////////////////////////////////
+///////////////// Sample Conversion Struct Definitions ////////////////
+///////////////////////////////////////////////////////////////////////
+
+// number of samples converted at a time. everything it needs lives on the stack, about 4 KB, so the audio and worker threads
+// that convert don't need big stacks. still enough samples that the per block overhead doesn't show.
+#define SL_CONVERT_BLOCK 256
+
+// Flags for sl_convert_samples. They can be or'd together.
+DLL_EXPORT typedef enum {
+    SL_CONVERT_DEFAULT = 0,
+    SL_CONVERT_DITHER = 1, // add TPDF dither when the output has fewer bits than the input.
+    SL_CONVERT_PLANAR = 2 // write all of channel 0, then all of channel 1... instead of interleaving them.
+} SL_CONVERT_FLAGS;
+
+// Which conversion loops SAL uses. The best one the CPU supports is picked unless you set it with sl_set_simd_level.
+DLL_EXPORT typedef enum {
+    SL_SIMD_SCALAR = 0,
+    SL_SIMD_SSE2 = 1,
+    SL_SIMD_AVX2 = 2
+} SL_SIMD_LEVEL;
+
+// turns count samples into floats in [-1, 1)
+DLL_EXPORT typedef void (*SL_DECODE_FUNC)(const void* src, SLfloat* dst, SLullong count);
+// turns count floats back into samples. noise is NULL or dither in units of the output's LSB
+DLL_EXPORT typedef void (*SL_ENCODE_FUNC)(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count);
+// makes count samples of TPDF noise in (-1, 1). state is 8 xorshift lanes that are never 0.
+// sample i always comes from lane i & 7, which steps twice for it, so every level makes the same noise
+DLL_EXPORT typedef void (*SL_NOISE_FUNC)(SLuint* state, SLfloat* dst, SLullong count);
+// reverses the bytes of count samples that are size bytes each, in place
+DLL_EXPORT typedef void (*SL_SWAP_FUNC)(SLvoid data, SLullong count, SLuint size);
+// adds count samples of src times gain to dst
+DLL_EXPORT typedef void (*SL_MIX_FUNC)(SLfloat* dst, const SLfloat* src, SLfloat gain, SLullong count);
+// sum of a[i] * b[i]. count is a multiple of 8
+DLL_EXPORT typedef SLfloat (*SL_DOT_FUNC)(const SLfloat* a, const SLfloat* b, SLullong count);
+
+// The conversion loops for one SL_SIMD_LEVEL, indexed by SL_WAVE_PCM_TYPE.
+DLL_EXPORT typedef struct sl_convert_kernels {
+    SL_DECODE_FUNC decode[SL_FLOAT_64PCM + 1];
+    SL_ENCODE_FUNC encode[SL_FLOAT_64PCM + 1];
+    SL_NOISE_FUNC noise;
+    SL_SWAP_FUNC swap;
+    SL_MIX_FUNC mix;
+    SL_MIX_FUNC mixMono; // count is in frames. each mono sample is added to both channels of a stereo dst
+    SL_DOT_FUNC dot;
+} SL_CONVERT_KERNELS;
+
+// frames a resampler takes in at a time. bounds its history buffer.
+#define SL_RESAMPLE_BLOCK 1024
+
+// most filter phases a resampler keeps. ratios that need more blend the two phases on either side of each output.
+#define SL_RESAMPLE_MAX_PHASES 1024
+
+// most the input rate can be over the output rate.
+#define SL_RESAMPLE_MAX_RATIO 64
+
+// How good a resampler sounds against how much it costs. Each step doubles the filter length.
+DLL_EXPORT typedef enum {
+    SL_RESAMPLE_FAST = 0, // 16 taps. fine for sound effects.
+    SL_RESAMPLE_MEDIUM = 1, // 32 taps.
+    SL_RESAMPLE_BEST = 2 // 64 taps. for music and anything people listen to closely.
+} SL_RESAMPLE_QUALITY;
+
+// Changes the sample rate of float samples with a windowed sinc polyphase filter.
+// It keeps the last frames it saw, so a stream can be fed to it a block at a time and comes out the same as all at once.
+DLL_EXPORT typedef struct sl_resampler {
+    SLuint inRate;
+    SLuint outRate;
+    SLuint channels;
+    SLuint up; // outRate over the greatest common divisor of the rates.
+    SLuint down; // inRate over the greatest common divisor of the rates.
+    SLuint taps; // length of the filter. always a multiple of 8.
+    SLuint phaseCount;
+    SLfloat* filter; // phaseCount + 1 filters of taps coefficients each. the last is the first shifted by one input sample.
+    SLfloat* history; // planar input frames, capacity frames per channel.
+    SLullong capacity;
+    SLullong fill; // frames in history.
+    SLllong start; // input frame that history starts at. negative at first because of the zeros in front of the input.
+    SLllong pos; // input frame the next output frame is at.
+    SLuint frac; // how far past pos the next output frame is, in 1 / up.
+    SLullong inTotal; // input frames given so far.
+} SL_RESAMPLER;
+
+/////////////////////////////////////////////////////////////////////////
+///////////////// Sample Conversion Function Definitions ///////////////
+/////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Gets the size of one sample of a PCM type.
+ * @param pcmType - One of SL_WAVE_PCM_TYPE.
+ * @return Size of one sample in bytes. 0 if the type is unknown.
+ */
+DLL_EXPORT static SLuint sl_pcm_type_size(SLuint pcmType);
+
+/**
+ * @brief Converts interleaved samples from one PCM type to another.
+ * Every pair of SL_WAVE_PCM_TYPE works. Integers are scaled so that full scale maps to [-1, 1) as a float.
+ * Going to a smaller type clamps instead of wrapping.
+ * @param src - Interleaved samples to convert. They should be in native endian-ness, which is what the parser gives you.
+ * @param srcType - PCM type of src.
+ * @param dst - Where the converted samples go. Must hold frameCount * channels samples of dstType. Must not overlap src.
+ * @param dstType - PCM type to convert to.
+ * @param frameCount - Number of frames to convert.
+ * @param channels - Number of channels in a frame.
+ * @param flags - SL_CONVERT_FLAGS or'd together. SL_CONVERT_DEFAULT for interleaved output without dither.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_VALUE if a pointer, type or the channel count is bad.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_convert_samples(const void* src, SLuint srcType, SLvoid dst, SLuint dstType, SLullong frameCount, SLuint channels, SLuint flags);
+
+/**
+ * @brief Converts the samples of a parsed WAVE file to another PCM type.
+ * @param wavBuf - WAVE file to convert. It is left alone.
+ * @param pcmType - PCM type to convert to.
+ * @param dst - Where the converted samples go. Must hold every sample of the file as pcmType.
+ * @param flags - SL_CONVERT_FLAGS or'd together.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_convert_wave_data(const SL_WAV_FILE* wavBuf, SLuint pcmType, SLvoid dst, SLuint flags);
+
+/**
+ * @brief Gets the number of frames in a parsed WAVE file. Works for IMA ADPCM files too, where the size of the data doesn't say.
+ * @param wavBuf - WAVE file to count.
+ * @return Number of frames. 0 if the format is unknown.
+ */
+DLL_EXPORT static SLullong sl_wave_frame_count(const SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Decodes frames of an IMA ADPCM file to interleaved 16 bit samples.
+ * Only the blocks the frames are in get decoded, so this is how compressed files are played a piece at a time.
+ * @param wavBuf - IMA ADPCM file. It is left alone.
+ * @param decoder - Where the last call got up to, so reading on from there doesn't go back to the start of the block. NULL to always start from the block.
+ * @param firstFrame - First frame to decode.
+ * @param out - Where the samples go. Must hold frameCount * numChannels samples.
+ * @param frameCount - Number of frames to decode.
+ * @return Number of frames decoded. Less than frameCount at the end of the file, 0 if the file isn't IMA ADPCM.
+ */
+DLL_EXPORT static SLullong sl_decode_adpcm(const SL_WAV_FILE* wavBuf, SL_ADPCM_DECODER* decoder, SLullong firstFrame, SLshort* out, SLullong frameCount);
+
+/**
+ * @brief Decodes a whole IMA ADPCM file to 16 bit PCM in place of the compressed samples.
+ * The format chunk is changed to match, so afterwards the file is like any other 16 bit file. Files that aren't compressed are left alone.
+ * @param wavBuf - WAVE file to decode.
+ * @return SL_SUCCESS if it succeeded. SL_MALLOC_FAIL if there's no memory for the samples.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_decompress_wave_file(SL_WAV_FILE* wavBuf);
+
+/**
+ * @brief Decodes one 4 bit IMA ADPCM sample.
+ * This is a helper function and should not be used except by SAL.
+ * @param predictor - The channel's last sample. Becomes the new one.
+ * @param index - The channel's place in the step table.
+ * @param nibble - The 4 bits to decode.
+ */
+DLL_EXPORT static void sl_ima_decode_nibble(SLint* predictor, SLint* index, SLuint nibble);
+
+/**
+ * @brief Gets the conversion loops SAL is using.
+ * @return One of SL_SIMD_LEVEL.
+ */
+DLL_EXPORT static SLuint sl_get_simd_level(void);
+
+/**
+ * @brief Caps the conversion loops SAL uses. Mostly useful for testing and benchmarks.
+ * Asking for more than the CPU has gives the best it has.
+ * @param level - One of SL_SIMD_LEVEL. Anything negative goes back to picking automatically.
+ */
+DLL_EXPORT static void sl_set_simd_level(SLint level);
+
+/**
+ * @brief Finds the best SL_SIMD_LEVEL the CPU and OS support. This is a helper function and should not be used except by SAL.
+ * @return One of SL_SIMD_LEVEL.
+ */
+DLL_EXPORT static SLuint sl_detect_simd_level(void);
+
+/**
+ * @brief Gets the conversion loops for the current SL_SIMD_LEVEL. This is a helper function and should not be used except by SAL.
+ * @return The loops to use.
+ */
+DLL_EXPORT static const SL_CONVERT_KERNELS* sl_get_convert_kernels(void);
+
+/**
+ * @brief Converts between 32 bit ints and doubles without going through a float. This is a helper function and should not be used except by SAL.
+ * @param src - Samples to convert.
+ * @param srcType - SL_SIGNED_32PCM or SL_FLOAT_64PCM.
+ * @param dst - Where the converted samples go.
+ * @param noise - Dither to add when going to ints, or NULL.
+ * @param count - Number of samples.
+ */
+DLL_EXPORT static void sl_convert_block_double(const void* src, SLuint srcType, SLvoid dst, const SLfloat* noise, SLullong count);
+
+/**
+ * @brief Moves interleaved samples to where they go in planar output. This is a helper function and should not be used except by SAL.
+ * @param in - Interleaved samples.
+ * @param out - Start of the planar output.
+ * @param first - Index of the first sample of in within the whole interleaved stream.
+ * @param count - Number of samples in in.
+ * @param channels - Number of channels.
+ * @param frameCount - Total frames in the output. This is the length of one plane.
+ * @param size - Size of one sample in bytes.
+ */
+DLL_EXPORT static void sl_scatter_planar(const SLuchar* in, SLuchar* out, SLullong first, SLullong count, SLuint channels, SLullong frameCount, SLuint size);
+
+/**
+ * @brief Sets up a resampler for float samples.
+ * @param resampler - Buffer for the resampler.
+ * @param inRate - Sample rate of the input.
+ * @param outRate - Sample rate of the output.
+ * @param channels - Number of interleaved channels.
+ * @param quality - One of SL_RESAMPLE_QUALITY.
+ * @return SL_SUCCESS if it succeeded. SL_INVALID_VALUE if a rate, the channels or the quality is bad. SL_MALLOC_FAIL if the filter could not be made.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_resampler(SL_RESAMPLER* resampler, SLuint inRate, SLuint outRate, SLuint channels, SLuint quality);
+
+/**
+ * @brief Frees a resampler.
+ * @param resampler - Resampler to destroy.
+ */
+DLL_EXPORT static void sl_destroy_resampler(SL_RESAMPLER* resampler);
+
+/**
+ * @brief Gets the most frames sl_resample can give back for some input frames. Use it to size the output.
+ * @param resampler - Resampler that will be used.
+ * @param frameCount - Number of input frames.
+ * @return Most output frames.
+ */
+DLL_EXPORT static SLullong sl_resample_max_output(const SL_RESAMPLER* resampler, SLullong frameCount);
+
+/**
+ * @brief Resamples the next block of a stream. Output frames come out once the filter has seen enough input after them,
+ * so the first calls give back a little less than the rate says. sl_flush_resampler gives back the rest at the end.
+ * @param resampler - Resampler to use.
+ * @param in - Interleaved float input frames.
+ * @param frameCount - Number of input frames. All of them are used.
+ * @param out - Where the interleaved float output frames go. Must hold sl_resample_max_output(resampler, frameCount) frames.
+ * @return Number of output frames.
+ */
+DLL_EXPORT static SLullong sl_resample(SL_RESAMPLER* resampler, const SLfloat* in, SLullong frameCount, SLfloat* out);
+
+/**
+ * @brief Gives back the output frames held back for the end of the input. Call it once after the last sl_resample.
+ * @param resampler - Resampler to flush.
+ * @param out - Where the interleaved float output frames go. Must hold sl_resample_max_output(resampler, resampler->taps) frames.
+ * @return Number of output frames.
+ */
+DLL_EXPORT static SLullong sl_flush_resampler(SL_RESAMPLER* resampler, SLfloat* out);
+
+/**
+ * @brief Resamples a whole WAVE file. The samples keep their PCM type, only the sample rate changes.
+ * Use it at load time to bring everything to the device's rate so nothing has to be resampled while playing.
+ * @param wavBuf - WAVE file to resample. It is left alone.
+ * @param outRate - Sample rate to resample to.
+ * @param quality - One of SL_RESAMPLE_QUALITY.
+ * @param out - Buffer for the resampled WAVE file. Clean it up with sl_cleanup_wave_file.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_resample_wave_file(const SL_WAV_FILE* wavBuf, SLuint outRate, SLuint quality, SL_WAV_FILE* out);
+
+/**
+ * @brief Resamples frames, or zeros when in is NULL, and only gives back output before limit. This is a helper function and should not be used except by SAL.
+ * @param resampler - Resampler to use.
+ * @param in - Interleaved float input frames or NULL.
+ * @param frameCount - Number of input frames.
+ * @param out - Where the output frames go.
+ * @param limit - Output frames at or after this input frame are not made.
+ * @return Number of output frames.
+ */
+DLL_EXPORT static SLullong sl_resample_block(SL_RESAMPLER* resampler, const SLfloat* in, SLullong frameCount, SLfloat* out, SLllong limit);
+
+/**
+ * @brief Fills in the polyphase filter of a resampler. This is a helper function and should not be used except by SAL.
+ * @param resampler - Resampler with its rates, taps and phases set.
+ * @param beta - Kaiser window shape. Higher means less leaks through but a wider transition.
+ * @param rolloff - Where the pass band ends as a part of the lower Nyquist frequency.
+ */
+DLL_EXPORT static void sl_make_resample_filter(SL_RESAMPLER* resampler, SLdouble beta, SLdouble rolloff);
+
+/**
+ * @brief Modified Bessel function of the first kind of order 0, for the Kaiser window. This is a helper function and should not be used except by SAL.
+ * @param x - Where to evaluate it.
+ * @return I0(x).
+ */
+DLL_EXPORT static SLdouble sl_bessel_i0(SLdouble x);
+
+/**
+ * @brief Greatest common divisor. This is a helper function and should not be used except by SAL.
+ * @param a - First number.
+ * @param b - Second number.
+ * @return The greatest common divisor of a and b.
+ */
+DLL_EXPORT static SLuint sl_gcd(SLuint a, SLuint b);
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////// Wave File Parser Function Implementations ///////////////////
+///////////////////////////////////////////////////////////////////////////////
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_file(SLstr path, SL_WAV_FILE* wavBuf) {
+    return sl_read_wave_file_b(path, wavBuf, SL_READ_DEFAULT);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_file_b(SLstr path, SL_WAV_FILE* wavBuf, SLuint flags) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    SL_HANDLE_IO handle;
+    SL_IO io;
+
+    //ensure pointers are good were just going to assume the user allocated stuff right
+    if (path == NULL) {
+        ret = SL_INVALID_VALUE;
+        goto exit;
+    }
+
+    //ensures that this file we are reading is a wave file-or at least ends with it
+    if(sl_is_wave_file(path) == SL_FAIL) {
+        ret = SL_FILE_ERROR;
+        goto exit;
+    }
+
+    // try to open file. straight from the OS, stdio would allocate a buffer only to copy the samples through it
+    ret = sl_open_handle_io(&handle, path);
+    if (ret != SL_SUCCESS) goto exit;
+
+    sl_io_from_handle(&io, &handle);
+    ret = sl_read_wave_io_b(&io, wavBuf, flags);
+
+    sl_close_handle_io(&handle);
+    exit:
+        return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_io(SL_IO* io, SL_WAV_FILE* wavBuf) {
+    return sl_read_wave_io_b(io, wavBuf, SL_READ_DEFAULT);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_io_b(SL_IO* io, SL_WAV_FILE* wavBuf, SLuint flags) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    if (io == NULL || io->read == NULL || io->seek == NULL || io->tell == NULL)
+        return SL_INVALID_VALUE;
+
+    SL_STATS_TIME(descriptorTime, ret = sl_read_wave_descriptor(io, wavBuf));
+    if(ret != SL_SUCCESS) goto bufCleanup;
+
+    SL_STATS_TIME(chunkTime, ret = sl_parse_wave_chunks(io, wavBuf));
+    if(ret != SL_SUCCESS) goto bufCleanup;
+
+    ret = sl_validate_wave_data(wavBuf);
+    if(ret != SL_SUCCESS) goto bufCleanup;
+
+    ret = sl_ensure_wave_endianness(wavBuf);
+    if(ret != SL_SUCCESS) goto bufCleanup;
+
+    if (!(flags & SL_READ_KEEP_COMPRESSED)) {
+        ret = sl_decompress_wave_file(wavBuf);
+        if(ret != SL_SUCCESS) goto bufCleanup;
+    }
+
+    if (wavBuf->dataChunk.waveformData != NULL) {
+        SL_STATS_ADD(filesParsed, 1);
+        return SL_SUCCESS;
+    }
+    ret = SL_FAIL;
+
+    bufCleanup:
+        if(wavBuf->dataChunk.waveformData != NULL) sl_free(wavBuf->dataChunk.waveformData);
+        wavBuf->dataChunk.waveformData = NULL;
+        return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_memory(const void* data, SLullong size, SL_WAV_FILE* wavBuf, SLbool alias) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    SL_MEMORY_IO mem;
+    SL_IO io;
+
+    if (data == NULL) {
+        memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+        return SL_INVALID_VALUE;
+    }
+
+    sl_io_from_memory(&io, &mem, data, size);
+
+    if (!alias) return sl_read_wave_io(&io, wavBuf);
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    // same as sl_map_wave_file, find the samples and point at them
+    SL_STATS_TIME(descriptorTime, ret = sl_read_wave_descriptor(&io, wavBuf));
+    if(ret != SL_SUCCESS) return ret;
+
+    SL_STATS_TIME(chunkTime, ret = sl_parse_wave_chunks_b(&io, wavBuf, 0));
+    if(ret != SL_SUCCESS) return ret;
+
+    ret = sl_validate_wave_data(wavBuf);
+    if(ret != SL_SUCCESS) return ret;
+
+    // samples that need flipping or decoding have to be copied, we can't write to the caller's bytes
+    if (wavBuf->descriptorChunk.endianness != sl_get_native_endianness() || wavBuf->dataChunk.pcmType == SL_IMA_ADPCM) {
+        sl_io_from_memory(&io, &mem, data, size);
+        return sl_read_wave_io(&io, wavBuf);
+    }
+
+    if (wavBuf->dataChunk.dataOffset + wavBuf->dataChunk.dataChunkSize > size)
+        return SL_INVALID_CHUNK_DATA_DATA;
+
+    wavBuf->dataChunk.waveformData = (SLvoid) ((const SLuchar*) data + wavBuf->dataChunk.dataOffset);
+    wavBuf->storage = SL_STORAGE_BORROWED;
+    SL_STATS_ADD(filesParsed, 1);
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_file_into(SLstr path, SL_WAV_FILE* wavBuf, SLvoid buffer, SLullong capacity) {
+    SL_RETURN_CODE ret;
+    SL_HANDLE_IO handle;
+    SL_IO io;
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    if (path == NULL) return SL_INVALID_VALUE;
+    if (sl_is_wave_file(path) == SL_FAIL) return SL_FILE_ERROR;
+
+    ret = sl_open_handle_io(&handle, path);
+    if (ret != SL_SUCCESS) return ret;
+
+    sl_io_from_handle(&io, &handle);
+    ret = sl_read_wave_io_into(&io, wavBuf, buffer, capacity);
+
+    sl_close_handle_io(&handle);
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_io_into(SL_IO* io, SL_WAV_FILE* wavBuf, SLvoid buffer, SLullong capacity) {
+    SL_RETURN_CODE ret;
+    SLbool blocksRead;
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    if (io == NULL || io->read == NULL || io->seek == NULL || io->tell == NULL)
+        return SL_INVALID_VALUE;
+
+    // find out where the samples are and how many there are first, then read them straight into the caller's buffer
+    SL_STATS_TIME(descriptorTime, ret = sl_read_wave_descriptor(io, wavBuf));
+    if(ret != SL_SUCCESS) return ret;
+
+    SL_STATS_TIME(chunkTime, ret = sl_parse_wave_chunks_b(io, wavBuf, 0));
+    if(ret != SL_SUCCESS) return ret;
+
+    ret = sl_validate_wave_data(wavBuf);
+    if(ret != SL_SUCCESS) return ret;
+
+    // the decoded samples are bigger than the compressed ones and need somewhere to come from
+    if (wavBuf->dataChunk.pcmType == SL_IMA_ADPCM) return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+
+    if (buffer == NULL || wavBuf->dataChunk.dataChunkSize > capacity) return SL_BUFFER_TOO_SMALL;
+
+    if (io->seek(io->user, (SLllong) wavBuf->dataChunk.dataOffset, SEEK_SET) != 0) return SL_INVALID_CHUNK_DATA_DATA;
+
+    SL_STATS_TIME(dataReadTime, blocksRead = io->read(io->user, buffer, wavBuf->dataChunk.dataChunkSize) == wavBuf->dataChunk.dataChunkSize);
+    if (!blocksRead) return SL_INVALID_CHUNK_DATA_DATA;
+
+    wavBuf->dataChunk.waveformData = buffer;
+    wavBuf->storage = SL_STORAGE_BORROWED;
+
+    ret = sl_ensure_wave_endianness(wavBuf);
+    if(ret != SL_SUCCESS) {
+        sl_cleanup_wave_file(wavBuf);
+        return ret;
+    }
+
+    SL_STATS_ADD(filesParsed, 1);
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_probe_wave_file(SLstr path, SL_WAV_FILE* wavBuf) {
+    SL_RETURN_CODE ret;
+    SL_HANDLE_IO handle;
+    SL_IO io;
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    if (path == NULL) return SL_INVALID_VALUE;
+    if (sl_is_wave_file(path) == SL_FAIL) return SL_FILE_ERROR;
+
+    // the handle reads SL_HANDLE_IO_BUFFER_SIZE bytes at a time and seeking only moves its position,
+    // so skipping the samples doesn't touch the disk
+    ret = sl_open_handle_io(&handle, path);
+    if (ret != SL_SUCCESS) return ret;
+
+    sl_io_from_handle(&io, &handle);
+    ret = sl_probe_wave_io(&io, wavBuf);
+
+    sl_close_handle_io(&handle);
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_probe_wave_io(SL_IO* io, SL_WAV_FILE* wavBuf) {
+    SL_RETURN_CODE ret;
+    SLllong end;
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    if (io == NULL || io->read == NULL || io->seek == NULL || io->tell == NULL)
+        return SL_INVALID_VALUE;
+
+    SL_STATS_TIME(descriptorTime, ret = sl_read_wave_descriptor(io, wavBuf));
+    if(ret != SL_SUCCESS) return ret;
+
+    SL_STATS_TIME(chunkTime, ret = sl_parse_wave_chunks_b(io, wavBuf, 0));
+    if(ret != SL_SUCCESS) return ret;
+
+    ret = sl_validate_wave_data(wavBuf);
+    if(ret != SL_SUCCESS) return ret;
+
+    // a truncated file would fail to read, so it fails the probe too
+    if (io->seek(io->user, 0, SEEK_END) != 0) return SL_INVALID_CHUNK_DATA_DATA;
+    end = io->tell(io->user);
+    if (end < 0 || wavBuf->dataChunk.dataOffset + wavBuf->dataChunk.dataChunkSize > (SLullong) end)
+        return SL_INVALID_CHUNK_DATA_DATA;
+
+    SL_STATS_ADD(filesProbed, 1);
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_range(SLstr path, SLullong firstFrame, SLullong frameCount, SL_WAV_FILE* wavBuf) {
+    SL_RETURN_CODE ret;
+    SL_HANDLE_IO handle;
+    SL_IO io;
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    if (path == NULL) return SL_INVALID_VALUE;
+    if (sl_is_wave_file(path) == SL_FAIL) return SL_FILE_ERROR;
+
+    // the header goes through the handle's small buffer and the seek past the frames we skip is free
+    ret = sl_open_handle_io(&handle, path);
+    if (ret != SL_SUCCESS) return ret;
+
+    sl_io_from_handle(&io, &handle);
+    ret = sl_read_wave_range_io(&io, firstFrame, frameCount, wavBuf);
+
+    sl_close_handle_io(&handle);
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_range_io(SL_IO* io, SLullong firstFrame, SLullong frameCount, SL_WAV_FILE* wavBuf) {
+    SL_RETURN_CODE ret;
+    SLullong frames, offset, size, skip = 0;
+    SLuint channels;
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    if (io == NULL || io->read == NULL || io->seek == NULL || io->tell == NULL)
+        return SL_INVALID_VALUE;
+
+    SL_STATS_TIME(descriptorTime, ret = sl_read_wave_descriptor(io, wavBuf));
+    if(ret != SL_SUCCESS) return ret;
+
+    SL_STATS_TIME(chunkTime, ret = sl_parse_wave_chunks_b(io, wavBuf, 0));
+    if(ret != SL_SUCCESS) return ret;
+
+    ret = sl_validate_wave_data(wavBuf);
+    if(ret != SL_SUCCESS) return ret;
+
+    frames = sl_wave_frame_count(wavBuf);
+    if (frameCount == 0 || firstFrame >= frames) return SL_INVALID_VALUE;
+    if (frameCount > frames - firstFrame) frameCount = frames - firstFrame;
+
+    channels = wavBuf->formatChunk.numChannels;
+    if (wavBuf->dataChunk.pcmType == SL_IMA_ADPCM) {
+        // blocks only decode from their start, so read every block the frames touch
+        SLullong samplesPerBlock = wavBuf->formatChunk.samplesPerBlock;
+        SLullong firstBlock = firstFrame / samplesPerBlock;
+        SLullong end = ((firstFrame + frameCount - 1) / samplesPerBlock + 1) * wavBuf->formatChunk.blockAlign;
+
+        offset = firstBlock * wavBuf->formatChunk.blockAlign;
+        if (end > wavBuf->dataChunk.dataChunkSize) end = wavBuf->dataChunk.dataChunkSize;
+        size = end - offset;
+        skip = (firstFrame - firstBlock * samplesPerBlock) * channels * sizeof(SLshort);
+    } else {
+        offset = firstFrame * wavBuf->formatChunk.blockAlign;
+        size = frameCount * wavBuf->formatChunk.blockAlign;
+    }
+
+    if (io->seek(io->user, (SLllong) (wavBuf->dataChunk.dataOffset + offset), SEEK_SET) != 0)
+        return SL_INVALID_CHUNK_DATA_DATA;
+
+    wavBuf->dataChunk.waveformData = sl_aligned_malloc(size);
+    if (wavBuf->dataChunk.waveformData == NULL) return SL_MALLOC_FAIL;
+
+    wavBuf->dataChunk.dataOffset += offset;
+    wavBuf->dataChunk.dataChunkSize = (SLuint) size;
+
+    SL_STATS_TIME(dataReadTime, ret = io->read(io->user, wavBuf->dataChunk.waveformData, size) == size ? SL_SUCCESS : SL_INVALID_CHUNK_DATA_DATA);
+    if(ret != SL_SUCCESS) goto bufCleanup;
+
+    ret = sl_ensure_wave_endianness(wavBuf);
+    if(ret != SL_SUCCESS) goto bufCleanup;
+
+    // decode the blocks and drop the frames in front of the first one we wanted
+    if (wavBuf->dataChunk.pcmType == SL_IMA_ADPCM) {
+        ret = sl_decompress_wave_file(wavBuf);
+        if(ret != SL_SUCCESS) goto bufCleanup;
+
+        size = frameCount * channels * sizeof(SLshort);
+        if (skip > 0) memmove(wavBuf->dataChunk.waveformData, (SLuchar*) wavBuf->dataChunk.waveformData + skip, (size_t) size);
+        wavBuf->dataChunk.dataChunkSize = (SLuint) size;
+    }
+
+    SL_STATS_ADD(filesParsed, 1);
+    return SL_SUCCESS;
+
+    bufCleanup:
+        sl_free(wavBuf->dataChunk.waveformData);
+        wavBuf->dataChunk.waveformData = NULL;
+        return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_files(const SLstr* paths, SLullong count, SL_WAV_FILE* out, SL_RETURN_CODE* results, const SL_BATCH_OPTIONS* opts) {
+    SL_BATCH_JOB job;
+    SL_THREAD* threads = NULL;
+    SLuint threadCount;
+    SLuint started = 0;
+
+    if (paths == NULL || out == NULL) return SL_INVALID_VALUE;
+    if (count == 0) return SL_SUCCESS;
+
+    threadCount = (opts != NULL && opts->threadCount != 0) ? opts->threadCount : sl_get_cpu_count();
+    if (threadCount > count) threadCount = (SLuint) count;
+
+    job.paths = paths;
+    job.out = out;
+    job.results = results;
+    job.count = count;
+    job.next = 0;
+    job.failed = 0;
+    sl_mutex_init(&job.mutex);
+
+    // the calling thread is one of the workers so a single thread never starts anything
+    if (threadCount > 1) {
+        threads = (SL_THREAD*) sl_malloc(sizeof(SL_THREAD) * (threadCount - 1));
+
+        // without the extra threads the files still get loaded, just slower
+        if (threads != NULL) {
+            while (started < threadCount - 1 && sl_thread_create(&threads[started], sl_batch_worker, &job) == SL_SUCCESS)
+                started++;
+        }
+    }
+
+    sl_batch_worker(&job);
+
+    for (SLuint i = 0; i < started; ++i) sl_thread_join(threads[i]);
+    sl_free(threads);
+    sl_mutex_destroy(&job.mutex);
+
+    return job.failed == 0 ? SL_SUCCESS : SL_FAIL;
+}
+
+DLL_EXPORT void sl_cleanup_wave_file(SL_WAV_FILE* wavBuf) {
+    if(wavBuf != NULL) {
+        if(wavBuf->storage == SL_STORAGE_MAPPED) {
+            sl_unmap_wave_file(wavBuf);
+            return;
+        }
+
+        // not ours to free
+        if(wavBuf->storage == SL_STORAGE_BORROWED) {
+            wavBuf->dataChunk.waveformData = NULL;
+            wavBuf->storage = SL_STORAGE_OWNED;
+            return;
+        }
+
+        if(wavBuf->dataChunk.waveformData != NULL) sl_free(wavBuf->dataChunk.waveformData);
+        wavBuf->dataChunk.waveformData = NULL;
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_map_wave_file(SLstr path, SL_WAV_FILE* wavBuf, SL_MAP_ADVICE advice) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+
+    SL_MEMORY_IO mem;
+    SL_IO io;
+
+    if (path == NULL) {
+        ret = SL_INVALID_VALUE;
+        goto exit;
+    }
+
+    if(sl_is_wave_file(path) == SL_FAIL) {
+        ret = SL_FILE_ERROR;
+        goto exit;
+    }
+
+    ret = sl_map_file(path, &wavBuf->storageBase, &wavBuf->storageSize);
+    if(ret != SL_SUCCESS) goto exit;
+
+    wavBuf->storage = SL_STORAGE_MAPPED;
+
+    // run the normal chunk parser over the mapping but leave the samples where they are. we only need to know where they start
+    sl_io_from_memory(&io, &mem, wavBuf->storageBase, wavBuf->storageSize);
+
+    SL_STATS_TIME(descriptorTime, ret = sl_read_wave_descriptor(&io, wavBuf));
+    if(ret != SL_SUCCESS) goto mapCleanup;
+
+    SL_STATS_TIME(chunkTime, ret = sl_parse_wave_chunks_b(&io, wavBuf, 0));
+    if(ret != SL_SUCCESS) goto mapCleanup;
+
+    ret = sl_validate_wave_data(wavBuf);
+    if(ret != SL_SUCCESS) goto mapCleanup;
+
+    // the data chunk can claim more than the file actually has. a read would catch this so we have to as well
+    if (wavBuf->dataChunk.dataOffset + wavBuf->dataChunk.dataChunkSize > wavBuf->storageSize) {
+        ret = SL_INVALID_CHUNK_DATA_DATA;
+        goto mapCleanup;
+    }
+
+    wavBuf->dataChunk.waveformData = (SLuchar*) wavBuf->storageBase + wavBuf->dataChunk.dataOffset;
+    sl_advise_mapping(wavBuf->dataChunk.waveformData, wavBuf->dataChunk.dataChunkSize, advice);
+
+    // only touches the pages when the file's byte order isn't ours. they get copied on write so the file is left alone
+    ret = sl_ensure_wave_endianness(wavBuf);
+    if(ret != SL_SUCCESS) goto mapCleanup;
+
+    // nobody asked for compressed samples here. this unmaps the file once they are decoded
+    ret = sl_decompress_wave_file(wavBuf);
+    if(ret != SL_SUCCESS) goto mapCleanup;
+
+    SL_STATS_ADD(filesParsed, 1);
+    goto exit;
+
+    mapCleanup:
+        sl_unmap_wave_file(wavBuf);
+    exit:
+        return ret;
+}
+
+DLL_EXPORT void sl_unmap_wave_file(SL_WAV_FILE* wavBuf) {
+    if(wavBuf != NULL && wavBuf->storage == SL_STORAGE_MAPPED) {
+        if(wavBuf->storageBase != NULL) sl_unmap_file(wavBuf->storageBase, wavBuf->storageSize);
+
+        wavBuf->storageBase = NULL;
+        wavBuf->storageSize = 0;
+        wavBuf->storage = SL_STORAGE_OWNED;
+        wavBuf->dataChunk.waveformData = NULL;
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_advise_wave_file(SL_WAV_FILE* wavBuf, SL_MAP_ADVICE advice) {
+    if(wavBuf == NULL || wavBuf->storage != SL_STORAGE_MAPPED || wavBuf->dataChunk.waveformData == NULL)
+        return SL_INVALID_VALUE;
+
+    // dropping the pages would also drop the samples we flipped in place
+    if(advice == SL_MAP_ADVICE_DONTNEED && wavBuf->descriptorChunk.endianness != sl_get_native_endianness())
+        return SL_SUCCESS;
+
+    sl_advise_mapping(wavBuf->dataChunk.waveformData, wavBuf->dataChunk.dataChunkSize, advice);
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_descriptor(SL_IO* io, SL_WAV_FILE* wavBuf) {
+    const SLuchar riffID_bytes[4] = {0x52, 0x49, 0x46, 0x46};
+    const SLuchar rifxID_bytes[4] = {0x52, 0x49, 0x46, 0x58};
+    const SLuchar waveID_bytes[4] = {0x57, 0x41, 0x56, 0x45};
+    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
+    SLbool blocksRead;
+
+    //read and validate chunkID
+    blocksRead = io->read(io->user, wavBuf->descriptorChunk.descriptorId, 4) == 4;
+    if (!blocksRead)
+        return SL_INVALID_CHUNK_DESCRIPTOR_ID;
+
+    // RIFX is the same layout with every number big endian
+    if (memcmp(wavBuf->descriptorChunk.descriptorId, riffID_bytes, 4) == 0)
+        wavBuf->descriptorChunk.endianness = SL_LITTLE_ENDIAN;
+    else if (memcmp(wavBuf->descriptorChunk.descriptorId, rifxID_bytes, 4) == 0)
+        wavBuf->descriptorChunk.endianness = SL_BIG_ENDIAN;
+    else
+        return SL_INVALID_CHUNK_DESCRIPTOR_ID;
+
+    //read and validate chunk size
+    blocksRead = io->read(io->user, buffer4, 4) == 4;
+    wavBuf->descriptorChunk.descriptorChunkSize = sl_buf_to_native_uint_b(buffer4, 4, wavBuf->descriptorChunk.endianness);
+    if (!blocksRead || wavBuf->descriptorChunk.descriptorChunkSize == 0)
+        return SL_INVALID_CHUNK_DESCRIPTOR_SIZE;
+
+    //read and validate wave format
+    blocksRead = io->read(io->user, wavBuf->descriptorChunk.chunkFormat, 4) == 4;
+    if (!blocksRead || memcmp(wavBuf->descriptorChunk.chunkFormat, waveID_bytes, 4) != 0)
+        return SL_INVALID_CHUNK_DESCRIPTOR_FORMAT;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_wave_chunks(SL_IO* io, SL_WAV_FILE* wavBuf) {
+    return sl_parse_wave_chunks_b(io, wavBuf, 1);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_wave_chunks_b(SL_IO* io, SL_WAV_FILE* wavBuf, SLbool readData) {
+    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
+    const SLuchar fmtID_bytes [4] = {0x66, 0x6d, 0x74, 0x20};
+    const SLuchar dataID_bytes[4] = {0x64, 0x61, 0x74, 0x61};
+    SLbool blocksRead;
+    SLbool foundFmt = 0;
+    SLbool foundData = 0;
+
+    // Implement the logic for reading the wave descriptor here
+    blocksRead = io->read(io->user, buffer4, 4) == 4;
+
+    while(blocksRead) {
+        SLuint foundMatch = 0;
+
+        //FORMAT CHUNK
+        if(!foundFmt && memcmp(buffer4, fmtID_bytes, 4) == 0) {
+            foundMatch = 1;
+            foundFmt = 1;
+            //store format id
+            memcpy(wavBuf->formatChunk.fmtId, buffer4, 4);
+
+            SL_RETURN_CODE ret = sl_read_wave_format_chunk(io, wavBuf);
+            if(ret != SL_SUCCESS)
+                return ret;
+        }
+
+        // DATA CHUNK
+        else if(!foundData && memcmp(buffer4, dataID_bytes, 4) == 0) {
+            foundMatch = 1;
+            foundData = 1;
+
+            //store data id
+            memcpy(wavBuf->dataChunk.dataId, buffer4, 4);
+            if(readData) {
+                SL_RETURN_CODE ret = sl_read_wave_data_chunk(io, wavBuf);
+                if(ret != SL_SUCCESS) return ret;
+            } else {
+                SL_RETURN_CODE ret = sl_read_wave_data_chunk_size(io, wavBuf);
+                if(ret != SL_SUCCESS) return ret;
+
+                // skip the samples so a format chunk after the data chunk is still found
+                if(!(foundFmt && foundData))
+                    io->seek(io->user, wavBuf->dataChunk.dataChunkSize, SEEK_CUR);
+            }
+
+            // odd sized chunks are followed by a pad byte
+            if(!(foundFmt && foundData) && (wavBuf->dataChunk.dataChunkSize & 1))
+                io->seek(io->user, 1, SEEK_CUR);
+        }
+
+        if(foundFmt && foundData) break;
+
+        if(foundMatch) {
+            blocksRead = io->read(io->user, buffer4, 4) == 4;
+        } else {
+            SLuint size;
+            blocksRead = io->read(io->user, buffer4, 4) == 4;
+            if (!blocksRead)
+                return SL_INVALID_WAVE_FORMAT;
+
+            size = sl_buf_to_native_uint_b(buffer4, 4, wavBuf->descriptorChunk.endianness);
+            if (size == 0)
+                return SL_INVALID_WAVE_FORMAT;
+
+            // skip chunk and its pad byte and read next ID
+            io->seek(io->user, (SLllong) size + (size & 1), SEEK_CUR);
+            blocksRead = io->read(io->user, buffer4, 4) == 4;
+        }
+    }
+
+    if(!foundFmt)
+        return SL_CHUNK_FORMAT_NOT_FOUND;
+    else if(!foundData)
+        return SL_CHUNK_DATA_NOT_FOUND;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_format_chunk(SL_IO* io, SL_WAV_FILE* wavBuf) {
+    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
+    SLuchar buffer2[2] = {0x00, 0x00};
+    SLbool blocksRead;
+    SLuint fmtRead = 16;
+
+    //read and validate fmt chunk size
+    blocksRead = io->read(io->user, buffer4, 4) == 4;
+    wavBuf->formatChunk.fmtChunkSize = sl_buf_to_native_uint_b(buffer4, 4, wavBuf->descriptorChunk.endianness);
+    if (!blocksRead || wavBuf->formatChunk.fmtChunkSize < 16)
+        return SL_INVALID_CHUNK_FMT_SIZE;
+
+    //read only. audio format is verified later when parsing bits per sample
+    blocksRead = io->read(io->user, buffer2, 2) == 2;
+    if (!blocksRead)
+        return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+    wavBuf->formatChunk.audioFormat = sl_buf_to_native_ushort_b(buffer2, 2, wavBuf->descriptorChunk.endianness);
+
+    //read and validate num channels.
+    blocksRead = io->read(io->user, buffer2, 2) == 2;
+    wavBuf->formatChunk.numChannels = sl_buf_to_native_ushort_b(buffer2, 2, wavBuf->descriptorChunk.endianness);
+    if (!blocksRead || wavBuf->formatChunk.numChannels == 0)
+        return SL_INVALID_CHUNK_FMT_CHANNELS;
+
+
+    //read and validate sample rate
+    blocksRead = io->read(io->user, buffer4, 4) == 4;
+    wavBuf->formatChunk.sampleRate = sl_buf_to_native_uint_b(buffer4, 4, wavBuf->descriptorChunk.endianness);
+    if (!blocksRead || wavBuf->formatChunk.sampleRate == 0)
+        return SL_INVALID_CHUNK_FMT_SAMPLE_RATE;
+
+
+    //read and validate byte rate
+    blocksRead = io->read(io->user, buffer4, 4) == 4;
+    wavBuf->formatChunk.byteRate = sl_buf_to_native_uint_b(buffer4, 4, wavBuf->descriptorChunk.endianness);
+    if (!blocksRead || wavBuf->formatChunk.byteRate == 0)
+        return SL_INVALID_CHUNK_FMT_BYTE_RATE;
+
+    //read and validate block align
+    blocksRead = io->read(io->user, buffer2, 2) == 2;
+    wavBuf->formatChunk.blockAlign = sl_buf_to_native_ushort_b(buffer2, 2, wavBuf->descriptorChunk.endianness);
+    if (!blocksRead || wavBuf->formatChunk.blockAlign == 0)
+        return SL_INVALID_CHUNK_FMT_BLOCK_ALIGN;
+
+    //read and validate bits per sample
+    blocksRead = io->read(io->user, buffer2, 2) == 2;
+    if (!blocksRead)
+        return SL_INVALID_CHUNK_FMT_BITS_PER_SAMPLE;
+
+    wavBuf->formatChunk.bitsPerSample = sl_buf_to_native_ushort_b(buffer2, 2, wavBuf->descriptorChunk.endianness);
+
+    //the extension size is only there when the chunk is big enough for it
+    if (wavBuf->formatChunk.fmtChunkSize >= 18) {
+        blocksRead = io->read(io->user, buffer2, 2) == 2;
+        if (!blocksRead)
+            return SL_INVALID_CHUNK_FMT_SIZE;
+
+        wavBuf->formatChunk.extensionSize = sl_buf_to_native_ushort_b(buffer2, 2, wavBuf->descriptorChunk.endianness);
+        fmtRead = 18;
+    }
+
+    //IMA ADPCM says how many frames are in a block right after the extension size
+    if (wavBuf->formatChunk.audioFormat == 0x11 && wavBuf->formatChunk.extensionSize >= 2 && wavBuf->formatChunk.fmtChunkSize >= 20) {
+        blocksRead = io->read(io->user, buffer2, 2) == 2;
+        if (!blocksRead)
+            return SL_INVALID_CHUNK_FMT_SIZE;
+
+        wavBuf->formatChunk.samplesPerBlock = sl_buf_to_native_ushort_b(buffer2, 2, wavBuf->descriptorChunk.endianness);
+        fmtRead = 20;
+    }
+
+    //skip anything else in the chunk so the next chunk id lines up
+    if (wavBuf->formatChunk.fmtChunkSize + (wavBuf->formatChunk.fmtChunkSize & 1) > fmtRead)
+        io->seek(io->user, (SLllong) wavBuf->formatChunk.fmtChunkSize + (wavBuf->formatChunk.fmtChunkSize & 1) - fmtRead, SEEK_CUR);
+
+    if(wavBuf->formatChunk.audioFormat == 1) {
+        switch (wavBuf->formatChunk.bitsPerSample) {
+            case 8: {
+                wavBuf->dataChunk.pcmType = SL_UNSIGNED_8PCM;
+                break;
+            }
+            case 16: {
+                wavBuf->dataChunk.pcmType = SL_SIGNED_16PCM;
+                break;
+            }
+            case 24: {
+                wavBuf->dataChunk.pcmType = SL_SIGNED_24PCM;
+                break;
+            }
+            case 32: {
+                wavBuf->dataChunk.pcmType = SL_SIGNED_32PCM;
+                break;
+            }
+            default: break;
+        }
+    } else if (wavBuf->formatChunk.audioFormat == 3) {
+        switch (wavBuf->formatChunk.bitsPerSample) {
+            case 32: {
+                wavBuf->dataChunk.pcmType = SL_FLOAT_32PCM;
+                break;
+            }
+            case 64: {
+                wavBuf->dataChunk.pcmType = SL_FLOAT_64PCM;
+                break;
+            }
+            default: break;
+        }
+    } else if (wavBuf->formatChunk.audioFormat == 0x11) {
+        SLuint channels = wavBuf->formatChunk.numChannels;
+        SLuint maxFrames;
+
+        if (wavBuf->formatChunk.bitsPerSample != 4)
+            return SL_INVALID_CHUNK_FMT_BITS_PER_SAMPLE;
+        if (channels > SL_ADPCM_MAX_CHANNELS)
+            return SL_INVALID_CHUNK_FMT_CHANNELS;
+
+        //a block is a 4 byte header per channel and then 4 bytes of each channel in turn
+        if (wavBuf->formatChunk.blockAlign <= 4 * channels || wavBuf->formatChunk.blockAlign % (4 * channels) != 0)
+            return SL_INVALID_CHUNK_FMT_BLOCK_ALIGN;
+
+        //the header has one sample and every other byte has two
+        maxFrames = (wavBuf->formatChunk.blockAlign - 4 * channels) * 2 / channels + 1;
+        if (wavBuf->formatChunk.samplesPerBlock == 0) wavBuf->formatChunk.samplesPerBlock = (SLushort) maxFrames;
+        if (wavBuf->formatChunk.samplesPerBlock > maxFrames)
+            return SL_INVALID_CHUNK_FMT_BLOCK_ALIGN;
+
+        wavBuf->dataChunk.pcmType = SL_IMA_ADPCM;
+    } else {
+        return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+    }
+
+    if (wavBuf->dataChunk.pcmType == 0)
+        return SL_INVALID_CHUNK_FMT_BITS_PER_SAMPLE;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_data_chunk(SL_IO* io, SL_WAV_FILE* wavBuf) {
+    SLbool blocksRead;
+    SL_RETURN_CODE ret = sl_read_wave_data_chunk_size(io, wavBuf);
+    if (ret != SL_SUCCESS)
+        return ret;
+
+    wavBuf->dataChunk.waveformData = sl_aligned_malloc(wavBuf->dataChunk.dataChunkSize);
+    if (wavBuf->dataChunk.waveformData == NULL)
+        return SL_MALLOC_FAIL;
+
+    // Ensure the buffer size is even
+    SL_STATS_TIME(dataReadTime, blocksRead = io->read(io->user, wavBuf->dataChunk.waveformData, wavBuf->dataChunk.dataChunkSize) == wavBuf->dataChunk.dataChunkSize);
+    if (!blocksRead)
+        return SL_INVALID_CHUNK_DATA_DATA;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_read_wave_data_chunk_size(SL_IO* io, SL_WAV_FILE* wavBuf) {
+    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
+    SLbool blocksRead;
+    SLllong offset;
+
+    //read data chunk size
+    blocksRead = io->read(io->user, buffer4, 4) == 4;
+    wavBuf->dataChunk.dataChunkSize = sl_buf_to_native_uint_b(buffer4, 4, wavBuf->descriptorChunk.endianness);
+    if (!blocksRead || wavBuf->dataChunk.dataChunkSize == 0)
+        return SL_INVALID_CHUNK_DATA_SIZE;
+
+    //the samples start right after the size
+    offset = io->tell(io->user);
+    if (offset < 0)
+        return SL_FILE_ERROR;
+    wavBuf->dataChunk.dataOffset = (SLullong) offset;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_validate_wave_data(SL_WAV_FILE* wavBuf) {
+    switch (wavBuf->dataChunk.pcmType) {
+        case SL_UNSIGNED_8PCM:
+        case SL_SIGNED_16PCM:
+        case SL_SIGNED_32PCM:
+        case SL_FLOAT_32PCM:
+        case SL_FLOAT_64PCM:
+            if (wavBuf->dataChunk.dataChunkSize % 2 != 0) return SL_INVALID_CHUNK_DATA_DATA;
+            break;
+        case SL_SIGNED_24PCM:
+            if (wavBuf->dataChunk.dataChunkSize % 3 != 0) return SL_INVALID_CHUNK_DATA_DATA;
+            break;
+        case SL_IMA_ADPCM:
+            // the last block can be cut short but it needs its header
+            if (wavBuf->dataChunk.dataChunkSize % wavBuf->formatChunk.blockAlign < 4U * wavBuf->formatChunk.numChannels &&
+                wavBuf->dataChunk.dataChunkSize % wavBuf->formatChunk.blockAlign != 0) return SL_INVALID_CHUNK_DATA_DATA;
+            break;
+        default:
+            return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+    }
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_ensure_wave_endianness(SL_WAV_FILE* wavBuf) {
+    return sl_ensure_endianness(wavBuf->dataChunk.waveformData, wavBuf->dataChunk.dataChunkSize, wavBuf->dataChunk.pcmType, wavBuf->descriptorChunk.endianness);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_ensure_endianness(SLvoid waveformData, SLullong size, SLuint pcmType, SLuint endianness) {
+    // ADPCM blocks are made of bytes and nibbles. there's nothing to flip
+    if (pcmType == SL_IMA_ADPCM) return SL_SUCCESS;
+
+    SLuint sampleSize = sl_pcm_type_size(pcmType);
+    if (sampleSize == 0) return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+
+    if (endianness != sl_get_native_endianness() && sampleSize > 1)
+        SL_STATS_TIME(endiannessTime, sl_get_convert_kernels()->swap(waveformData, size / sampleSize, sampleSize));
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_open_wave_stream(SLstr path, SL_WAV_STREAM* stream) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    memset(stream, 0, sizeof(SL_WAV_STREAM));
+
+    SL_HANDLE_IO* handle;
+    SL_IO io;
+
+    if (path == NULL) {
+        ret = SL_INVALID_VALUE;
+        goto exit;
+    }
+
+    if(sl_is_wave_file(path) == SL_FAIL) {
+        ret = SL_FILE_ERROR;
+        goto exit;
+    }
+
+    // same reader as the rest of the parsers, so the blocks go straight into the caller's memory instead of through stdio.
+    // it is on the heap because stream->io points at it and the stream can be moved
+    handle = (SL_HANDLE_IO*) sl_malloc(sizeof(SL_HANDLE_IO));
+    if (handle == NULL) {
+        ret = SL_MALLOC_FAIL;
+        goto exit;
+    }
+
+    ret = sl_open_handle_io(handle, path);
+    if (ret != SL_SUCCESS) goto handleCleanup;
+
+    sl_io_from_handle(&io, handle);
+    ret = sl_open_wave_stream_io(&io, stream);
+    if(ret != SL_SUCCESS) goto fileCleanup;
+
+    stream->handle = handle;
+    goto exit;
+
+    fileCleanup:
+        sl_close_handle_io(handle);
+    handleCleanup:
+        sl_free(handle);
+    exit:
+        return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_open_wave_stream_io(SL_IO* io, SL_WAV_STREAM* stream) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    memset(stream, 0, sizeof(SL_WAV_STREAM));
+
+    if (io == NULL || io->read == NULL || io->seek == NULL || io->tell == NULL)
+        return SL_INVALID_VALUE;
+
+    ret = sl_read_wave_descriptor(io, &stream->header);
+    if(ret != SL_SUCCESS) return ret;
+
+    ret = sl_parse_wave_chunks_b(io, &stream->header, 0);
+    if(ret != SL_SUCCESS) return ret;
+
+    ret = sl_validate_wave_data(&stream->header);
+    if(ret != SL_SUCCESS) return ret;
+
+    // a stream hands out whole frames as they are in the file, compressed blocks don't split into those
+    if (stream->header.dataChunk.pcmType == SL_IMA_ADPCM) return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+
+    // the chunk parser may have gone past the samples looking for the format chunk
+    if (io->seek(io->user, (SLllong) stream->header.dataChunk.dataOffset, SEEK_SET) != 0)
+        return SL_FILE_ERROR;
+
+    stream->io = *io;
+    stream->frameCount = stream->header.dataChunk.dataChunkSize / stream->header.formatChunk.blockAlign;
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SLullong sl_read_wave_stream(SL_WAV_STREAM* stream, SLvoid dst, SLullong frameCount) {
+    if (stream == NULL || stream->io.read == NULL || dst == NULL) return 0;
+
+    SLullong blockAlign = stream->header.formatChunk.blockAlign;
+    SLullong framesLeft = stream->frameCount - stream->framePos;
+    if (frameCount > framesLeft) frameCount = framesLeft;
+    if (frameCount == 0) return 0;
+
+    // a SL_IO can give less than asked for without being at the end, so keep going until it has nothing left
+    SLullong wanted = frameCount * blockAlign;
+    SLullong bytesRead = 0;
+    while (bytesRead < wanted) {
+        SLullong n = stream->io.read(stream->io.user, (SLuchar*) dst + bytesRead, wanted - bytesRead);
+        if (n == 0) break;
+        bytesRead += n;
+    }
+
+    // only whole frames are given back. if the data ended inside a frame, go back to its start so the position still matches framePos
+    SLullong framesRead = bytesRead / blockAlign;
+    if (bytesRead % blockAlign != 0)
+        stream->io.seek(stream->io.user, (SLllong) (stream->header.dataChunk.dataOffset + (stream->framePos + framesRead) * blockAlign), SEEK_SET);
+    if (framesRead == 0) return 0;
+
+    // fix each block as it comes in instead of the whole file at the end
+    if (sl_ensure_endianness(dst, framesRead * blockAlign, stream->header.dataChunk.pcmType, stream->header.descriptorChunk.endianness) != SL_SUCCESS) return 0;
+
+    stream->framePos += framesRead;
+    return framesRead;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_seek_wave_stream(SL_WAV_STREAM* stream, SLullong frame) {
+    if (stream == NULL || stream->io.seek == NULL || frame > stream->frameCount) return SL_INVALID_VALUE;
+
+    // frames are all blockAlign bytes, so where one starts is plain math
+    if (stream->io.seek(stream->io.user, (SLllong) (stream->header.dataChunk.dataOffset + frame * stream->header.formatChunk.blockAlign), SEEK_SET) != 0)
+        return SL_FILE_ERROR;
+
+    stream->framePos = frame;
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_close_wave_stream(SL_WAV_STREAM* stream) {
+    if(stream != NULL) {
+        if(stream->handle != NULL) {
+            sl_close_handle_io(stream->handle);
+            sl_free(stream->handle);
+        }
+        stream->handle = NULL;
+        memset(&stream->io, 0, sizeof(SL_IO));
+        stream->framePos = 0;
+        stream->frameCount = 0;
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_write_wave_file(SLstr path, const SL_WAV_FILE* wavBuf) {
+    return sl_write_wave_file_b(path, wavBuf, SL_WRITE_DEFAULT);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_write_wave_file_b(SLstr path, const SL_WAV_FILE* wavBuf, SLuint flags) {
+    SL_WAV_WRITER writer;
+    SL_RETURN_CODE ret;
+    SLuint sampleSize;
+
+    if (wavBuf == NULL || wavBuf->dataChunk.waveformData == NULL) return SL_INVALID_VALUE;
+
+    sampleSize = sl_pcm_type_size(wavBuf->dataChunk.pcmType);
+    if (sampleSize == 0 || wavBuf->formatChunk.numChannels == 0) return SL_INVALID_VALUE;
+
+    ret = sl_open_wave_writer(&writer, path, wavBuf->dataChunk.pcmType, wavBuf->formatChunk.numChannels, wavBuf->formatChunk.sampleRate, flags);
+    if (ret != SL_SUCCESS) return ret;
+
+    ret = sl_write_wave_frames(&writer, wavBuf->dataChunk.waveformData, wavBuf->dataChunk.dataChunkSize / (sampleSize * wavBuf->formatChunk.numChannels));
+    if (ret != SL_SUCCESS) {
+        sl_close_wave_writer(&writer);
+        return ret;
+    }
+
+    return sl_close_wave_writer(&writer);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_open_wave_writer(SL_WAV_WRITER* writer, SLstr path, SLuint pcmType, SLushort numChannels, SLuint sampleRate, SLuint flags) {
+    SLuint sampleSize = sl_pcm_type_size(pcmType);
+
+    if (writer == NULL) return SL_INVALID_VALUE;
+    memset(writer, 0, sizeof(SL_WAV_WRITER));
+
+    if (path == NULL || sampleSize == 0 || numChannels == 0 || sampleRate == 0) return SL_INVALID_VALUE;
+
+    writer->pcmType = pcmType;
+    writer->numChannels = numChannels;
+    writer->sampleRate = sampleRate;
+    writer->blockAlign = sampleSize * numChannels;
+
+    // one buffer and the copy of the first block share an allocation, with room to line the buffer up
+    writer->bufferBase = sl_malloc(SL_WAV_WRITER_BUFFER_SIZE + 2 * SL_WAV_WRITER_ALIGN);
+    if (writer->bufferBase == NULL) return SL_MALLOC_FAIL;
+
+    writer->buffer = (SLuchar*) (((uintptr_t) writer->bufferBase + SL_WAV_WRITER_ALIGN - 1) & ~(uintptr_t) (SL_WAV_WRITER_ALIGN - 1));
+    writer->head = writer->buffer + SL_WAV_WRITER_BUFFER_SIZE;
+
+    #ifdef _WIN32
+        writer->direct = (flags & SL_WRITE_DIRECT) != 0;
+        writer->file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | (writer->direct ? FILE_FLAG_NO_BUFFERING : 0), NULL);
+        if (writer->file == INVALID_HANDLE_VALUE && writer->direct) {
+            writer->direct = 0;
+            writer->file = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        }
+        if (writer->file == INVALID_HANDLE_VALUE) goto bufferCleanup;
+    #elif defined(__linux__) || defined(__APPLE__)
+        // only used when there is O_DIRECT or F_NOCACHE
+        (void) flags;
+        writer->file = -1;
+
+        #ifdef O_DIRECT
+            if (flags & SL_WRITE_DIRECT) {
+                // tmpfs and some others say no to O_DIRECT. those just get normal writes
+                writer->file = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+                writer->direct = writer->file >= 0;
+            }
+        #endif // O_DIRECT
+
+        if (writer->file < 0) writer->file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (writer->file < 0) goto bufferCleanup;
+
+        #if !defined(O_DIRECT) && defined(F_NOCACHE)
+            // F_NOCACHE has no alignment rules so the writer doesn't need to know about it
+            if (flags & SL_WRITE_DIRECT) fcntl(writer->file, F_NOCACHE, 1);
+        #endif // F_NOCACHE
+    #else
+        goto bufferCleanup;
+    #endif // _WIN32
+
+    // the header goes in first with empty sizes. sl_close_wave_writer fixes them
+    sl_build_wave_header(writer, writer->buffer);
+    writer->bufferUsed = SL_WAV_HEADER_SIZE;
+
+    return SL_SUCCESS;
+
+    bufferCleanup:
+        sl_free(writer->bufferBase);
+        writer->bufferBase = NULL;
+        return SL_FILE_ERROR;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_write_wave_frames(SL_WAV_WRITER* writer, const void* frames, SLullong frameCount) {
+    const SLuchar* in = (const SLuchar*) frames;
+    SLuint sampleSize;
+    SLullong size;
+
+    if (writer == NULL || writer->buffer == NULL || (frames == NULL && frameCount != 0)) return SL_INVALID_VALUE;
+
+    size = frameCount * writer->blockAlign;
+
+    // the sizes in the header are 32 bits. leave room for the pad byte
+    if (writer->dataSize + size + (SL_WAV_HEADER_SIZE - 8) + 1 > 0xFFFFFFFFULL) return SL_INVALID_CHUNK_DATA_SIZE;
+
+    writer->dataSize += size;
+    sampleSize = sl_pcm_type_size(writer->pcmType);
+
+    if (sl_get_native_endianness() != SL_LITTLE_ENDIAN && sampleSize > 1) {
+        // the caller's samples are left alone, so they get flipped a small piece at a time on the way in
+        SLuchar temp[SL_WAV_WRITER_ALIGN];
+        SLullong step = sizeof(temp) - sizeof(temp) % sampleSize;
+
+        while (size > 0) {
+            SLullong chunk = size < step ? size : step;
+
+            memcpy(temp, in, chunk);
+            sl_get_convert_kernels()->swap(temp, chunk / sampleSize, sampleSize);
+            if (sl_append_wave_writer(writer, temp, chunk) != SL_SUCCESS) return SL_FILE_ERROR;
+
+            in += chunk;
+            size -= chunk;
+        }
+
+        return SL_SUCCESS;
+    }
+
+    return sl_append_wave_writer(writer, in, size);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_close_wave_writer(SL_WAV_WRITER* writer) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    SLuchar header[SL_WAV_HEADER_SIZE];
+    SLbool headerInBuffer;
+    SLullong fileSize;
+    SLullong tail;
+
+    if (writer == NULL || writer->buffer == NULL) return SL_INVALID_VALUE;
+
+    // chunks have to be an even number of bytes. the pad byte is not counted in the data chunk size
+    if (writer->dataSize & 1) {
+        const SLuchar pad = 0;
+        ret = sl_append_wave_writer(writer, &pad, 1);
+    }
+
+    fileSize = writer->fileOffset + writer->bufferUsed;
+    sl_build_wave_header(writer, header);
+
+    // small files never left the buffer so the header can be fixed before it is written
+    headerInBuffer = writer->fileOffset == 0;
+    if (headerInBuffer) memcpy(writer->buffer, header, SL_WAV_HEADER_SIZE);
+
+    tail = writer->bufferUsed;
+    if (writer->direct) {
+        // direct writes have to be whole blocks. pad with zeros and cut the file back to size afterwards
+        SLullong padded = (tail + SL_WAV_WRITER_ALIGN - 1) & ~(SLullong) (SL_WAV_WRITER_ALIGN - 1);
+        memset(writer->buffer + tail, 0, padded - tail);
+        tail = padded;
+    }
+
+    if (ret == SL_SUCCESS && tail > 0) ret = sl_flush_wave_writer(writer, tail);
+
+    if (ret == SL_SUCCESS && !headerInBuffer) {
+        if (writer->direct) {
+            // only whole blocks can be written, so patch the copy of the first one we kept
+            memcpy(writer->head, header, SL_WAV_HEADER_SIZE);
+            ret = sl_write_file_at(writer, writer->head, SL_WAV_WRITER_ALIGN, 0);
+        } else {
+            ret = sl_write_file_at(writer, header, SL_WAV_HEADER_SIZE, 0);
+        }
+    }
+
+    #ifdef _WIN32
+        if (ret == SL_SUCCESS && writer->direct) {
+            LARGE_INTEGER size;
+            size.QuadPart = (LONGLONG) fileSize;
+            if (!SetFilePointerEx(writer->file, size, NULL, FILE_BEGIN) || !SetEndOfFile(writer->file)) ret = SL_FILE_ERROR;
+        }
+
+        CloseHandle(writer->file);
+        writer->file = INVALID_HANDLE_VALUE;
+    #elif defined(__linux__) || defined(__APPLE__)
+        if (ret == SL_SUCCESS && writer->direct && ftruncate(writer->file, (off_t) fileSize) != 0) ret = SL_FILE_ERROR;
+
+        if (close(writer->file) != 0 && ret == SL_SUCCESS) ret = SL_FILE_ERROR;
+        writer->file = -1;
+    #endif // _WIN32
+
+    sl_free(writer->bufferBase);
+    writer->bufferBase = NULL;
+    writer->buffer = NULL;
+    writer->head = NULL;
+    writer->bufferUsed = 0;
+
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_append_wave_writer(SL_WAV_WRITER* writer, const void* data, SLullong size) {
+    const SLuchar* in = (const SLuchar*) data;
+
+    while (size > 0) {
+        SLullong room = SL_WAV_WRITER_BUFFER_SIZE - writer->bufferUsed;
+
+        // whole buffers skip the copy when the buffer is empty. direct writes need our aligned buffer so they always copy
+        if (writer->bufferUsed == 0 && !writer->direct && size >= SL_WAV_WRITER_BUFFER_SIZE) {
+            SLullong chunk = size - size % SL_WAV_WRITER_BUFFER_SIZE;
+
+            if (sl_write_file_at(writer, in, chunk, writer->fileOffset) != SL_SUCCESS) return SL_FILE_ERROR;
+
+            writer->fileOffset += chunk;
+            in += chunk;
+            size -= chunk;
+            continue;
+        }
+
+        if (room > size) room = size;
+        memcpy(writer->buffer + writer->bufferUsed, in, room);
+
+        writer->bufferUsed += room;
+        in += room;
+        size -= room;
+
+        if (writer->bufferUsed == SL_WAV_WRITER_BUFFER_SIZE && sl_flush_wave_writer(writer, SL_WAV_WRITER_BUFFER_SIZE) != SL_SUCCESS)
+            return SL_FILE_ERROR;
+    }
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_flush_wave_writer(SL_WAV_WRITER* writer, SLullong size) {
+    // keep the block with the header in it. direct writers can't write less than a block to fix the sizes later
+    if (writer->fileOffset == 0 && writer->direct && size >= SL_WAV_WRITER_ALIGN)
+        memcpy(writer->head, writer->buffer, SL_WAV_WRITER_ALIGN);
+
+    if (sl_write_file_at(writer, writer->buffer, size, writer->fileOffset) != SL_SUCCESS) return SL_FILE_ERROR;
+
+    writer->fileOffset += size;
+    writer->bufferUsed = 0;
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_write_file_at(SL_WAV_WRITER* writer, const void* data, SLullong size, SLullong offset) {
+    const SLuchar* p = (const SLuchar*) data;
+
+    while (size > 0) {
+        #ifdef _WIN32
+            // WriteFile takes a DWORD so go a GB at a time. that keeps direct writes aligned too
+            DWORD chunk = size > 0x40000000 ? 0x40000000 : (DWORD) size;
+            DWORD written = 0;
+            OVERLAPPED at;
+
+            memset(&at, 0, sizeof(OVERLAPPED));
+            at.Offset = (DWORD) offset;
+            at.OffsetHigh = (DWORD) (offset >> 32);
+
+            if (!WriteFile(writer->file, p, chunk, &written, &at) || written == 0) return SL_FILE_ERROR;
+        #elif defined(__linux__) || defined(__APPLE__)
+            ssize_t written = pwrite(writer->file, p, (size_t) size, (off_t) offset);
+
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return SL_FILE_ERROR;
+        #else
+            return SL_FILE_ERROR;
+        #endif // _WIN32
+
+        p += written;
+        size -= (SLullong) written;
+        offset += (SLullong) written;
+    }
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_build_wave_header(const SL_WAV_WRITER* writer, SLuchar* header) {
+    SLuint sampleSize = sl_pcm_type_size(writer->pcmType);
+    SLbool isFloat = writer->pcmType == SL_FLOAT_32PCM || writer->pcmType == SL_FLOAT_64PCM;
+
+    memcpy(header, "RIFF", 4);
+    sl_native_to_buf_uint(header + 4, (SLuint) (SL_WAV_HEADER_SIZE - 8 + writer->dataSize + (writer->dataSize & 1)));
+    memcpy(header + 8, "WAVE", 4);
+
+    memcpy(header + 12, "fmt ", 4);
+    sl_native_to_buf_uint(header + 16, 16);
+    sl_native_to_buf_ushort(header + 20, isFloat ? 3 : 1);
+    sl_native_to_buf_ushort(header + 22, writer->numChannels);
+    sl_native_to_buf_uint(header + 24, writer->sampleRate);
+    sl_native_to_buf_uint(header + 28, writer->sampleRate * writer->blockAlign);
+    sl_native_to_buf_ushort(header + 32, (SLushort) writer->blockAlign);
+    sl_native_to_buf_ushort(header + 34, (SLushort) (sampleSize * 8));
+
+    memcpy(header + 36, "data", 4);
+    sl_native_to_buf_uint(header + 40, (SLuint) writer->dataSize);
+}
+
+DLL_EXPORT void sl_native_to_buf_uint(SLuchar* buf, SLuint value) {
+    buf[0] = (SLuchar) value;
+    buf[1] = (SLuchar) (value >> 8);
+    buf[2] = (SLuchar) (value >> 16);
+    buf[3] = (SLuchar) (value >> 24);
+}
+
+DLL_EXPORT void sl_native_to_buf_ushort(SLuchar* buf, SLushort value) {
+    buf[0] = (SLuchar) value;
+    buf[1] = (SLuchar) (value >> 8);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_create_wav_cache(SL_WAV_CACHE* cache, SLullong budget) {
+    memset(cache, 0, sizeof(SL_WAV_CACHE));
+
+    cache->buckets = (SL_WAV_CACHE_ENTRY**) sl_calloc(SL_WAV_CACHE_INITIAL_BUCKETS, sizeof(SL_WAV_CACHE_ENTRY*));
+    if (cache->buckets == NULL) return SL_MALLOC_FAIL;
+
+    cache->bucketCount = SL_WAV_CACHE_INITIAL_BUCKETS;
+    cache->budget = budget;
+    sl_mutex_init(&cache->mutex);
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_destroy_wav_cache(SL_WAV_CACHE* cache) {
+    if(cache == NULL || cache->buckets == NULL) return;
+
+    SL_WAV_CACHE_ENTRY* entry = cache->lruHead;
+    while (entry != NULL) {
+        SL_WAV_CACHE_ENTRY* next = entry->lruNext;
+        sl_cleanup_wave_file(&entry->file);
+        sl_free(entry->key);
+        sl_free(entry);
+        entry = next;
+    }
+
+    sl_free(cache->buckets);
+    sl_mutex_destroy(&cache->mutex);
+    memset(cache, 0, sizeof(SL_WAV_CACHE));
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_cache_acquire(SL_WAV_CACHE* cache, SLstr path, SL_WAV_FILE** wavBuf) {
+    SL_WAV_CACHE_ENTRY* entry;
+    SL_WAV_CACHE_ENTRY* loaded;
+    SL_RETURN_CODE ret;
+    SLullong hash;
+
+    if(cache == NULL || path == NULL || wavBuf == NULL) return SL_INVALID_VALUE;
+    *wavBuf = NULL;
+
+    hash = sl_hash_string(path);
+
+    sl_mutex_lock(&cache->mutex);
+    for (entry = cache->buckets[hash & (cache->bucketCount - 1)]; entry != NULL; entry = entry->hashNext)
+        if (entry->hash == hash && strcmp(entry->key, path) == 0) break;
+
+    if (entry != NULL) {
+        cache->hits++;
+        goto found;
+    }
+
+    cache->misses++;
+    sl_mutex_unlock(&cache->mutex);
+
+    // load without the lock so other lookups don't wait on the disk
+    loaded = (SL_WAV_CACHE_ENTRY*) sl_calloc(1, sizeof(SL_WAV_CACHE_ENTRY));
+    if (loaded == NULL) return SL_MALLOC_FAIL;
+
+    loaded->key = (char*) sl_malloc(strlen(path) + 1);
+    if (loaded->key == NULL) {
+        sl_free(loaded);
+        return SL_MALLOC_FAIL;
+    }
+    strcpy(loaded->key, path);
+
+    ret = sl_read_wave_file(path, &loaded->file);
+    if (ret != SL_SUCCESS) {
+        sl_free(loaded->key);
+        sl_free(loaded);
+        return ret;
+    }
+
+    loaded->hash = hash;
+    loaded->size = sizeof(SL_WAV_CACHE_ENTRY) + strlen(path) + 1 + loaded->file.dataChunk.dataChunkSize;
+
+    sl_mutex_lock(&cache->mutex);
+
+    // someone else may have loaded the same file while we were reading it. theirs wins
+    for (entry = cache->buckets[hash & (cache->bucketCount - 1)]; entry != NULL; entry = entry->hashNext)
+        if (entry->hash == hash && strcmp(entry->key, path) == 0) break;
+
+    if (entry != NULL) {
+        sl_cleanup_wave_file(&loaded->file);
+        sl_free(loaded->key);
+        sl_free(loaded);
+        goto found;
+    }
+
+    // keep chains short by doubling the table once it is full
+    if (cache->entryCount >= cache->bucketCount) {
+        SLuint newCount = cache->bucketCount * 2;
+        SL_WAV_CACHE_ENTRY** newBuckets = (SL_WAV_CACHE_ENTRY**) sl_calloc(newCount, sizeof(SL_WAV_CACHE_ENTRY*));
+
+        // a full table still works, just slower, so only grow if we can
+        if (newBuckets != NULL) {
+            for (SLuint i = 0; i < cache->bucketCount; i++) {
+                SL_WAV_CACHE_ENTRY* chain = cache->buckets[i];
+                while (chain != NULL) {
+                    SL_WAV_CACHE_ENTRY* next = chain->hashNext;
+                    chain->hashNext = newBuckets[chain->hash & (newCount - 1)];
+                    newBuckets[chain->hash & (newCount - 1)] = chain;
+                    chain = next;
+                }
+            }
+
+            sl_free(cache->buckets);
+            cache->buckets = newBuckets;
+            cache->bucketCount = newCount;
+        }
+    }
+
+    entry = loaded;
+    entry->hashNext = cache->buckets[hash & (cache->bucketCount - 1)];
+    cache->buckets[hash & (cache->bucketCount - 1)] = entry;
+    cache->entryCount++;
+    cache->bytes += entry->size;
+
+    // start at the tail so the move to the front below works the same for new and old entries
+    entry->lruPrev = cache->lruTail;
+    entry->lruNext = NULL;
+    if (cache->lruTail != NULL) cache->lruTail->lruNext = entry;
+    else cache->lruHead = entry;
+    cache->lruTail = entry;
+
+    found:
+        entry->refCount++;
+
+        // move to the front of the LRU list
+        if (cache->lruHead != entry) {
+            entry->lruPrev->lruNext = entry->lruNext;
+            if (entry->lruNext != NULL) entry->lruNext->lruPrev = entry->lruPrev;
+            else cache->lruTail = entry->lruPrev;
+
+            entry->lruPrev = NULL;
+            entry->lruNext = cache->lruHead;
+            cache->lruHead->lruPrev = entry;
+            cache->lruHead = entry;
+        }
+
+        sl_cache_trim(cache);
+        sl_mutex_unlock(&cache->mutex);
+
+        *wavBuf = &entry->file;
+        return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_cache_release(SL_WAV_CACHE* cache, SL_WAV_FILE* wavBuf) {
+    if(cache == NULL || wavBuf == NULL) return;
+
+    SL_WAV_CACHE_ENTRY* entry = (SL_WAV_CACHE_ENTRY*) wavBuf;
+
+    sl_mutex_lock(&cache->mutex);
+    if (entry->refCount > 0) entry->refCount--;
+    sl_cache_trim(cache);
+    sl_mutex_unlock(&cache->mutex);
+}
+
+DLL_EXPORT void sl_get_wav_cache_stats(SL_WAV_CACHE* cache, SL_WAV_CACHE_STATS* stats) {
+    sl_mutex_lock(&cache->mutex);
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->evictions = cache->evictions;
+    stats->bytes = cache->bytes;
+    stats->budget = cache->budget;
+    stats->entryCount = cache->entryCount;
+    sl_mutex_unlock(&cache->mutex);
+}
+
+DLL_EXPORT void sl_cache_trim(SL_WAV_CACHE* cache) {
+    SL_WAV_CACHE_ENTRY* entry = cache->lruTail;
+
+    while (cache->bytes > cache->budget && entry != NULL) {
+        SL_WAV_CACHE_ENTRY* prev = entry->lruPrev;
+
+        // files in use stay no matter what
+        if (entry->refCount == 0) {
+            SL_WAV_CACHE_ENTRY** link = &cache->buckets[entry->hash & (cache->bucketCount - 1)];
+            while (*link != entry) link = &(*link)->hashNext;
+            *link = entry->hashNext;
+
+            if (entry->lruPrev != NULL) entry->lruPrev->lruNext = entry->lruNext;
+            else cache->lruHead = entry->lruNext;
+            if (entry->lruNext != NULL) entry->lruNext->lruPrev = entry->lruPrev;
+            else cache->lruTail = entry->lruPrev;
+
+            cache->bytes -= entry->size;
+            cache->entryCount--;
+            cache->evictions++;
+
+            sl_cleanup_wave_file(&entry->file);
+            sl_free(entry->key);
+            sl_free(entry);
+        }
+
+        entry = prev;
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_build_catalog(SLstr directory, SLstr indexPath, SL_CATALOG_SCAN_STATS* stats) {
+    SL_CATALOG_BUILDER builder;
+    SL_RETURN_CODE ret;
+    SLullong length;
+
+    if (stats != NULL) memset(stats, 0, sizeof(SL_CATALOG_SCAN_STATS));
+    if (directory == NULL || indexPath == NULL || directory[0] == '\0') return SL_INVALID_VALUE;
+
+    length = strlen(directory);
+    while (length > 1 && (directory[length - 1] == '/' || directory[length - 1] == '\\')) length--;
+    if (length + 2 >= SL_CATALOG_MAX_PATH) return SL_INVALID_VALUE;
+
+    memset(&builder, 0, sizeof(SL_CATALOG_BUILDER));
+    memcpy(builder.path, directory, length);
+    if (builder.path[length - 1] != '/' && builder.path[length - 1] != '\\') builder.path[length++] = '/';
+    builder.rootLength = length;
+
+    // no catalog yet or one that doesn't open just means every file gets parsed
+    if (sl_open_catalog(&builder.old, indexPath) != SL_SUCCESS)
+        memset(&builder.old, 0, sizeof(SL_CATALOG));
+
+    ret = sl_catalog_walk(&builder, length);
+
+    // closed before writing, windows won't replace a file that is still mapped
+    sl_close_catalog(&builder.old);
+
+    if (ret == SL_SUCCESS) ret = sl_catalog_write(&builder, indexPath);
+
+    if (stats != NULL) {
+        *stats = builder.stats;
+        stats->fileCount = builder.entryCount;
+    }
+
+    sl_free(builder.entries);
+    sl_free(builder.names);
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_open_catalog(SL_CATALOG* catalog, SLstr indexPath) {
+    const SL_CATALOG_HEADER* header;
+    SL_RETURN_CODE ret;
+    SLullong tableSize;
+
+    memset(catalog, 0, sizeof(SL_CATALOG));
+    if (indexPath == NULL) return SL_INVALID_VALUE;
+
+    ret = sl_map_file(indexPath, &catalog->base, &catalog->size);
+    if (ret != SL_SUCCESS) return ret;
+
+    // only the header is checked so opening doesn't read the whole file. lookups check the rest as they go
+    header = (const SL_CATALOG_HEADER*) catalog->base;
+    if (catalog->size < sizeof(SL_CATALOG_HEADER) || memcmp(header->magic, SL_CATALOG_MAGIC, 8) != 0 ||
+        header->version != SL_CATALOG_VERSION || header->endianness != (SLuint) sl_get_native_endianness())
+        goto invalid;
+
+    if (header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0 || header->entryCount >= header->bucketCount)
+        goto invalid;
+
+    if (header->bucketCount > catalog->size / sizeof(SLuint) || header->namesSize > catalog->size)
+        goto invalid;
+
+    tableSize = sizeof(SL_CATALOG_HEADER) + header->entryCount * sizeof(SL_CATALOG_ENTRY) + header->bucketCount * sizeof(SLuint);
+    if (tableSize > catalog->size || tableSize + header->namesSize != catalog->size)
+        goto invalid;
+
+    catalog->header = header;
+    catalog->entries = (const SL_CATALOG_ENTRY*) (header + 1);
+    catalog->buckets = (const SLuint*) (catalog->entries + header->entryCount);
+    catalog->names = (const char*) (catalog->buckets + header->bucketCount);
+    catalog->entryCount = header->entryCount;
+
+    // the last name has to end, or a broken file could send strcmp off the end of the mapping
+    if (header->namesSize > 0 && catalog->names[header->namesSize - 1] != '\0')
+        goto invalid;
+
+    // lookups jump all over the file, reading ahead would only waste time
+    sl_advise_mapping(catalog->base, catalog->size, SL_MAP_ADVICE_RANDOM);
+    return SL_SUCCESS;
+
+    invalid:
+        sl_close_catalog(catalog);
+        return SL_INVALID_CATALOG;
+}
+
+DLL_EXPORT void sl_close_catalog(SL_CATALOG* catalog) {
+    if (catalog == NULL) return;
+
+    if (catalog->base != NULL) sl_unmap_file(catalog->base, catalog->size);
+    memset(catalog, 0, sizeof(SL_CATALOG));
+}
+
+DLL_EXPORT const SL_CATALOG_ENTRY* sl_catalog_find(const SL_CATALOG* catalog, SLstr name) {
+    SLullong hash;
+    SLullong mask;
+    SLullong slot;
+
+    if (catalog == NULL || catalog->base == NULL || name == NULL) return NULL;
+
+    hash = sl_hash_string(name);
+    mask = catalog->header->bucketCount - 1;
+    slot = hash & mask;
+
+    // the table is never more than half full so an empty bucket comes quickly. the limit is for broken files
+    for (SLullong i = 0; i <= mask && catalog->buckets[slot] != 0; i++, slot = (slot + 1) & mask) {
+        SLuint index = catalog->buckets[slot] - 1;
+        const SL_CATALOG_ENTRY* entry;
+
+        if (index >= catalog->entryCount) return NULL;
+
+        entry = &catalog->entries[index];
+        if (entry->hash == hash && entry->nameOffset < catalog->header->namesSize && strcmp(catalog->names + entry->nameOffset, name) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_catalog_lookup(const SL_CATALOG* catalog, SLstr name, SL_WAV_FILE* wavBuf) {
+    const SL_CATALOG_ENTRY* entry = sl_catalog_find(catalog, name);
+
+    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+    if (entry == NULL) return SL_FAIL;
+
+    memcpy(wavBuf->descriptorChunk.descriptorId, entry->endianness == SL_BIG_ENDIAN ? "RIFX" : "RIFF", 4);
+    memcpy(wavBuf->descriptorChunk.chunkFormat, "WAVE", 4);
+    wavBuf->descriptorChunk.descriptorChunkSize = entry->descriptorChunkSize;
+    wavBuf->descriptorChunk.endianness = entry->endianness;
+
+    memcpy(wavBuf->formatChunk.fmtId, "fmt ", 4);
+    wavBuf->formatChunk.fmtChunkSize = entry->fmtChunkSize;
+    wavBuf->formatChunk.sampleRate = entry->sampleRate;
+    wavBuf->formatChunk.byteRate = entry->byteRate;
+    wavBuf->formatChunk.audioFormat = entry->audioFormat;
+    wavBuf->formatChunk.numChannels = entry->numChannels;
+    wavBuf->formatChunk.blockAlign = entry->blockAlign;
+    wavBuf->formatChunk.bitsPerSample = entry->bitsPerSample;
+    wavBuf->formatChunk.extensionSize = entry->extensionSize;
+    wavBuf->formatChunk.samplesPerBlock = entry->samplesPerBlock;
+
+    memcpy(wavBuf->dataChunk.dataId, "data", 4);
+    wavBuf->dataChunk.dataChunkSize = entry->dataChunkSize;
+    wavBuf->dataChunk.pcmType = entry->pcmType;
+    wavBuf->dataChunk.dataOffset = entry->dataOffset;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SLstr sl_catalog_name(const SL_CATALOG* catalog, const SL_CATALOG_ENTRY* entry) {
+    return catalog->names + entry->nameOffset;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_open_bank_writer(SL_BANK_WRITER* writer, SLstr path) {
+    if (writer == NULL) return SL_INVALID_VALUE;
+    memset(writer, 0, sizeof(SL_BANK_WRITER));
+
+    if (path == NULL) return SL_INVALID_VALUE;
+
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) return SL_FILE_ERROR;
+
+    // room for the header. it stays zero until the bank is finished so a half written bank never opens
+    sl_bank_write(writer, NULL, SL_BANK_ALIGN);
+
+    return writer->failed ? SL_FILE_ERROR : SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_bank_writer_add(SL_BANK_WRITER* writer, SLstr name, const SL_WAV_FILE* wavBuf) {
+    SLullong nameSize;
+    SL_BANK_ENTRY* entry;
+
+    if (writer == NULL || writer->file == NULL || name == NULL || wavBuf == NULL) return SL_INVALID_VALUE;
+    if (wavBuf->dataChunk.waveformData == NULL || sl_pcm_type_size(wavBuf->dataChunk.pcmType) == 0) return SL_INVALID_VALUE;
+    if (writer->failed) return SL_FILE_ERROR;
+
+    nameSize = strlen(name) + 1;
+
+    // grow both by doubling. there is no realloc in SL_ALLOCATOR so it is a copy
+    if (writer->entryCount == writer->entryCapacity) {
+        SLullong newCapacity = writer->entryCapacity ? writer->entryCapacity * 2 : 64;
+        SL_BANK_ENTRY* newEntries = (SL_BANK_ENTRY*) sl_calloc(newCapacity, sizeof(SL_BANK_ENTRY));
+        if (newEntries == NULL) return SL_MALLOC_FAIL;
+
+        if (writer->entryCount > 0) memcpy(newEntries, writer->entries, writer->entryCount * sizeof(SL_BANK_ENTRY));
+        sl_free(writer->entries);
+        writer->entries = newEntries;
+        writer->entryCapacity = newCapacity;
+    }
+
+    if (writer->namesSize + nameSize > writer->namesCapacity) {
+        SLullong newCapacity = writer->namesCapacity ? writer->namesCapacity * 2 : 4096;
+        char* newNames;
+
+        while (newCapacity < writer->namesSize + nameSize) newCapacity *= 2;
+        newNames = (char*) sl_malloc(newCapacity);
+        if (newNames == NULL) return SL_MALLOC_FAIL;
+
+        if (writer->namesSize > 0) memcpy(newNames, writer->names, writer->namesSize);
+        sl_free(writer->names);
+        writer->names = newNames;
+        writer->namesCapacity = newCapacity;
+    }
+
+    // line the payload up with a page so it is page aligned in the mapping too
+    sl_bank_write(writer, NULL, (SL_BANK_ALIGN - writer->fileSize % SL_BANK_ALIGN) % SL_BANK_ALIGN);
+
+    entry = &writer->entries[writer->entryCount];
+    entry->hash = sl_hash_string(name);
+    entry->nameOffset = writer->namesSize;
+    entry->dataOffset = writer->fileSize;
+    entry->dataSize = wavBuf->dataChunk.dataChunkSize;
+    entry->pcmType = wavBuf->dataChunk.pcmType;
+    entry->format = wavBuf->formatChunk;
+
+    sl_bank_write(writer, wavBuf->dataChunk.waveformData, entry->dataSize);
+    if (writer->failed) return SL_FILE_ERROR;
+
+    memcpy(writer->names + writer->namesSize, name, nameSize);
+    writer->namesSize += nameSize;
+    writer->entryCount++;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_bank_writer_add_file(SL_BANK_WRITER* writer, SLstr name, SLstr path) {
+    SL_WAV_FILE wavBuf;
+    SL_RETURN_CODE ret;
+
+    ret = sl_read_wave_file(path, &wavBuf);
+    if (ret != SL_SUCCESS) return ret;
+
+    ret = sl_bank_writer_add(writer, name != NULL ? name : path, &wavBuf);
+
+    sl_cleanup_wave_file(&wavBuf);
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_close_bank_writer(SL_BANK_WRITER* writer) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    SL_BANK_HEADER header;
+    SLullong bucketCount = 16;
+    SLuint* buckets = NULL;
+
+    if (writer == NULL || writer->file == NULL) return SL_INVALID_VALUE;
+
+    if (writer->failed) {
+        ret = SL_FILE_ERROR;
+        goto cleanup;
+    }
+
+    // at most half full keeps the runs of full buckets short
+    while (bucketCount < writer->entryCount * 2) bucketCount *= 2;
+
+    buckets = (SLuint*) sl_calloc(bucketCount, sizeof(SLuint));
+    if (buckets == NULL) {
+        ret = SL_MALLOC_FAIL;
+        goto cleanup;
+    }
+
+    for (SLullong i = 0; i < writer->entryCount; i++) {
+        const SL_BANK_ENTRY* entry = &writer->entries[i];
+        SLullong slot = entry->hash & (bucketCount - 1);
+
+        while (buckets[slot] != 0) {
+            const SL_BANK_ENTRY* other = &writer->entries[buckets[slot] - 1];
+
+            // the second one could never be found
+            if (other->hash == entry->hash && strcmp(writer->names + other->nameOffset, writer->names + entry->nameOffset) == 0) {
+                ret = SL_INVALID_VALUE;
+                goto cleanup;
+            }
+
+            slot = (slot + 1) & (bucketCount - 1);
+        }
+
+        buckets[slot] = (SLuint) (i + 1);
+    }
+
+    memset(&header, 0, sizeof(SL_BANK_HEADER));
+    memcpy(header.magic, SL_BANK_MAGIC, 8);
+    header.version = SL_BANK_VERSION;
+    header.endianness = (SLuint) sl_get_native_endianness();
+    header.entryCount = writer->entryCount;
+    header.bucketCount = bucketCount;
+    header.namesSize = writer->namesSize;
+
+    // the table starts 8 byte aligned so the entries can be read in place
+    sl_bank_write(writer, NULL, (8 - writer->fileSize % 8) % 8);
+    header.tocOffset = writer->fileSize;
+
+    if (writer->entryCount > 0) sl_bank_write(writer, writer->entries, writer->entryCount * sizeof(SL_BANK_ENTRY));
+    sl_bank_write(writer, buckets, bucketCount * sizeof(SLuint));
+    if (writer->namesSize > 0) sl_bank_write(writer, writer->names, writer->namesSize);
+
+    // the header goes in last, once everything it points at is there
+    if (!writer->failed && fseek(writer->file, 0, SEEK_SET) != 0) writer->failed = 1;
+    if (!writer->failed && fwrite(&header, sizeof(SL_BANK_HEADER), 1, writer->file) != 1) writer->failed = 1;
+
+    if (writer->failed) ret = SL_FILE_ERROR;
+
+    cleanup:
+        if (fclose(writer->file) != 0 && ret == SL_SUCCESS) ret = SL_FILE_ERROR;
+        sl_free(buckets);
+        sl_free(writer->entries);
+        sl_free(writer->names);
+        memset(writer, 0, sizeof(SL_BANK_WRITER));
+        return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_open_bank(SL_BANK* bank, SLstr path) {
+    const SL_BANK_HEADER* header;
+    SL_RETURN_CODE ret;
+    SLullong tableSize;
+
+    if (bank == NULL) return SL_INVALID_VALUE;
+    memset(bank, 0, sizeof(SL_BANK));
+    if (path == NULL) return SL_INVALID_VALUE;
+
+    ret = sl_map_file(path, &bank->base, &bank->size);
+    if (ret != SL_SUCCESS) return ret;
+
+    header = (const SL_BANK_HEADER*) bank->base;
+    if (bank->size < SL_BANK_ALIGN || memcmp(header->magic, SL_BANK_MAGIC, 8) != 0 ||
+        header->version != SL_BANK_VERSION || header->endianness != (SLuint) sl_get_native_endianness())
+        goto invalid;
+
+    if (header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1)) != 0 || header->entryCount >= header->bucketCount)
+        goto invalid;
+
+    if (header->tocOffset < SL_BANK_ALIGN || header->tocOffset % 8 != 0 || header->tocOffset > bank->size ||
+        header->bucketCount > bank->size / sizeof(SLuint) || header->entryCount > bank->size / sizeof(SL_BANK_ENTRY) || header->namesSize > bank->size)
+        goto invalid;
+
+    tableSize = header->entryCount * sizeof(SL_BANK_ENTRY) + header->bucketCount * sizeof(SLuint) + header->namesSize;
+    if (header->tocOffset + tableSize != bank->size)
+        goto invalid;
+
+    bank->header = header;
+    bank->entries = (const SL_BANK_ENTRY*) ((const SLuchar*) bank->base + header->tocOffset);
+    bank->buckets = (const SLuint*) (bank->entries + header->entryCount);
+    bank->names = (const char*) (bank->buckets + header->bucketCount);
+    bank->entryCount = header->entryCount;
+
+    if (header->namesSize > 0 && bank->names[header->namesSize - 1] != '\0')
+        goto invalid;
+
+    // the views are what callers use, so every entry is checked once here instead of on every lookup
+    bank->files = (SL_WAV_FILE*) sl_calloc(bank->entryCount ? bank->entryCount : 1, sizeof(SL_WAV_FILE));
+    if (bank->files == NULL) {
+        sl_close_bank(bank);
+        return SL_MALLOC_FAIL;
+    }
+
+    for (SLullong i = 0; i < bank->entryCount; i++) {
+        const SL_BANK_ENTRY* entry = &bank->entries[i];
+        SL_WAV_FILE* file = &bank->files[i];
+
+        if (entry->nameOffset >= header->namesSize || entry->dataOffset % SL_BANK_ALIGN != 0 || entry->dataOffset < SL_BANK_ALIGN ||
+            entry->dataOffset > header->tocOffset || entry->dataSize > header->tocOffset - entry->dataOffset || entry->dataSize > 0xFFFFFFFFULL || sl_pcm_type_size(entry->pcmType) == 0)
+            goto invalid;
+
+        memcpy(file->descriptorChunk.descriptorId, header->endianness == SL_BIG_ENDIAN ? "RIFX" : "RIFF", 4);
+        memcpy(file->descriptorChunk.chunkFormat, "WAVE", 4);
+        file->descriptorChunk.descriptorChunkSize = (SLuint) (4 + 8 + entry->format.fmtChunkSize + 8 + entry->dataSize);
+        file->descriptorChunk.endianness = header->endianness;
+
+        file->formatChunk = entry->format;
+
+        memcpy(file->dataChunk.dataId, "data", 4);
+        file->dataChunk.dataChunkSize = (SLuint) entry->dataSize;
+        file->dataChunk.pcmType = entry->pcmType;
+        file->dataChunk.dataOffset = entry->dataOffset;
+        file->dataChunk.waveformData = (SLvoid) ((SLuchar*) bank->base + entry->dataOffset);
+        file->storage = SL_STORAGE_BORROWED;
+    }
+
+    return SL_SUCCESS;
+
+    invalid:
+        sl_close_bank(bank);
+        return SL_INVALID_BANK;
+}
+
+DLL_EXPORT void sl_close_bank(SL_BANK* bank) {
+    if (bank == NULL) return;
+
+    sl_free(bank->files);
+    if (bank->base != NULL) sl_unmap_file(bank->base, bank->size);
+    memset(bank, 0, sizeof(SL_BANK));
+}
+
+DLL_EXPORT SL_WAV_FILE* sl_bank_find(const SL_BANK* bank, SLstr name) {
+    SLullong hash;
+    SLullong mask;
+    SLullong slot;
+
+    if (bank == NULL || bank->files == NULL || name == NULL) return NULL;
+
+    hash = sl_hash_string(name);
+    mask = bank->header->bucketCount - 1;
+    slot = hash & mask;
+
+    for (SLullong i = 0; i <= mask && bank->buckets[slot] != 0; i++, slot = (slot + 1) & mask) {
+        SLuint index = bank->buckets[slot] - 1;
+
+        if (index >= bank->entryCount) return NULL;
+
+        if (bank->entries[index].hash == hash && strcmp(bank->names + bank->entries[index].nameOffset, name) == 0)
+            return &bank->files[index];
+    }
+
+    return NULL;
+}
+
+DLL_EXPORT SLstr sl_bank_name(const SL_BANK* bank, SLullong index) {
+    return bank->names + bank->entries[index].nameOffset;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_create_loader(SL_LOADER* loader, const SL_LOADER_OPTIONS* opts) {
+    SL_LOADER_OPTIONS defaults;
+
+    if (loader == NULL) return SL_INVALID_VALUE;
+    memset(loader, 0, sizeof(SL_LOADER));
+
+    if (opts == NULL) {
+        memset(&defaults, 0, sizeof(SL_LOADER_OPTIONS));
+        opts = &defaults;
+    }
+
+    loader->flags = opts->flags;
+    sl_mutex_init(&loader->mutex);
+    sl_cond_init(&loader->wake);
+    sl_cond_init(&loader->done);
+
+    #ifdef SL_HAS_IO_URING
+        loader->depth = opts->depth ? opts->depth : SL_LOADER_DEFAULT_DEPTH;
+
+        // every file in flight has at most one read in the ring, so depth entries is enough
+        if (!(opts->flags & SL_LOADER_NO_URING) && sl_uring_init(&loader->ring, loader->depth) == SL_SUCCESS) {
+            loader->headers = (SLuchar*) sl_aligned_malloc_b((SLullong) loader->depth * SL_LOADER_HEADER_SIZE, SL_LOADER_HEADER_SIZE);
+            loader->freeSlots = (SLuint*) sl_malloc(loader->depth * sizeof(SLuint));
+
+            if (loader->headers == NULL || loader->freeSlots == NULL) {
+                sl_free(loader->headers);
+                sl_free(loader->freeSlots);
+                sl_uring_destroy(&loader->ring);
+                sl_mutex_destroy(&loader->mutex);
+                sl_cond_destroy(&loader->wake);
+                sl_cond_destroy(&loader->done);
+                return SL_MALLOC_FAIL;
+            }
+
+            for (SLuint i = 0; i < loader->depth; i++) loader->freeSlots[i] = loader->depth - 1 - i;
+            loader->freeCount = loader->depth;
+
+            // registering can fail on a low RLIMIT_MEMLOCK. plain reads work just the same
+            struct iovec headers;
+            headers.iov_base = loader->headers;
+            headers.iov_len = (size_t) loader->depth * SL_LOADER_HEADER_SIZE;
+            loader->registered = syscall(__NR_io_uring_register, loader->ring.fd, IORING_REGISTER_BUFFERS, &headers, 1) == 0;
+
+            loader->uring = 1;
+            return SL_SUCCESS;
+        }
+    #endif // SL_HAS_IO_URING
+
+    loader->threadCount = opts->threadCount ? opts->threadCount : sl_get_cpu_count();
+    loader->threads = (SL_THREAD*) sl_malloc(loader->threadCount * sizeof(SL_THREAD));
+    if (loader->threads == NULL) {
+        sl_mutex_destroy(&loader->mutex);
+        sl_cond_destroy(&loader->wake);
+        sl_cond_destroy(&loader->done);
+        return SL_MALLOC_FAIL;
+    }
+
+    for (SLuint i = 0; i < loader->threadCount; i++) {
+        if (sl_thread_create(&loader->threads[i], sl_loader_worker, loader) != SL_SUCCESS) {
+            loader->threadCount = i;
+            break;
+        }
+    }
+
+    if (loader->threadCount == 0) {
+        sl_free(loader->threads);
+        sl_mutex_destroy(&loader->mutex);
+        sl_cond_destroy(&loader->wake);
+        sl_cond_destroy(&loader->done);
+        return SL_FAIL;
+    }
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_destroy_loader(SL_LOADER* loader) {
+    SL_LOAD_REQUEST* request;
+
+    if (loader == NULL) return;
+
+    sl_mutex_lock(&loader->mutex);
+    loader->stopping = 1;
+
+    // nobody is going to get these, so don't start them
+    request = loader->queuedHead;
+    while (request != NULL) {
+        SL_LOAD_REQUEST* next = request->next;
+        sl_free(request->path);
+        sl_free(request);
+        request = next;
+    }
+    loader->queuedHead = loader->queuedTail = NULL;
+
+    sl_cond_broadcast(&loader->wake);
+    sl_mutex_unlock(&loader->mutex);
+
+    if (loader->uring) {
+        #ifdef SL_HAS_IO_URING
+            // the kernel may still be writing into our buffers, so everything in flight has to land first
+            while (loader->inFlight > 0 && sl_loader_pump(loader, 1) == SL_SUCCESS) {}
+
+            sl_uring_destroy(&loader->ring);
+            sl_free(loader->headers);
+            sl_free(loader->freeSlots);
+        #endif // SL_HAS_IO_URING
+    } else {
+        for (SLuint i = 0; i < loader->threadCount; i++) sl_thread_join(loader->threads[i]);
+        sl_free(loader->threads);
+    }
+
+    request = loader->doneHead;
+    while (request != NULL) {
+        SL_LOAD_REQUEST* next = request->next;
+        sl_cleanup_wave_file(&request->result.file);
+        sl_free(request->path);
+        sl_free(request);
+        request = next;
+    }
+
+    sl_mutex_destroy(&loader->mutex);
+    sl_cond_destroy(&loader->wake);
+    sl_cond_destroy(&loader->done);
+    memset(loader, 0, sizeof(SL_LOADER));
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_loader_submit(SL_LOADER* loader, SLstr path, SLvoid user) {
+    SL_LOAD_REQUEST* request;
+
+    if (loader == NULL || path == NULL) return SL_INVALID_VALUE;
+
+    request = (SL_LOAD_REQUEST*) sl_calloc(1, sizeof(SL_LOAD_REQUEST));
+    if (request == NULL) return SL_MALLOC_FAIL;
+
+    request->path = (char*) sl_malloc(strlen(path) + 1);
+    if (request->path == NULL) {
+        sl_free(request);
+        return SL_MALLOC_FAIL;
+    }
+    strcpy(request->path, path);
+
+    request->result.user = user;
+    request->fd = -1;
+
+    sl_mutex_lock(&loader->mutex);
+    if (loader->queuedTail != NULL) loader->queuedTail->next = request;
+    else loader->queuedHead = request;
+    loader->queuedTail = request;
+    sl_cond_signal(&loader->wake);
+    sl_mutex_unlock(&loader->mutex);
+
+    loader->pending++;
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SLuint sl_loader_poll(SL_LOADER* loader, SL_LOADER_RESULT* results, SLuint max, SLbool wait) {
+    SLuint count = 0;
+
+    if (loader == NULL || results == NULL || max == 0) return 0;
+    if (loader->pending == 0) return 0;
+
+    #ifdef SL_HAS_IO_URING
+        if (loader->uring) sl_loader_pump(loader, wait);
+    #endif // SL_HAS_IO_URING
+
+    // with io_uring the pump already waited. nobody would signal done
+    sl_mutex_lock(&loader->mutex);
+    while (!loader->uring && wait && loader->doneHead == NULL) sl_cond_wait(&loader->done, &loader->mutex);
+
+    while (count < max && loader->doneHead != NULL) {
+        SL_LOAD_REQUEST* request = loader->doneHead;
+        loader->doneHead = request->next;
+        if (loader->doneHead == NULL) loader->doneTail = NULL;
+
+        results[count++] = request->result;
+        sl_free(request->path);
+        sl_free(request);
+    }
+    sl_mutex_unlock(&loader->mutex);
+
+    loader->pending -= count;
+    return count;
+}
+
+DLL_EXPORT SLullong sl_loader_pending(const SL_LOADER* loader) {
+    return loader != NULL ? loader->pending : 0;
+}
+
+DLL_EXPORT void sl_loader_worker(SLvoid arg) {
+    SL_LOADER* loader = (SL_LOADER*) arg;
+
+    sl_mutex_lock(&loader->mutex);
+    for (;;) {
+        SL_LOAD_REQUEST* request;
+
+        while (!loader->stopping && loader->queuedHead == NULL) sl_cond_wait(&loader->wake, &loader->mutex);
+        if (loader->stopping) break;
+
+        request = loader->queuedHead;
+        loader->queuedHead = request->next;
+        if (loader->queuedHead == NULL) loader->queuedTail = NULL;
+        sl_mutex_unlock(&loader->mutex);
+
+        request->result.result = sl_read_wave_file_b(request->path, &request->result.file, (loader->flags & SL_LOADER_KEEP_COMPRESSED) ? SL_READ_KEEP_COMPRESSED : SL_READ_DEFAULT);
+
+        sl_mutex_lock(&loader->mutex);
+        sl_loader_push_done(loader, request);
+        sl_cond_signal(&loader->done);
+    }
+    sl_mutex_unlock(&loader->mutex);
+}
+
+DLL_EXPORT void sl_loader_push_done(SL_LOADER* loader, SL_LOAD_REQUEST* request) {
+    request->next = NULL;
+    if (loader->doneTail != NULL) loader->doneTail->next = request;
+    else loader->doneHead = request;
+    loader->doneTail = request;
+}
+
+#ifdef SL_HAS_IO_URING
+DLL_EXPORT SL_RETURN_CODE sl_uring_init(SL_URING* ring, SLuint entries) {
+    struct io_uring_params params;
+    SLuchar* sq;
+    SLuchar* cq;
+
+    memset(ring, 0, sizeof(SL_URING));
+    memset(&params, 0, sizeof(params));
+
+    // seccomp and docker often turn io_uring off. that is the thread pool's job then
+    ring->fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) return SL_FAIL;
+
+    ring->entries = params.sq_entries;
+    ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(SLuint);
+    ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    // newer kernels map both rings at once
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cqRingSize > ring->sqRingSize) ring->sqRingSize = ring->cqRingSize;
+        ring->cqRingSize = ring->sqRingSize;
+    }
+
+    ring->sqRing = mmap(NULL, (size_t) ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqRing == MAP_FAILED) goto closeRing;
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cqRing = ring->sqRing;
+    } else {
+        ring->cqRing = mmap(NULL, (size_t) ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqRing == MAP_FAILED) goto unmapSq;
+    }
+
+    ring->sqes = mmap(NULL, (size_t) ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) goto unmapCq;
+
+    sq = (SLuchar*) ring->sqRing;
+    ring->sqHead = (volatile SLuint*) (sq + params.sq_off.head);
+    ring->sqTail = (volatile SLuint*) (sq + params.sq_off.tail);
+    ring->sqMask = *(SLuint*) (sq + params.sq_off.ring_mask);
+    ring->sqArray = (SLuint*) (sq + params.sq_off.array);
+
+    cq = (SLuchar*) ring->cqRing;
+    ring->cqHead = (volatile SLuint*) (cq + params.cq_off.head);
+    ring->cqTail = (volatile SLuint*) (cq + params.cq_off.tail);
+    ring->cqMask = *(SLuint*) (cq + params.cq_off.ring_mask);
+    ring->cqes = (SLvoid) (cq + params.cq_off.cqes);
+
+    return SL_SUCCESS;
+
+    unmapCq:
+        if (ring->cqRing != ring->sqRing) munmap(ring->cqRing, (size_t) ring->cqRingSize);
+    unmapSq:
+        munmap(ring->sqRing, (size_t) ring->sqRingSize);
+    closeRing:
+        close(ring->fd);
+        memset(ring, 0, sizeof(SL_URING));
+        return SL_FAIL;
+}
+
+DLL_EXPORT void sl_uring_destroy(SL_URING* ring) {
+    munmap(ring->sqes, (size_t) ring->sqesSize);
+    if (ring->cqRing != ring->sqRing) munmap(ring->cqRing, (size_t) ring->cqRingSize);
+    munmap(ring->sqRing, (size_t) ring->sqRingSize);
+    close(ring->fd);
+    memset(ring, 0, sizeof(SL_URING));
+}
+
+DLL_EXPORT void sl_uring_read(SL_LOADER* loader, SL_LOAD_REQUEST* request, SLvoid dst, SLuint size, SLullong offset, SLbool fixed) {
+    SL_URING* ring = &loader->ring;
+    SLuint tail = *ring->sqTail;
+    SLuint index = tail & ring->sqMask;
+    struct io_uring_sqe* sqe = &((struct io_uring_sqe*) ring->sqes)[index];
+
+    // no more than depth reads are ever in flight and the ring holds at least that many, so there is always room
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = request->fd;
+    sqe->addr = (SLullong) (uintptr_t) dst;
+    sqe->len = size;
+    sqe->off = offset;
+    sqe->buf_index = 0;
+    sqe->user_data = (SLullong) (uintptr_t) request;
+
+    ring->sqArray[index] = index;
+
+    // the kernel must see the entry before it sees the new tail
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+
+    loader->inFlight++;
+    loader->unsubmitted++;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_loader_pump(SL_LOADER* loader, SLbool wait) {
+    SL_URING* ring = &loader->ring;
+
+    for (;;) {
+        SLuint head;
+        SLuint tail;
+        SLbool block;
+        long ret;
+
+        // start as many files as there are free header buffers. starting one can finish it right away, which locks too
+        while (loader->freeCount > 0) {
+            SL_LOAD_REQUEST* request;
+
+            sl_mutex_lock(&loader->mutex);
+            request = loader->queuedHead;
+            if (request != NULL) {
+                loader->queuedHead = request->next;
+                if (loader->queuedHead == NULL) loader->queuedTail = NULL;
+            }
+            sl_mutex_unlock(&loader->mutex);
+
+            if (request == NULL) break;
+            sl_loader_start(loader, request);
+        }
+
+        // completions can queue more reads, so keep going until there is nothing left to hand over
+        head = *ring->cqHead;
+        tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        if (head != tail) {
+            while (head != tail) {
+                struct io_uring_cqe* cqe = &((struct io_uring_cqe*) ring->cqes)[head & ring->cqMask];
+                SL_LOAD_REQUEST* request = (SL_LOAD_REQUEST*) (uintptr_t) cqe->user_data;
+                SLint res = cqe->res;
+
+                // give the slot back before handling it, handling can queue a new read
+                head++;
+                __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+                loader->inFlight--;
+
+                sl_loader_complete(loader, request, res);
+            }
+            continue;
+        }
+
+        // sl_destroy_loader waits for everything in flight, not just for the first file
+        block = wait && (loader->doneHead == NULL || loader->stopping) && loader->inFlight > 0;
+        if (loader->unsubmitted == 0 && !block) return SL_SUCCESS;
+
+        ret = syscall(__NR_io_uring_enter, ring->fd, loader->unsubmitted, block ? 1 : 0, block ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            return SL_FAIL;
+        }
+
+        loader->unsubmitted -= (SLuint) ret;
+    }
+}
+
+DLL_EXPORT void sl_loader_start(SL_LOADER* loader, SL_LOAD_REQUEST* request) {
+    struct stat st;
+
+    request->slot = loader->freeSlots[--loader->freeCount];
+    request->stage = SL_LOAD_HEADER;
+
+    if (sl_is_wave_file(request->path) == SL_FAIL) {
+        sl_loader_finish(loader, request, SL_FILE_ERROR);
+        return;
+    }
+
+    #ifdef O_DIRECT
+        if (loader->flags & SL_LOADER_DIRECT) {
+            // tmpfs and some others say no to O_DIRECT. those just get normal reads
+            request->fd = open(request->path, O_RDONLY | O_DIRECT);
+            request->direct = request->fd >= 0;
+        }
+    #endif // O_DIRECT
+
+    if (request->fd < 0) request->fd = open(request->path, O_RDONLY);
+    if (request->fd < 0) {
+        sl_loader_finish(loader, request, SL_FILE_ERROR);
+        return;
+    }
+
+    if (fstat(request->fd, &st) != 0) {
+        sl_loader_finish(loader, request, SL_FILE_ERROR);
+        return;
+    }
+    request->fileSize = (SLullong) st.st_size;
+
+    sl_uring_read(loader, request, loader->headers + (SLullong) request->slot * SL_LOADER_HEADER_SIZE, SL_LOADER_HEADER_SIZE, 0, loader->registered);
+}
+
+DLL_EXPORT void sl_loader_complete(SL_LOADER* loader, SL_LOAD_REQUEST* request, SLint res) {
+    SL_RETURN_CODE ret;
+    SLullong needed;
+
+    if (res < 0) {
+        sl_loader_finish(loader, request, SL_FILE_ERROR);
+        return;
+    }
+
+    SL_STATS_ADD(bytesRead, res);
+
+    if (request->stage == SL_LOAD_HEADER) {
+        ret = sl_loader_read_data(loader, request, (SLullong) res);
+        if (ret != SL_SUCCESS) sl_loader_finish(loader, request, ret);
+        return;
+    }
+
+    // with O_DIRECT the last block stops short at the end of the file. that is fine once the samples are in
+    request->readDone += (SLullong) res;
+    needed = request->result.file.dataChunk.dataOffset + request->result.file.dataChunk.dataChunkSize - request->readOffset;
+
+    if (request->readDone >= needed) {
+        sl_loader_finish(loader, request, SL_SUCCESS);
+    } else if (res == 0 || request->readDone >= request->readSize) {
+        sl_loader_finish(loader, request, SL_INVALID_CHUNK_DATA_DATA);
+    } else {
+        SLullong left = request->readSize - request->readDone;
+        sl_uring_read(loader, request, request->buffer + request->readDone, (SLuint) (left < SL_LOADER_MAX_READ ? left : SL_LOADER_MAX_READ), request->readOffset + request->readDone, 0);
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_loader_read_data(SL_LOADER* loader, SL_LOAD_REQUEST* request, SLullong headerSize) {
+    const SLuchar* header = loader->headers + (SLullong) request->slot * SL_LOADER_HEADER_SIZE;
+    SL_WAV_FILE* wavBuf = &request->result.file;
+    SL_RETURN_CODE ret;
+    SL_MEMORY_IO mem;
+    SL_IO io;
+    SLullong end;
+
+    // the same steps as sl_probe_wave_io, but on the block we already have
+    sl_io_from_memory(&io, &mem, header, headerSize);
+
+    SL_STATS_TIME(descriptorTime, ret = sl_read_wave_descriptor(&io, wavBuf));
+    if (ret != SL_SUCCESS) return ret;
+    SL_STATS_TIME(chunkTime, ret = sl_parse_wave_chunks_b(&io, wavBuf, 0));
+
+    // the format chunk can sit past the first block, after the samples or behind a lot of metadata. rare enough to read it the slow way.
+    // only a walk that ran out of block gets there, any other error is the file's fault and the slow way would just find it again
+    if (ret != SL_SUCCESS && mem.pos >= mem.size && headerSize == SL_LOADER_HEADER_SIZE && request->fileSize > SL_LOADER_HEADER_SIZE)
+        ret = sl_probe_wave_file(request->path, wavBuf);
+    else if (ret == SL_SUCCESS)
+        ret = sl_validate_wave_data(wavBuf);
+    if (ret != SL_SUCCESS) return ret;
+
+    end = wavBuf->dataChunk.dataOffset + wavBuf->dataChunk.dataChunkSize;
+    if (end > request->fileSize) return SL_INVALID_CHUNK_DATA_DATA;
+
+    request->stage = SL_LOAD_DATA;
+
+    if (request->direct) {
+        // direct reads have to start and end on a block and go into block aligned memory
+        request->readOffset = wavBuf->dataChunk.dataOffset & ~(SLullong) (SL_LOADER_HEADER_SIZE - 1);
+        request->readSize = ((end + SL_LOADER_HEADER_SIZE - 1) & ~(SLullong) (SL_LOADER_HEADER_SIZE - 1)) - request->readOffset;
+        request->buffer = (SLuchar*) sl_aligned_malloc_b(request->readSize, SL_LOADER_HEADER_SIZE);
+    } else {
+        request->readOffset = wavBuf->dataChunk.dataOffset;
+        request->readSize = wavBuf->dataChunk.dataChunkSize;
+        request->buffer = (SLuchar*) sl_aligned_malloc(request->readSize);
+    }
+    if (request->buffer == NULL) return SL_MALLOC_FAIL;
+
+    // small files are already all there
+    if (end <= headerSize) {
+        memcpy(request->buffer, header + request->readOffset, (size_t) (end - request->readOffset));
+        request->readDone = end - request->readOffset;
+        sl_loader_finish(loader, request, SL_SUCCESS);
+        return SL_SUCCESS;
+    }
+
+    sl_uring_read(loader, request, request->buffer, (SLuint) (request->readSize < SL_LOADER_MAX_READ ? request->readSize : SL_LOADER_MAX_READ), request->readOffset, 0);
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_loader_finish(SL_LOADER* loader, SL_LOAD_REQUEST* request, SL_RETURN_CODE result) {
+    SL_WAV_FILE* wavBuf = &request->result.file;
+
+    if (request->fd >= 0) close(request->fd);
+    request->fd = -1;
+
+    loader->freeSlots[loader->freeCount++] = request->slot;
+
+    if (result == SL_SUCCESS) {
+        // the samples have to start at the start of the allocation so sl_cleanup_wave_file can free them
+        SLullong skip = wavBuf->dataChunk.dataOffset - request->readOffset;
+        if (skip > 0) memmove(request->buffer, request->buffer + skip, wavBuf->dataChunk.dataChunkSize);
+
+        wavBuf->dataChunk.waveformData = request->buffer;
+        wavBuf->storage = SL_STORAGE_OWNED;
+        request->buffer = NULL;
+
+        result = sl_ensure_wave_endianness(wavBuf);
+        if (result == SL_SUCCESS && !(loader->flags & SL_LOADER_KEEP_COMPRESSED)) result = sl_decompress_wave_file(wavBuf);
+    }
+
+    if (result == SL_SUCCESS) {
+        SL_STATS_ADD(filesParsed, 1);
+    } else {
+        sl_free(request->buffer);
+        request->buffer = NULL;
+        sl_cleanup_wave_file(wavBuf);
+        memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+    }
+    request->result.result = result;
+
+    sl_mutex_lock(&loader->mutex);
+    sl_loader_push_done(loader, request);
+    sl_mutex_unlock(&loader->mutex);
+}
+#endif // SL_HAS_IO_URING
+
+DLL_EXPORT void sl_bank_write(SL_BANK_WRITER* writer, const void* data, SLullong size) {
+    static const SLuchar zeros[SL_BANK_ALIGN] = {0};
+
+    if (writer->failed || size == 0) return;
+
+    if (data != NULL) {
+        if (fwrite(data, 1, (size_t) size, writer->file) != (size_t) size) writer->failed = 1;
+    } else {
+        SLullong left = size;
+        while (left > 0 && !writer->failed) {
+            SLullong chunk = left < SL_BANK_ALIGN ? left : SL_BANK_ALIGN;
+            if (fwrite(zeros, 1, (size_t) chunk, writer->file) != (size_t) chunk) writer->failed = 1;
+            left -= chunk;
+        }
+    }
+
+    writer->fileSize += size;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_catalog_walk(SL_CATALOG_BUILDER* builder, SLullong pathLength) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+
+    #ifdef _WIN32
+        WIN32_FIND_DATAA found;
+        HANDLE find;
+
+        memcpy(builder->path + pathLength, "*", 2);
+        find = FindFirstFileA(builder->path, &found);
+        if (find == INVALID_HANDLE_VALUE) return SL_FILE_ERROR;
+
+        do {
+            SLullong nameLength = strlen(found.cFileName);
+
+            if (strcmp(found.cFileName, ".") == 0 || strcmp(found.cFileName, "..") == 0) continue;
+            if (pathLength + nameLength + 2 >= SL_CATALOG_MAX_PATH) continue;
+
+            memcpy(builder->path + pathLength, found.cFileName, nameLength + 1);
+
+            if (found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                // junctions can point back up the tree
+                if (found.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) continue;
+
+                builder->path[pathLength + nameLength] = '/';
+                ret = sl_catalog_walk(builder, pathLength + nameLength + 1);
+
+                // a folder we can't read is left out
+                if (ret == SL_FILE_ERROR) ret = SL_SUCCESS;
+            } else if (sl_is_wave_file(builder->path) == SL_SUCCESS) {
+                SLllong modifiedTime = (SLllong) (((SLullong) found.ftLastWriteTime.dwHighDateTime << 32) | found.ftLastWriteTime.dwLowDateTime);
+                SLullong fileSize = ((SLullong) found.nFileSizeHigh << 32) | found.nFileSizeLow;
+
+                ret = sl_catalog_add_file(builder, pathLength + nameLength, modifiedTime, fileSize);
+            }
+        } while (ret == SL_SUCCESS && FindNextFileA(find, &found));
+
+        FindClose(find);
+    #elif defined(__linux__) || defined(__APPLE__)
+        DIR* dir;
+        struct dirent* found;
+
+        builder->path[pathLength] = '\0';
+        dir = opendir(builder->path);
+        if (dir == NULL) return SL_FILE_ERROR;
+
+        while (ret == SL_SUCCESS && (found = readdir(dir)) != NULL) {
+            SLullong nameLength = strlen(found->d_name);
+            struct stat st;
+
+            if (strcmp(found->d_name, ".") == 0 || strcmp(found->d_name, "..") == 0) continue;
+            if (pathLength + nameLength + 2 >= SL_CATALOG_MAX_PATH) continue;
+
+            memcpy(builder->path + pathLength, found->d_name, nameLength + 1);
+
+            // lstat so a link to a folder can't send the walk in circles. links to files are still followed
+            if (lstat(builder->path, &st) != 0) continue;
+
+            if (S_ISDIR(st.st_mode)) {
+                builder->path[pathLength + nameLength] = '/';
+                ret = sl_catalog_walk(builder, pathLength + nameLength + 1);
+
+                // a folder we can't read is left out
+                if (ret == SL_FILE_ERROR) ret = SL_SUCCESS;
+            } else if (sl_is_wave_file(builder->path) == SL_SUCCESS) {
+                SLllong modifiedTime;
+
+                if (S_ISLNK(st.st_mode) && stat(builder->path, &st) != 0) continue;
+                if (!S_ISREG(st.st_mode)) continue;
+
+                #ifdef __APPLE__
+                    modifiedTime = (SLllong) st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+                #else
+                    modifiedTime = (SLllong) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+                #endif // __APPLE__
+
+                ret = sl_catalog_add_file(builder, pathLength + nameLength, modifiedTime, (SLullong) st.st_size);
+            }
+        }
+
+        closedir(dir);
+    #else
+        return SL_FILE_ERROR;
+    #endif // _WIN32
+
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_catalog_add_file(SL_CATALOG_BUILDER* builder, SLullong pathLength, SLllong modifiedTime, SLullong fileSize) {
+    SLstr name = builder->path + builder->rootLength;
+    SLullong nameSize = pathLength - builder->rootLength + 1;
+    const SL_CATALOG_ENTRY* old;
+    SL_CATALOG_ENTRY* entry;
+
+    // grow both by doubling. there is no realloc in SL_ALLOCATOR so it is a copy
+    if (builder->entryCount == builder->entryCapacity) {
+        SLullong newCapacity = builder->entryCapacity ? builder->entryCapacity * 2 : 256;
+        SL_CATALOG_ENTRY* newEntries = (SL_CATALOG_ENTRY*) sl_calloc(newCapacity, sizeof(SL_CATALOG_ENTRY));
+        if (newEntries == NULL) return SL_MALLOC_FAIL;
+
+        if (builder->entryCount > 0) memcpy(newEntries, builder->entries, builder->entryCount * sizeof(SL_CATALOG_ENTRY));
+        sl_free(builder->entries);
+        builder->entries = newEntries;
+        builder->entryCapacity = newCapacity;
+    }
+
+    if (builder->namesSize + nameSize > builder->namesCapacity) {
+        SLullong newCapacity = builder->namesCapacity ? builder->namesCapacity * 2 : 16384;
+        char* newNames;
+
+        while (newCapacity < builder->namesSize + nameSize) newCapacity *= 2;
+        newNames = (char*) sl_malloc(newCapacity);
+        if (newNames == NULL) return SL_MALLOC_FAIL;
+
+        if (builder->namesSize > 0) memcpy(newNames, builder->names, builder->namesSize);
+        sl_free(builder->names);
+        builder->names = newNames;
+        builder->namesCapacity = newCapacity;
+    }
+
+    entry = &builder->entries[builder->entryCount];
+    old = sl_catalog_find(&builder->old, name);
+
+    // a file with the same size and write time as last time is taken as it was. everything else is parsed again
+    if (old != NULL && old->modifiedTime == modifiedTime && old->fileSize == fileSize) {
+        *entry = *old;
+        builder->stats.reused++;
+    } else {
+        SL_WAV_FILE wavBuf;
+
+        if (sl_probe_wave_file(builder->path, &wavBuf) != SL_SUCCESS) {
+            builder->stats.failed++;
+            return SL_SUCCESS;
+        }
+
+        memset(entry, 0, sizeof(SL_CATALOG_ENTRY));
+        entry->dataOffset = wavBuf.dataChunk.dataOffset;
+        entry->dataChunkSize = wavBuf.dataChunk.dataChunkSize;
+        entry->descriptorChunkSize = wavBuf.descriptorChunk.descriptorChunkSize;
+        entry->fmtChunkSize = wavBuf.formatChunk.fmtChunkSize;
+        entry->sampleRate = wavBuf.formatChunk.sampleRate;
+        entry->byteRate = wavBuf.formatChunk.byteRate;
+        entry->pcmType = wavBuf.dataChunk.pcmType;
+        entry->endianness = wavBuf.descriptorChunk.endianness;
+        entry->audioFormat = wavBuf.formatChunk.audioFormat;
+        entry->numChannels = wavBuf.formatChunk.numChannels;
+        entry->blockAlign = wavBuf.formatChunk.blockAlign;
+        entry->bitsPerSample = wavBuf.formatChunk.bitsPerSample;
+        entry->extensionSize = wavBuf.formatChunk.extensionSize;
+        entry->samplesPerBlock = wavBuf.formatChunk.samplesPerBlock;
+        builder->stats.probed++;
+    }
+
+    entry->hash = sl_hash_string(name);
+    entry->nameOffset = builder->namesSize;
+    entry->modifiedTime = modifiedTime;
+    entry->fileSize = fileSize;
+
+    memcpy(builder->names + builder->namesSize, name, nameSize);
+    builder->namesSize += nameSize;
+    builder->entryCount++;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_catalog_write(SL_CATALOG_BUILDER* builder, SLstr indexPath) {
+    SL_RETURN_CODE ret = SL_SUCCESS;
+    SL_CATALOG_HEADER header;
+    SLullong bucketCount = 16;
+    SLuint* buckets;
+    char* tempPath;
+    FILE* file;
+    SLbool written;
+
+    // at most half full keeps the runs of full buckets short
+    while (bucketCount < builder->entryCount * 2) bucketCount *= 2;
+
+    buckets = (SLuint*) sl_calloc(bucketCount, sizeof(SLuint));
+    if (buckets == NULL) return SL_MALLOC_FAIL;
+
+    for (SLullong i = 0; i < builder->entryCount; i++) {
+        SLullong slot = builder->entries[i].hash & (bucketCount - 1);
+        while (buckets[slot] != 0) slot = (slot + 1) & (bucketCount - 1);
+        buckets[slot] = (SLuint) (i + 1);
+    }
+
+    memset(&header, 0, sizeof(SL_CATALOG_HEADER));
+    memcpy(header.magic, SL_CATALOG_MAGIC, 8);
+    header.version = SL_CATALOG_VERSION;
+    header.endianness = (SLuint) sl_get_native_endianness();
+    header.entryCount = builder->entryCount;
+    header.bucketCount = bucketCount;
+    header.namesSize = builder->namesSize;
+
+    // written next to the real one and renamed over it, so a crash never leaves half a catalog behind
+    tempPath = (char*) sl_malloc(strlen(indexPath) + 5);
+    if (tempPath == NULL) {
+        ret = SL_MALLOC_FAIL;
+        goto cleanup;
+    }
+    strcpy(tempPath, indexPath);
+    strcat(tempPath, ".tmp");
+
+    file = fopen(tempPath, "wb");
+    if (file == NULL) {
+        ret = SL_FILE_ERROR;
+        goto cleanup;
+    }
+
+    written = fwrite(&header, sizeof(SL_CATALOG_HEADER), 1, file) == 1;
+    if (written && builder->entryCount > 0)
+        written = fwrite(builder->entries, sizeof(SL_CATALOG_ENTRY), builder->entryCount, file) == builder->entryCount;
+    if (written)
+        written = fwrite(buckets, sizeof(SLuint), bucketCount, file) == bucketCount;
+    if (written && builder->namesSize > 0)
+        written = fwrite(builder->names, 1, builder->namesSize, file) == builder->namesSize;
+    if (fclose(file) != 0) written = 0;
+
+    if (!written) {
+        remove(tempPath);
+        ret = SL_FILE_ERROR;
+        goto cleanup;
+    }
+
+    #ifdef _WIN32
+        written = MoveFileExA(tempPath, indexPath, MOVEFILE_REPLACE_EXISTING) != 0;
+    #else
+        written = rename(tempPath, indexPath) == 0;
+    #endif // _WIN32
+
+    if (!written) {
+        remove(tempPath);
+        ret = SL_FILE_ERROR;
+    }
+
+    cleanup:
+        sl_free(tempPath);
+        sl_free(buckets);
+        return ret;
+}
+
+DLL_EXPORT SLullong sl_hash_string(SLstr str) {
+    SLullong hash = 14695981039346656037ULL;
+    while (*str) {
+        hash ^= (SLuchar) *str++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_is_wave_file(SLstr path) {
+    return sl_has_extension(path, ".wav") || sl_has_extension(path, ".wave") ? SL_SUCCESS : SL_FAIL;
+}
+
+DLL_EXPORT SLbool sl_has_extension(SLstr path, SLstr extension) {
+    SLullong pathLen = strlen(path);
+    SLullong extensionLen = strlen(extension);
+
+    if (extensionLen > pathLen) return 0;
+
+    // compared in place so checking a name never needs the heap
+    path += pathLen - extensionLen;
+    for (SLullong i = 0; i < extensionLen; i++)
+        if (tolower((unsigned char) path[i]) != extension[i]) return 0;
+
+    return 1;
+}
+
+DLL_EXPORT void sl_io_from_file(SL_IO* io, FILE* file) {
+    io->read = sl_file_io_read;
+    io->seek = sl_file_io_seek;
+    io->tell = sl_file_io_tell;
+    io->user = file;
+}
+
+DLL_EXPORT void sl_io_from_memory(SL_IO* io, SL_MEMORY_IO* mem, const void* data, SLullong size) {
+    mem->data = (const SLuchar*) data;
+    mem->size = size;
+    mem->pos = 0;
+
+    io->read = sl_memory_io_read;
+    io->seek = sl_memory_io_seek;
+    io->tell = sl_memory_io_tell;
+    io->user = mem;
+}
+
+DLL_EXPORT SLullong sl_file_io_read(SLvoid user, SLvoid dst, SLullong size) {
+    SLullong read = fread(dst, 1, size, (FILE*) user);
+    SL_STATS_ADD(bytesRead, read);
+    return read;
+}
+
+DLL_EXPORT SLint sl_file_io_seek(SLvoid user, SLllong offset, SLint origin) {
+#ifdef _WIN32
+    return _fseeki64((FILE*) user, offset, origin);
+#elif defined(__linux__) || defined(__APPLE__)
+    return fseeko((FILE*) user, (off_t) offset, origin);
+#else
+    return fseek((FILE*) user, (long) offset, origin);
+#endif
+}
+
+DLL_EXPORT SLllong sl_file_io_tell(SLvoid user) {
+#ifdef _WIN32
+    return _ftelli64((FILE*) user);
+#elif defined(__linux__) || defined(__APPLE__)
+    return (SLllong) ftello((FILE*) user);
+#else
+    return (SLllong) ftell((FILE*) user);
+#endif
+}
+
+DLL_EXPORT SLullong sl_memory_io_read(SLvoid user, SLvoid dst, SLullong size) {
+    SL_MEMORY_IO* mem = (SL_MEMORY_IO*) user;
+
+    // seeking past the end is allowed so pos can be anywhere
+    if (mem->pos >= mem->size) return 0;
+    if (size > mem->size - mem->pos) size = mem->size - mem->pos;
+
+    memcpy(dst, mem->data + mem->pos, size);
+    mem->pos += size;
+    return size;
+}
+
+DLL_EXPORT SLint sl_memory_io_seek(SLvoid user, SLllong offset, SLint origin) {
+    SL_MEMORY_IO* mem = (SL_MEMORY_IO*) user;
+    SLllong base;
+
+    switch (origin) {
+        case SEEK_SET: base = 0; break;
+        case SEEK_CUR: base = (SLllong) mem->pos; break;
+        case SEEK_END: base = (SLllong) mem->size; break;
+        default: return -1;
+    }
+
+    if (offset < -base) return -1;
+
+    mem->pos = (SLullong) (base + offset);
+    return 0;
+}
+
+DLL_EXPORT SLllong sl_memory_io_tell(SLvoid user) {
+    return (SLllong) ((SL_MEMORY_IO*) user)->pos;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_open_handle_io(SL_HANDLE_IO* handle, SLstr path) {
+    memset(handle, 0, sizeof(SL_HANDLE_IO));
+
+    #ifdef _WIN32
+        LARGE_INTEGER fileSize;
+
+        handle->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (handle->file == INVALID_HANDLE_VALUE) return SL_FILE_ERROR;
+
+        if (!GetFileSizeEx(handle->file, &fileSize)) {
+            CloseHandle(handle->file);
+            return SL_FILE_ERROR;
+        }
+
+        handle->size = (SLullong) fileSize.QuadPart;
+    #elif defined(__linux__) || defined(__APPLE__)
+        struct stat st;
+
+        handle->file = open(path, O_RDONLY);
+        if (handle->file < 0) return SL_FILE_ERROR;
+
+        if (fstat(handle->file, &st) != 0) {
+            close(handle->file);
+            return SL_FILE_ERROR;
+        }
+
+        handle->size = (SLullong) st.st_size;
+    #else
+        return SL_FILE_ERROR;
+    #endif // _WIN32
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_close_handle_io(SL_HANDLE_IO* handle) {
+    #ifdef _WIN32
+        CloseHandle(handle->file);
+    #elif defined(__linux__) || defined(__APPLE__)
+        close(handle->file);
+    #endif // _WIN32
+}
+
+DLL_EXPORT void sl_io_from_handle(SL_IO* io, SL_HANDLE_IO* handle) {
+    io->read = sl_handle_io_read;
+    io->seek = sl_handle_io_seek;
+    io->tell = sl_handle_io_tell;
+    io->user = handle;
+}
+
+DLL_EXPORT SLullong sl_handle_io_read(SLvoid user, SLvoid dst, SLullong size) {
+    SL_HANDLE_IO* handle = (SL_HANDLE_IO*) user;
+    SLuchar* out = (SLuchar*) dst;
+    SLullong done = 0;
+
+    while (done < size) {
+        SLullong n;
+
+        // already have it
+        if (handle->pos >= handle->bufferPos && handle->pos < handle->bufferPos + handle->bufferUsed) {
+            n = handle->bufferPos + handle->bufferUsed - handle->pos;
+            if (n > size - done) n = size - done;
+
+            memcpy(out + done, handle->buffer + (handle->pos - handle->bufferPos), n);
+            handle->pos += n;
+            done += n;
+            continue;
+        }
+
+        // the samples. no point copying those through the buffer
+        if (size - done >= SL_HANDLE_IO_BUFFER_SIZE) {
+            n = sl_read_file_at(handle, out + done, size - done, handle->pos);
+            handle->pos += n;
+            done += n;
+            break;
+        }
+
+        handle->bufferPos = handle->pos;
+        handle->bufferUsed = sl_read_file_at(handle, handle->buffer, SL_HANDLE_IO_BUFFER_SIZE, handle->pos);
+        if (handle->bufferUsed == 0) break;
+    }
+
+    return done;
+}
+
+DLL_EXPORT SLint sl_handle_io_seek(SLvoid user, SLllong offset, SLint origin) {
+    SL_HANDLE_IO* handle = (SL_HANDLE_IO*) user;
+    SLllong base;
+
+    switch (origin) {
+        case SEEK_SET: base = 0; break;
+        case SEEK_CUR: base = (SLllong) handle->pos; break;
+        case SEEK_END: base = (SLllong) handle->size; break;
+        default: return -1;
+    }
+
+    if (base + offset < 0) return -1;
+
+    // like fseek, going past the end is fine. reads there just come back short
+    handle->pos = (SLullong) (base + offset);
+    return 0;
+}
+
+DLL_EXPORT SLllong sl_handle_io_tell(SLvoid user) {
+    return (SLllong) ((SL_HANDLE_IO*) user)->pos;
+}
+
+DLL_EXPORT SLullong sl_read_file_at(SL_HANDLE_IO* handle, SLvoid dst, SLullong size, SLullong offset) {
+    SLuchar* p = (SLuchar*) dst;
+    SLullong done = 0;
+
+    while (done < size) {
+        #ifdef _WIN32
+            // ReadFile takes a DWORD so go a GB at a time
+            DWORD chunk = size - done > 0x40000000 ? 0x40000000 : (DWORD) (size - done);
+            DWORD count = 0;
+            OVERLAPPED at;
+
+            memset(&at, 0, sizeof(OVERLAPPED));
+            at.Offset = (DWORD) (offset + done);
+            at.OffsetHigh = (DWORD) ((offset + done) >> 32);
+
+            if (!ReadFile(handle->file, p + done, chunk, &count, &at) || count == 0) break;
+        #elif defined(__linux__) || defined(__APPLE__)
+            ssize_t count = pread(handle->file, p + done, (size_t) (size - done), (off_t) (offset + done));
+
+            if (count < 0 && errno == EINTR) continue;
+            if (count <= 0) break;
+        #else
+            break;
+        #endif // _WIN32
+
+        done += (SLullong) count;
+    }
+
+    SL_STATS_ADD(bytesRead, done);
+    return done;
+}
+
+DLL_EXPORT void sl_batch_worker(SLvoid arg) {
+    SL_BATCH_JOB* job = (SL_BATCH_JOB*) arg;
+
+    for (;;) {
+        SLullong index;
+
+        sl_mutex_lock(&job->mutex);
+        index = job->next++;
+        sl_mutex_unlock(&job->mutex);
+
+        if (index >= job->count) return;
+
+        // every file has its own buffer so nothing else needs the lock
+        SL_RETURN_CODE ret = sl_read_wave_file(job->paths[index], &job->out[index]);
+        if (job->results != NULL) job->results[index] = ret;
+
+        if (ret != SL_SUCCESS) {
+            sl_mutex_lock(&job->mutex);
+            job->failed++;
+            sl_mutex_unlock(&job->mutex);
+        }
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_map_file(SLstr path, SLvoid* base, SLullong* size) {
+    *base = NULL;
+    *size = 0;
+
+    #ifdef _WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return SL_FILE_ERROR;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return SL_MAP_FAIL;
+        }
+
+        // the view keeps the mapping alive so both handles can be closed right away
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        CloseHandle(file);
+        if (mapping == NULL) return SL_MAP_FAIL;
+
+        *base = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+        if (*base == NULL) return SL_MAP_FAIL;
+
+        *size = (SLullong) fileSize.QuadPart;
+    #elif defined(__linux__) || defined(__APPLE__)
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return SL_FILE_ERROR;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            close(fd);
+            return SL_MAP_FAIL;
+        }
+
+        // private + writable so big endian systems can fix the samples in place without touching the file
+        void* mapping = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) return SL_MAP_FAIL;
+
+        *base = mapping;
+        *size = (SLullong) st.st_size;
+    #else
+        return SL_MAP_FAIL;
+    #endif // _WIN32
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_unmap_file(SLvoid base, SLullong size) {
+    #ifdef _WIN32
+        UnmapViewOfFile(base);
+    #elif defined(__linux__) || defined(__APPLE__)
+        munmap(base, (size_t) size);
+    #endif // _WIN32
+}
+
+DLL_EXPORT void sl_advise_mapping(SLvoid addr, SLullong len, SL_MAP_ADVICE advice) {
+    #if defined(__linux__) || defined(__APPLE__)
+        // madvise wants a page aligned start so round down and grow the length to match
+        uintptr_t pageSize = (uintptr_t) sysconf(_SC_PAGESIZE);
+        uintptr_t start = (uintptr_t) addr & ~(pageSize - 1);
+        len += (uintptr_t) addr - start;
+
+        int flag;
+        switch (advice) {
+            case SL_MAP_ADVICE_SEQUENTIAL: flag = MADV_SEQUENTIAL; break;
+            case SL_MAP_ADVICE_RANDOM: flag = MADV_RANDOM; break;
+            case SL_MAP_ADVICE_WILLNEED: flag = MADV_WILLNEED; break;
+            case SL_MAP_ADVICE_DONTNEED: flag = MADV_DONTNEED; break;
+            default: flag = MADV_NORMAL; break;
+        }
+
+        madvise((void*) start, (size_t) len, flag);
+    #endif // __linux__ || __APPLE__
+}
+
+DLL_EXPORT SLushort sl_buf_to_native_ushort(const SLuchar* buf, SLullong bufLen) {
+    return sl_buf_to_native_ushort_b(buf, bufLen, SL_LITTLE_ENDIAN);
+}
+
+DLL_EXPORT SLuint sl_buf_to_native_uint(const SLuchar* buf, SLullong bufLen) {
+    return sl_buf_to_native_uint_b(buf, bufLen, SL_LITTLE_ENDIAN);
+}
+
+DLL_EXPORT SLushort sl_buf_to_native_ushort_b(const SLuchar* buf, SLullong bufLen, SLuint endianness) {
+    //who needs comments, am i right?
+    if(buf == NULL || bufLen < 2) return 0;
+
+    // shifts work on values not memory, so this is right on any system
+    if(endianness == SL_LITTLE_ENDIAN) return (SLushort) (buf[0] | (buf[1] << 8));
+    return (SLushort) (buf[1] | (buf[0] << 8));
+}
+
+DLL_EXPORT SLuint sl_buf_to_native_uint_b(const SLuchar* buf, SLullong bufLen, SLuint endianness) {
+    if(buf == NULL || bufLen < 4) return 0;
+
+    if(endianness == SL_LITTLE_ENDIAN) return (SLuint) buf[0] | ((SLuint) buf[1] << 8) | ((SLuint) buf[2] << 16) | ((SLuint) buf[3] << 24);
+    return (SLuint) buf[3] | ((SLuint) buf[2] << 8) | ((SLuint) buf[1] << 16) | ((SLuint) buf[0] << 24);
+}
+
+DLL_EXPORT SLshort sl_flip_endian_short(SLshort s) {
+    return (s >> 8) | (s << 8);
+}
+
+DLL_EXPORT SLint sl_flip_endian_int(SLint i) {
+    return ((i >> 24) & 0xff) |
+           ((i << 8) & 0xff0000) |
+           ((i >> 8) & 0xff00) |
+           ((i << 24) & 0xff000000);
+}
+
+DLL_EXPORT SLfloat sl_flip_endian_float(SLfloat f) {
+    // i love c because of this right here
+    unsigned long num_int;
+    memcpy(&num_int, &f, sizeof(float));
+
+    unsigned long swapped_int = ((num_int >> 24) & 0xff) |
+                                ((num_int << 8) & 0xff0000) |
+                                ((num_int >> 8) & 0xff00) |
+                                ((num_int << 24) & 0xff000000);
+    float swapped;
+    memcpy(&swapped, &swapped_int, sizeof(float));
+    return swapped;
+}
+
+DLL_EXPORT SLdouble sl_flip_endian_double(SLdouble d) {
+    // i love c because of this right here
+    uint64_t num_int;
+    memcpy(&num_int, &d, sizeof(double));
+
+    uint64_t swapped_int = ((num_int >> 56) & 0x00000000000000ff) |
+                           ((num_int >> 40) & 0x000000000000ff00) |
+                           ((num_int >> 24) & 0x0000000000ff0000) |
+                           ((num_int >> 8)  & 0x00000000ff000000) |
+                           ((num_int << 8)  & 0x000000ff00000000) |
+                           ((num_int << 24) & 0x0000ff0000000000) |
+                           ((num_int << 40) & 0x00ff000000000000) |
+                           ((num_int << 56) & 0xff00000000000000);
+
+    double swapped;
+    memcpy(&swapped, &swapped_int, sizeof(double));
+    return swapped;
+}
+
+///////////////////////////////////////////////////////////////////////////
+///////////////// Sample Conversion Function Implementations //////////////
+///////////////////////////////////////////////////////////////////////////
+
+// what sl_set_simd_level asked for. -1 means use whatever the CPU has
+static SLint sl_simd_level_cap = -1;
+
+// rounds to the nearest whole number with ties to even, same as cvtps2dq does by default
+DLL_EXPORT static SLint sl_round_float(SLfloat v) {
+    // floats this big have no fraction left
+    if (v >= 8388608.0f || v <= -8388608.0f) return (SLint) v;
+
+    // adding 2^23 pushes the fraction out of the mantissa and the FPU rounds it for us
+    v = v >= 0 ? (v + 8388608.0f) - 8388608.0f : (v - 8388608.0f) + 8388608.0f;
+    return (SLint) v;
+}
+
+// clamps the same way max/min do in SSE so NaN ends up at lo
+DLL_EXPORT static SLfloat sl_clamp_float(SLfloat v, SLfloat lo, SLfloat hi) {
+    if (!(v > lo)) v = lo;
+    if (v > hi) v = hi;
+    return v;
+}
+
+DLL_EXPORT static SLuint sl_xorshift(SLuint* state) {
+    SLuint x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// random bits to a float in [1, 2)
+DLL_EXPORT static SLfloat sl_bits_to_float(SLuint bits) {
+    SLfloat f;
+    bits = (bits >> 9) | 0x3f800000;
+    memcpy(&f, &bits, sizeof(SLfloat));
+    return f;
+}
+
+//////////////////////// scalar loops ////////////////////////
+
+DLL_EXPORT static void sl_decode_u8(const void* src, SLfloat* dst, SLullong count) {
+    const SLuchar* in = (const SLuchar*) src;
+    for (SLullong i = 0; i < count; ++i) dst[i] = (SLfloat) ((SLint) in[i] - 128) * (1.0f / 128.0f);
+}
+
+DLL_EXPORT static void sl_decode_s16(const void* src, SLfloat* dst, SLullong count) {
+    const SLshort* in = (const SLshort*) src;
+    for (SLullong i = 0; i < count; ++i) dst[i] = (SLfloat) in[i] * (1.0f / 32768.0f);
+}
+
+DLL_EXPORT static void sl_decode_s24(const void* src, SLfloat* dst, SLullong count) {
+    const SLuchar* in = (const SLuchar*) src;
+    SLbool little = sl_get_native_endianness() == SL_LITTLE_ENDIAN;
+
+    for (SLullong i = 0; i < count; ++i, in += 3) {
+        // build it in the top 3 bytes and shift back down to get the sign
+        SLuint bits = little ? ((SLuint) in[0] << 8 | (SLuint) in[1] << 16 | (SLuint) in[2] << 24)
+                             : ((SLuint) in[2] << 8 | (SLuint) in[1] << 16 | (SLuint) in[0] << 24);
+        dst[i] = (SLfloat) ((SLint) bits >> 8) * (1.0f / 8388608.0f);
+    }
+}
+
+DLL_EXPORT static void sl_decode_s32(const void* src, SLfloat* dst, SLullong count) {
+    const SLint* in = (const SLint*) src;
+    for (SLullong i = 0; i < count; ++i) dst[i] = (SLfloat) in[i] * (1.0f / 2147483648.0f);
+}
+
+DLL_EXPORT static void sl_decode_f32(const void* src, SLfloat* dst, SLullong count) {
+    memcpy(dst, src, count * sizeof(SLfloat));
+}
+
+DLL_EXPORT static void sl_decode_f64(const void* src, SLfloat* dst, SLullong count) {
+    const SLdouble* in = (const SLdouble*) src;
+    for (SLullong i = 0; i < count; ++i) dst[i] = (SLfloat) in[i];
+}
+
+DLL_EXPORT static void sl_encode_u8(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLuchar* out = (SLuchar*) dst;
+    for (SLullong i = 0; i < count; ++i) {
+        SLfloat v = src[i] * 128.0f;
+        if (noise != NULL) v += noise[i];
+        out[i] = (SLuchar) (sl_round_float(sl_clamp_float(v, -128.0f, 127.0f)) + 128);
+    }
+}
+
+DLL_EXPORT static void sl_encode_s16(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLshort* out = (SLshort*) dst;
+    for (SLullong i = 0; i < count; ++i) {
+        SLfloat v = src[i] * 32768.0f;
+        if (noise != NULL) v += noise[i];
+        out[i] = (SLshort) sl_round_float(sl_clamp_float(v, -32768.0f, 32767.0f));
+    }
+}
+
+DLL_EXPORT static void sl_encode_s24(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLuchar* out = (SLuchar*) dst;
+    SLbool little = sl_get_native_endianness() == SL_LITTLE_ENDIAN;
+
+    for (SLullong i = 0; i < count; ++i, out += 3) {
+        SLfloat v = src[i] * 8388608.0f;
+        if (noise != NULL) v += noise[i];
+
+        SLuint bits = (SLuint) sl_round_float(sl_clamp_float(v, -8388608.0f, 8388607.0f));
+        out[little ? 0 : 2] = (SLuchar) bits;
+        out[1] = (SLuchar) (bits >> 8);
+        out[little ? 2 : 0] = (SLuchar) (bits >> 16);
+    }
+}
+
+DLL_EXPORT static void sl_encode_s32(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLint* out = (SLint*) dst;
+    for (SLullong i = 0; i < count; ++i) {
+        SLfloat v = src[i] * 2147483648.0f;
+        if (noise != NULL) v += noise[i];
+        // 2147483520 is the biggest float under 2^31
+        out[i] = sl_round_float(sl_clamp_float(v, -2147483648.0f, 2147483520.0f));
+    }
+}
+
+DLL_EXPORT static void sl_encode_f32(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    (void) noise;
+    memcpy(dst, src, count * sizeof(SLfloat));
+}
+
+DLL_EXPORT static void sl_encode_f64(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLdouble* out = (SLdouble*) dst;
+    (void) noise;
+    for (SLullong i = 0; i < count; ++i) out[i] = (SLdouble) src[i];
+}
+
+DLL_EXPORT static void sl_tpdf_noise(SLuint* state, SLfloat* dst, SLullong count) {
+    for (SLullong i = 0; i < count; ++i) {
+        // the difference of two uniform numbers has a triangle shaped distribution
+        SLfloat a = sl_bits_to_float(sl_xorshift(&state[i & 7]));
+        SLfloat b = sl_bits_to_float(sl_xorshift(&state[i & 7]));
+        dst[i] = a - b;
+    }
+}
+
+DLL_EXPORT static void sl_swap_bytes(SLvoid data, SLullong count, SLuint size) {
+    SLuchar* p = (SLuchar*) data;
+
+    switch (size) {
+        case 2:
+            for (SLullong i = 0; i < count; ++i, p += 2) {
+                SLuchar t = p[0];
+                p[0] = p[1];
+                p[1] = t;
+            }
+            break;
+        case 3:
+            // the middle byte stays where it is
+            for (SLullong i = 0; i < count; ++i, p += 3) {
+                SLuchar t = p[0];
+                p[0] = p[2];
+                p[2] = t;
+            }
+            break;
+        case 4:
+            for (SLullong i = 0; i < count; ++i, p += 4) {
+                SLuint v;
+                memcpy(&v, p, 4);
+                v = (v >> 24) | ((v >> 8) & 0xff00) | ((v << 8) & 0xff0000) | (v << 24);
+                memcpy(p, &v, 4);
+            }
+            break;
+        case 8:
+            for (SLullong i = 0; i < count; ++i, p += 8) {
+                SLullong v;
+                memcpy(&v, p, 8);
+                v = ((v >> 56) & 0x00000000000000ffULL) | ((v >> 40) & 0x000000000000ff00ULL) |
+                    ((v >> 24) & 0x0000000000ff0000ULL) | ((v >> 8)  & 0x00000000ff000000ULL) |
+                    ((v << 8)  & 0x000000ff00000000ULL) | ((v << 24) & 0x0000ff0000000000ULL) |
+                    ((v << 40) & 0x00ff000000000000ULL) | ((v << 56) & 0xff00000000000000ULL);
+                memcpy(p, &v, 8);
+            }
+            break;
+        default: break;
+    }
+}
+
+DLL_EXPORT static void sl_mix_add(SLfloat* dst, const SLfloat* src, SLfloat gain, SLullong count) {
+    for (SLullong i = 0; i < count; ++i) dst[i] += src[i] * gain;
+}
+
+DLL_EXPORT static void sl_mix_add_mono(SLfloat* dst, const SLfloat* src, SLfloat gain, SLullong count) {
+    for (SLullong i = 0; i < count; ++i) {
+        SLfloat v = src[i] * gain;
+        dst[i * 2] += v;
+        dst[i * 2 + 1] += v;
+    }
+}
+
+DLL_EXPORT static SLfloat sl_dot(const SLfloat* a, const SLfloat* b, SLullong count) {
+    // 8 running sums added up the same way the SIMD versions do, so every level gives the same result
+    SLfloat lanes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    SLfloat sum[4];
+
+    for (SLullong i = 0; i < count; i += 8)
+        for (SLuint k = 0; k < 8; ++k) lanes[k] += a[i + k] * b[i + k];
+
+    for (SLuint k = 0; k < 4; ++k) sum[k] = lanes[k] + lanes[k + 4];
+    return (sum[0] + sum[2]) + (sum[1] + sum[3]);
+}
+
+static const SL_CONVERT_KERNELS sl_scalar_kernels = {
+    {NULL, sl_decode_u8, sl_decode_s16, sl_decode_s24, sl_decode_s32, sl_decode_f32, sl_decode_f64},
+    {NULL, sl_encode_u8, sl_encode_s16, sl_encode_s24, sl_encode_s32, sl_encode_f32, sl_encode_f64},
+    sl_tpdf_noise,
+    sl_swap_bytes,
+    sl_mix_add,
+    sl_mix_add_mono,
+    sl_dot
+};
+
+#ifdef SL_SSE2
+
+//////////////////////// SSE2 loops ////////////////////////
+// every loop does what it can in vectors and leaves the last few samples to the scalar loop
+
+DLL_EXPORT static void sl_decode_u8_sse2(const void* src, SLfloat* dst, SLullong count) {
+    const SLuchar* in = (const SLuchar*) src;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+    SLullong i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*) (in + i));
+        __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(bytes, zero), bias);
+        __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(bytes, zero), bias);
+
+        // putting each short in both halves and shifting right sign extends it
+        _mm_storeu_ps(dst + i,      _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)), scale));
+        _mm_storeu_ps(dst + i + 4,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)), scale));
+        _mm_storeu_ps(dst + i + 8,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)), scale));
+        _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)), scale));
+    }
+
+    sl_decode_u8(in + i, dst + i, count - i);
+}
+
+DLL_EXPORT static void sl_decode_s16_sse2(const void* src, SLfloat* dst, SLullong count) {
+    const SLshort* in = (const SLshort*) src;
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*) (in + i));
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), scale));
+    }
+
+    sl_decode_s16(in + i, dst + i, count - i);
+}
+
+DLL_EXPORT static void sl_decode_s24_sse2(const void* src, SLfloat* dst, SLullong count) {
+    const SLuchar* in = (const SLuchar*) src;
+    const __m128 scale = _mm_set1_ps(1.0f / 8388608.0f);
+    SLullong i = 0;
+
+    // each sample is read as 4 bytes so the last one in a group reads into the next sample. stop one sample early
+    for (; i + 5 <= count; i += 4) {
+        const SLuchar* p = in + i * 3;
+        SLint w0, w1, w2, w3;
+        memcpy(&w0, p, 4);
+        memcpy(&w1, p + 3, 4);
+        memcpy(&w2, p + 6, 4);
+        memcpy(&w3, p + 9, 4);
+
+        __m128i v = _mm_set_epi32(w3, w2, w1, w0);
+        v = _mm_srai_epi32(_mm_slli_epi32(v, 8), 8);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+
+    sl_decode_s24(in + i * 3, dst + i, count - i);
+}
+
+DLL_EXPORT static void sl_decode_s32_sse2(const void* src, SLfloat* dst, SLullong count) {
+    const SLint* in = (const SLint*) src;
+    const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+    SLullong i = 0;
+
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) (in + i))), scale));
+
+    sl_decode_s32(in + i, dst + i, count - i);
+}
+
+DLL_EXPORT static void sl_decode_f64_sse2(const void* src, SLfloat* dst, SLullong count) {
+    const SLdouble* in = (const SLdouble*) src;
+    SLullong i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+        __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+        _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+    }
+
+    sl_decode_f64(in + i, dst + i, count - i);
+}
+
+// scales, dithers, clamps and rounds 4 samples
+DLL_EXPORT static __m128i sl_encode_int_sse2(const SLfloat* src, const SLfloat* noise, __m128 scale, __m128 lo, __m128 hi) {
+    __m128 v = _mm_mul_ps(_mm_loadu_ps(src), scale);
+    if (noise != NULL) v = _mm_add_ps(v, _mm_loadu_ps(noise));
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, lo), hi));
+}
+
+DLL_EXPORT static void sl_encode_u8_sse2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLuchar* out = (SLuchar*) dst;
+    const __m128 scale = _mm_set1_ps(128.0f);
+    const __m128 lo = _mm_set1_ps(-128.0f);
+    const __m128 hi = _mm_set1_ps(127.0f);
+    const __m128i bias = _mm_set1_epi16(128);
+    SLullong i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const SLfloat* n = noise != NULL ? noise + i : NULL;
+        __m128i a = sl_encode_int_sse2(src + i,      n,              scale, lo, hi);
+        __m128i b = sl_encode_int_sse2(src + i + 4,  n ? n + 4 : n,  scale, lo, hi);
+        __m128i c = sl_encode_int_sse2(src + i + 8,  n ? n + 8 : n,  scale, lo, hi);
+        __m128i d = sl_encode_int_sse2(src + i + 12, n ? n + 12 : n, scale, lo, hi);
+
+        // already clamped so the saturation in the packs never kicks in
+        __m128i ab = _mm_add_epi16(_mm_packs_epi32(a, b), bias);
+        __m128i cd = _mm_add_epi16(_mm_packs_epi32(c, d), bias);
+        _mm_storeu_si128((__m128i*) (out + i), _mm_packus_epi16(ab, cd));
+    }
+
+    sl_encode_u8(src + i, noise != NULL ? noise + i : NULL, out + i, count - i);
+}
+
+DLL_EXPORT static void sl_encode_s16_sse2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLshort* out = (SLshort*) dst;
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const SLfloat* n = noise != NULL ? noise + i : NULL;
+        __m128i a = sl_encode_int_sse2(src + i,     n,             scale, lo, hi);
+        __m128i b = sl_encode_int_sse2(src + i + 4, n ? n + 4 : n, scale, lo, hi);
+        _mm_storeu_si128((__m128i*) (out + i), _mm_packs_epi32(a, b));
+    }
+
+    sl_encode_s16(src + i, noise != NULL ? noise + i : NULL, out + i, count - i);
+}
+
+DLL_EXPORT static void sl_encode_s24_sse2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLuchar* out = (SLuchar*) dst;
+    const __m128 scale = _mm_set1_ps(8388608.0f);
+    const __m128 lo = _mm_set1_ps(-8388608.0f);
+    const __m128 hi = _mm_set1_ps(8388607.0f);
+    SLullong i = 0;
+
+    // SSE2 can't shuffle bytes so the math is vectorized and the 3 byte stores are not
+    for (; i + 4 <= count; i += 4) {
+        SLint words[4];
+        _mm_storeu_si128((__m128i*) words, sl_encode_int_sse2(src + i, noise != NULL ? noise + i : NULL, scale, lo, hi));
+
+        for (SLuint k = 0; k < 4; ++k) {
+            SLuchar* p = out + (i + k) * 3;
+            p[0] = (SLuchar) words[k];
+            p[1] = (SLuchar) (words[k] >> 8);
+            p[2] = (SLuchar) (words[k] >> 16);
+        }
+    }
+
+    sl_encode_s24(src + i, noise != NULL ? noise + i : NULL, out + i * 3, count - i);
+}
+
+DLL_EXPORT static void sl_encode_s32_sse2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLint* out = (SLint*) dst;
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    const __m128 lo = _mm_set1_ps(-2147483648.0f);
+    const __m128 hi = _mm_set1_ps(2147483520.0f);
+    SLullong i = 0;
+
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i*) (out + i), sl_encode_int_sse2(src + i, noise != NULL ? noise + i : NULL, scale, lo, hi));
+
+    sl_encode_s32(src + i, noise != NULL ? noise + i : NULL, out + i, count - i);
+}
+
+DLL_EXPORT static void sl_encode_f64_sse2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLdouble* out = (SLdouble*) dst;
+    SLullong i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(src + i);
+        _mm_storeu_pd(out + i,     _mm_cvtps_pd(v));
+        _mm_storeu_pd(out + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    }
+
+    sl_encode_f64(src + i, noise, out + i, count - i);
+}
+
+DLL_EXPORT static __m128i sl_xorshift_sse2(__m128i x) {
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+DLL_EXPORT static void sl_tpdf_noise_sse2(SLuint* state, SLfloat* dst, SLullong count) {
+    const __m128i one = _mm_set1_epi32(0x3f800000);
+    // sample i comes from lane i & 7 like the plain loop, so the 8 lanes are split over two registers
+    __m128i lo = _mm_loadu_si128((const __m128i*) state);
+    __m128i hi = _mm_loadu_si128((const __m128i*) (state + 4));
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        lo = sl_xorshift_sse2(lo);
+        hi = sl_xorshift_sse2(hi);
+        __m128 aLo = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(lo, 9), one));
+        __m128 aHi = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(hi, 9), one));
+        lo = sl_xorshift_sse2(lo);
+        hi = sl_xorshift_sse2(hi);
+        __m128 bLo = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(lo, 9), one));
+        __m128 bHi = _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(hi, 9), one));
+        _mm_storeu_ps(dst + i, _mm_sub_ps(aLo, bLo));
+        _mm_storeu_ps(dst + i + 4, _mm_sub_ps(aHi, bHi));
+    }
+
+    _mm_storeu_si128((__m128i*) state, lo);
+    _mm_storeu_si128((__m128i*) (state + 4), hi);
+    sl_tpdf_noise(state, dst + i, count - i);
+}
+
+// swaps the two bytes of every short
+DLL_EXPORT static __m128i sl_swap16_sse2(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+DLL_EXPORT static void sl_swap_bytes_sse2(SLvoid data, SLullong count, SLuint size) {
+    SLuchar* p = (SLuchar*) data;
+    SLullong perVector = size == 3 ? 0 : 16 / size;
+    SLullong i = 0;
+
+    // SSE2 has no byte shuffle. 16, 32 and 64 bits are built from short swaps plus word shuffles, 24 bits stays scalar
+    if (perVector != 0) {
+        for (; i + perVector <= count; i += perVector) {
+            __m128i v = _mm_loadu_si128((const __m128i*) (p + i * size));
+
+            if (size == 8) v = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+            if (size >= 4) v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+
+            _mm_storeu_si128((__m128i*) (p + i * size), sl_swap16_sse2(v));
+        }
+    }
+
+    sl_swap_bytes(p + i * size, count - i, size);
+}
+
+DLL_EXPORT static void sl_mix_add_sse2(SLfloat* dst, const SLfloat* src, SLfloat gain, SLullong count) {
+    __m128 g = _mm_set1_ps(gain);
+    SLullong i = 0;
+
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+
+    sl_mix_add(dst + i, src + i, gain, count - i);
+}
+
+DLL_EXPORT static void sl_mix_add_mono_sse2(SLfloat* dst, const SLfloat* src, SLfloat gain, SLullong count) {
+    __m128 g = _mm_set1_ps(gain);
+    SLullong i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), g);
+        SLfloat* out = dst + i * 2;
+
+        // each mono sample goes to both channels of its frame
+        _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_unpacklo_ps(v, v)));
+        _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(v, v)));
+    }
+
+    sl_mix_add_mono(dst + i * 2, src + i, gain, count - i);
+}
+
+DLL_EXPORT static SLfloat sl_dot_sse2(const SLfloat* a, const SLfloat* b, SLullong count) {
+    __m128 lo = _mm_setzero_ps();
+    __m128 hi = _mm_setzero_ps();
+    __m128 sum;
+
+    for (SLullong i = 0; i < count; i += 8) {
+        lo = _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        hi = _mm_add_ps(hi, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+
+    sum = _mm_add_ps(lo, hi);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+static const SL_CONVERT_KERNELS sl_sse2_kernels = {
+    {NULL, sl_decode_u8_sse2, sl_decode_s16_sse2, sl_decode_s24_sse2, sl_decode_s32_sse2, sl_decode_f32, sl_decode_f64_sse2},
+    {NULL, sl_encode_u8_sse2, sl_encode_s16_sse2, sl_encode_s24_sse2, sl_encode_s32_sse2, sl_encode_f32, sl_encode_f64_sse2},
+    sl_tpdf_noise_sse2,
+    sl_swap_bytes_sse2,
+    sl_mix_add_sse2,
+    sl_mix_add_mono_sse2,
+    sl_dot_sse2
+};
+
+#endif // SL_SSE2
+
+#ifdef SL_AVX2
+
+//////////////////////// AVX2 loops ////////////////////////
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_decode_u8_avx2(const void* src, SLfloat* dst, SLullong count) {
+    const SLuchar* in = (const SLuchar*) src;
+    const __m256i bias = _mm256_set1_epi32(128);
+    const __m256 scale = _mm256_set1_ps(1.0f / 128.0f);
+    SLullong i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*) (in + i));
+        __m256i lo = _mm256_sub_epi32(_mm256_cvtepu8_epi32(bytes), bias);
+        __m256i hi = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), bias);
+        _mm256_storeu_ps(dst + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+
+    sl_decode_u8(in + i, dst + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_decode_s16_avx2(const void* src, SLfloat* dst, SLullong count) {
+    const SLshort* in = (const SLshort*) src;
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    SLullong i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) (in + i)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) (in + i + 8)));
+        _mm256_storeu_ps(dst + i,     _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+
+    sl_decode_s16(in + i, dst + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_decode_s24_avx2(const void* src, SLfloat* dst, SLullong count) {
+    const SLuchar* in = (const SLuchar*) src;
+    const __m256 scale = _mm256_set1_ps(1.0f / 8388608.0f);
+    // moves the 3 bytes of each sample to the top of its int. -1 zeroes the low byte
+    const __m256i spread = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    SLullong i = 0;
+
+    // the second load reads 4 bytes past the 8 samples, so keep 2 samples of room
+    for (; i + 10 <= count; i += 8) {
+        const SLuchar* p = in + i * 3;
+        __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) p)),
+                                            _mm_loadu_si128((const __m128i*) (p + 12)), 1);
+        v = _mm256_srai_epi32(_mm256_shuffle_epi8(v, spread), 8);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+
+    sl_decode_s24(in + i * 3, dst + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_decode_s32_avx2(const void* src, SLfloat* dst, SLullong count) {
+    const SLint* in = (const SLint*) src;
+    const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*) (in + i))), scale));
+
+    sl_decode_s32(in + i, dst + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_decode_f64_avx2(const void* src, SLfloat* dst, SLullong count) {
+    const SLdouble* in = (const SLdouble*) src;
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128 lo = _mm256_cvtpd_ps(_mm256_loadu_pd(in + i));
+        __m128 hi = _mm256_cvtpd_ps(_mm256_loadu_pd(in + i + 4));
+        _mm256_storeu_ps(dst + i, _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1));
+    }
+
+    sl_decode_f64(in + i, dst + i, count - i);
+}
+
+// scales, dithers, clamps and rounds 8 samples
+DLL_EXPORT static SL_TARGET_AVX2 __m256i sl_encode_int_avx2(const SLfloat* src, const SLfloat* noise, __m256 scale, __m256 lo, __m256 hi) {
+    __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src), scale);
+    if (noise != NULL) v = _mm256_add_ps(v, _mm256_loadu_ps(noise));
+    return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, lo), hi));
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_encode_u8_avx2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLuchar* out = (SLuchar*) dst;
+    const __m256 scale = _mm256_set1_ps(128.0f);
+    const __m256 lo = _mm256_set1_ps(-128.0f);
+    const __m256 hi = _mm256_set1_ps(127.0f);
+    const __m256i bias = _mm256_set1_epi16(128);
+    SLullong i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const SLfloat* n = noise != NULL ? noise + i : NULL;
+        __m256i a = sl_encode_int_avx2(src + i,     n,             scale, lo, hi);
+        __m256i b = sl_encode_int_avx2(src + i + 8, n ? n + 8 : n, scale, lo, hi);
+
+        // packs works inside each 128 bit lane, the permute puts the samples back in order
+        __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+        words = _mm256_add_epi16(words, bias);
+        _mm_storeu_si128((__m128i*) (out + i), _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1)));
+    }
+
+    sl_encode_u8(src + i, noise != NULL ? noise + i : NULL, out + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_encode_s16_avx2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLshort* out = (SLshort*) dst;
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    SLullong i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const SLfloat* n = noise != NULL ? noise + i : NULL;
+        __m256i a = sl_encode_int_avx2(src + i,     n,             scale, lo, hi);
+        __m256i b = sl_encode_int_avx2(src + i + 8, n ? n + 8 : n, scale, lo, hi);
+        _mm256_storeu_si256((__m256i*) (out + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8));
+    }
+
+    sl_encode_s16(src + i, noise != NULL ? noise + i : NULL, out + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_encode_s24_avx2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLuchar* out = (SLuchar*) dst;
+    const __m256 scale = _mm256_set1_ps(8388608.0f);
+    const __m256 lo = _mm256_set1_ps(-8388608.0f);
+    const __m256 hi = _mm256_set1_ps(8388607.0f);
+    // packs the low 3 bytes of each int into the first 12 bytes of each lane
+    const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                          0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    SLullong i = 0;
+
+    // each lane is stored as 16 bytes and the next store covers the 4 extra, so keep 2 samples of room at the end
+    for (; i + 10 <= count; i += 8) {
+        SLuchar* p = out + i * 3;
+        __m256i v = _mm256_shuffle_epi8(sl_encode_int_avx2(src + i, noise != NULL ? noise + i : NULL, scale, lo, hi), pack);
+        _mm_storeu_si128((__m128i*) p, _mm256_castsi256_si128(v));
+        _mm_storeu_si128((__m128i*) (p + 12), _mm256_extracti128_si256(v, 1));
+    }
+
+    sl_encode_s24(src + i, noise != NULL ? noise + i : NULL, out + i * 3, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_encode_s32_avx2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLint* out = (SLint*) dst;
+    const __m256 scale = _mm256_set1_ps(2147483648.0f);
+    const __m256 lo = _mm256_set1_ps(-2147483648.0f);
+    const __m256 hi = _mm256_set1_ps(2147483520.0f);
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_si256((__m256i*) (out + i), sl_encode_int_avx2(src + i, noise != NULL ? noise + i : NULL, scale, lo, hi));
+
+    sl_encode_s32(src + i, noise != NULL ? noise + i : NULL, out + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_encode_f64_avx2(const SLfloat* src, const SLfloat* noise, SLvoid dst, SLullong count) {
+    SLdouble* out = (SLdouble*) dst;
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_pd(out + i,     _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+        _mm256_storeu_pd(out + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(src + i + 4)));
+    }
+
+    sl_encode_f64(src + i, noise, out + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 __m256i sl_xorshift_avx2(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    return _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_tpdf_noise_avx2(SLuint* state, SLfloat* dst, SLullong count) {
+    const __m256i one = _mm256_set1_epi32(0x3f800000);
+    __m256i s = _mm256_loadu_si256((const __m256i*) state);
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        s = sl_xorshift_avx2(s);
+        __m256 a = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(s, 9), one));
+        s = sl_xorshift_avx2(s);
+        __m256 b = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(s, 9), one));
+        _mm256_storeu_ps(dst + i, _mm256_sub_ps(a, b));
+    }
+
+    _mm256_storeu_si256((__m256i*) state, s);
+    sl_tpdf_noise(state, dst + i, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_swap_bytes_avx2(SLvoid data, SLullong count, SLuint size) {
+    SLuchar* p = (SLuchar*) data;
+    SLullong i = 0;
+
+    if (size == 3) {
+        // 4 samples are 12 bytes. the last 4 bytes of each 16 byte lane are put back as they were
+        const __m256i reverse = _mm256_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15,
+                                                 2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 12, 13, 14, 15);
+
+        // both loads happen before the stores, so writing back the untouched bytes doesn't hurt. keep 2 samples of room
+        for (; i + 10 <= count; i += 8) {
+            SLuchar* q = p + i * 3;
+            __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) q)),
+                                                _mm_loadu_si128((const __m128i*) (q + 12)), 1);
+            v = _mm256_shuffle_epi8(v, reverse);
+            _mm_storeu_si128((__m128i*) q, _mm256_castsi256_si128(v));
+            _mm_storeu_si128((__m128i*) (q + 12), _mm256_extracti128_si256(v, 1));
+        }
+    } else if (size == 2 || size == 4 || size == 8) {
+        __m256i reverse;
+        SLullong perVector = 32 / size;
+
+        if (size == 2) reverse = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                  1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        else if (size == 4) reverse = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                       3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        else reverse = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+        for (; i + perVector <= count; i += perVector) {
+            __m256i* q = (__m256i*) (p + i * size);
+            _mm256_storeu_si256(q, _mm256_shuffle_epi8(_mm256_loadu_si256(q), reverse));
+        }
+    }
+
+    sl_swap_bytes(p + i * size, count - i, size);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_mix_add_avx2(SLfloat* dst, const SLfloat* src, SLfloat gain, SLullong count) {
+    __m256 g = _mm256_set1_ps(gain);
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+
+    sl_mix_add(dst + i, src + i, gain, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 void sl_mix_add_mono_avx2(SLfloat* dst, const SLfloat* src, SLfloat gain, SLullong count) {
+    __m256 g = _mm256_set1_ps(gain);
+    SLullong i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), g);
+        // unpack works per 128 bit lane, so put the lanes back in order afterwards
+        __m256 lo = _mm256_unpacklo_ps(v, v);
+        __m256 hi = _mm256_unpackhi_ps(v, v);
+        SLfloat* out = dst + i * 2;
+
+        _mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_permute2f128_ps(lo, hi, 0x20)));
+        _mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), _mm256_permute2f128_ps(lo, hi, 0x31)));
+    }
+
+    sl_mix_add_mono(dst + i * 2, src + i, gain, count - i);
+}
+
+DLL_EXPORT static SL_TARGET_AVX2 SLfloat sl_dot_avx2(const SLfloat* a, const SLfloat* b, SLullong count) {
+    __m256 lanes = _mm256_setzero_ps();
+    __m128 sum;
+
+    for (SLullong i = 0; i < count; i += 8)
+        lanes = _mm256_add_ps(lanes, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+
+    sum = _mm_add_ps(_mm256_castps256_ps128(lanes), _mm256_extractf128_ps(lanes, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+static const SL_CONVERT_KERNELS sl_avx2_kernels = {
+    {NULL, sl_decode_u8_avx2, sl_decode_s16_avx2, sl_decode_s24_avx2, sl_decode_s32_avx2, sl_decode_f32, sl_decode_f64_avx2},
+    {NULL, sl_encode_u8_avx2, sl_encode_s16_avx2, sl_encode_s24_avx2, sl_encode_s32_avx2, sl_encode_f32, sl_encode_f64_avx2},
+    sl_tpdf_noise_avx2,
+    sl_swap_bytes_avx2,
+    sl_mix_add_avx2,
+    sl_mix_add_mono_avx2,
+    sl_dot_avx2
+};
+
+#endif // SL_AVX2
+
+//////////////////////// dispatch ////////////////////////
+
+DLL_EXPORT SLuint sl_detect_simd_level(void) {
+    #if defined(SL_AVX2) && defined(__GNUC__)
+        if (__builtin_cpu_supports("avx2")) return SL_SIMD_AVX2;
+    #elif defined(SL_AVX2) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] >= 7) {
+            __cpuid(info, 1);
+            // the OS has to save the ymm registers too (OSXSAVE + AVX, then XCR0)
+            if ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6) {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5)) return SL_SIMD_AVX2;
+            }
+        }
+    #endif
+
+    #ifdef SL_SSE2
+        return SL_SIMD_SSE2;
+    #else
+        return SL_SIMD_SCALAR;
+    #endif // SL_SSE2
+}
+
+DLL_EXPORT SLuint sl_get_simd_level(void) {
+    SLuint level = sl_detect_simd_level();
+    if (sl_simd_level_cap >= 0 && (SLuint) sl_simd_level_cap < level) level = (SLuint) sl_simd_level_cap;
+    return level;
+}
+
+DLL_EXPORT void sl_set_simd_level(SLint level) {
+    sl_simd_level_cap = level < 0 ? -1 : level;
+}
+
+DLL_EXPORT const SL_CONVERT_KERNELS* sl_get_convert_kernels(void) {
+    switch (sl_get_simd_level()) {
+        #ifdef SL_AVX2
+        case SL_SIMD_AVX2: return &sl_avx2_kernels;
+        #endif // SL_AVX2
+        #ifdef SL_SSE2
+        case SL_SIMD_SSE2: return &sl_sse2_kernels;
+        #endif // SL_SSE2
+        default: return &sl_scalar_kernels;
+    }
+}
+
+DLL_EXPORT SLuint sl_pcm_type_size(SLuint pcmType) {
+    switch (pcmType) {
+        case SL_UNSIGNED_8PCM: return 1;
+        case SL_SIGNED_16PCM: return 2;
+        case SL_SIGNED_24PCM: return 3;
+        case SL_SIGNED_32PCM: return 4;
+        case SL_FLOAT_32PCM: return 4;
+        case SL_FLOAT_64PCM: return 8;
+        default: return 0;
+    }
+}
+
+// how many bits of precision a type really has. used to tell if a conversion throws bits away
+DLL_EXPORT static SLuint sl_pcm_type_precision(SLuint pcmType) {
+    switch (pcmType) {
+        case SL_UNSIGNED_8PCM: return 8;
+        case SL_SIGNED_16PCM: return 16;
+        case SL_SIGNED_24PCM: return 24;
+        case SL_SIGNED_32PCM: return 32;
+        case SL_FLOAT_32PCM: return 24;
+        case SL_FLOAT_64PCM: return 53;
+        default: return 0;
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_convert_samples(const void* src, SLuint srcType, SLvoid dst, SLuint dstType, SLullong frameCount, SLuint channels, SLuint flags) {
+    SLfloat block[SL_CONVERT_BLOCK];
+    SLfloat noise[SL_CONVERT_BLOCK];
+    SLuchar staging[SL_CONVERT_BLOCK * sizeof(SLdouble)];
+    SLuint state[8];
+    const SL_CONVERT_KERNELS* kernels;
+    const SLuchar* in = (const SLuchar*) src;
+    SLuint srcSize = sl_pcm_type_size(srcType);
+    SLuint dstSize = sl_pcm_type_size(dstType);
+    SLullong total = frameCount * channels;
+    SLullong count;
+    SLbool planar = (flags & SL_CONVERT_PLANAR) && channels > 1;
+    SLbool dither;
+    SLbool wide;
+
+    if (src == NULL || dst == NULL || channels == 0 || srcSize == 0 || dstSize == 0)
+        return SL_INVALID_VALUE;
+
+    // nothing to convert, just copy or deinterleave
+    if (srcType == dstType) {
+        if (planar) sl_scatter_planar(in, (SLuchar*) dst, 0, total, channels, frameCount, dstSize);
+        else memcpy(dst, src, total * dstSize);
+        return SL_SUCCESS;
+    }
+
+    // a float only holds 24 bits, which is not enough between these two
+    wide = (srcType == SL_SIGNED_32PCM && dstType == SL_FLOAT_64PCM) || (srcType == SL_FLOAT_64PCM && dstType == SL_SIGNED_32PCM);
+
+    dither = (flags & SL_CONVERT_DITHER) && dstType != SL_FLOAT_32PCM && dstType != SL_FLOAT_64PCM &&
+             sl_pcm_type_precision(dstType) < sl_pcm_type_precision(srcType);
+
+    kernels = sl_get_convert_kernels();
+
+    if (dither) {
+        SLuint seed = (SLuint) (uintptr_t) dst ^ (SLuint) (sl_get_time() * 1000000.0);
+        for (SLuint k = 0; k < 8; ++k) {
+            seed = seed * 1664525u + 1013904223u;
+            state[k] = seed | 1; // xorshift gets stuck on 0
+        }
+    }
+
+    for (SLullong done = 0; done < total; done += count) {
+        SLuchar* out = planar ? staging : (SLuchar*) dst + done * dstSize;
+        count = total - done < SL_CONVERT_BLOCK ? total - done : SL_CONVERT_BLOCK;
+
+        if (dither) kernels->noise(state, noise, count);
+
+        if (wide) {
+            sl_convert_block_double(in + done * srcSize, srcType, out, dither ? noise : NULL, count);
+        } else {
+            kernels->decode[srcType](in + done * srcSize, block, count);
+            kernels->encode[dstType](block, dither ? noise : NULL, out, count);
+        }
+
+        if (planar) sl_scatter_planar(staging, (SLuchar*) dst, done, count, channels, frameCount, dstSize);
+    }
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_convert_wave_data(const SL_WAV_FILE* wavBuf, SLuint pcmType, SLvoid dst, SLuint flags) {
+    if (wavBuf == NULL || wavBuf->dataChunk.waveformData == NULL) return SL_INVALID_VALUE;
+
+    SLuint channels = wavBuf->formatChunk.numChannels;
+
+    if (wavBuf->dataChunk.pcmType == SL_IMA_ADPCM) {
+        SLshort decoded[SL_CONVERT_BLOCK];
+        SL_ADPCM_DECODER decoder;
+        SLullong frameCount = sl_wave_frame_count(wavBuf);
+        SLullong step = SL_CONVERT_BLOCK / channels;
+        SLuint dstSize = sl_pcm_type_size(pcmType);
+
+        if (dstSize == 0 || ((flags & SL_CONVERT_PLANAR) && channels > 1)) return SL_INVALID_VALUE;
+        if (pcmType == SL_SIGNED_16PCM) return sl_decode_adpcm(wavBuf, NULL, 0, (SLshort*) dst, frameCount) == frameCount ? SL_SUCCESS : SL_INVALID_CHUNK_DATA_DATA;
+
+        // decode a piece at a time so the 16 bit copy never has to exist all at once
+        memset(&decoder, 0, sizeof(SL_ADPCM_DECODER));
+        for (SLullong frame = 0; frame < frameCount; frame += step) {
+            SLullong n = frameCount - frame < step ? frameCount - frame : step;
+            SL_RETURN_CODE ret;
+
+            if (sl_decode_adpcm(wavBuf, &decoder, frame, decoded, n) != n) return SL_INVALID_CHUNK_DATA_DATA;
+            ret = sl_convert_samples(decoded, SL_SIGNED_16PCM, (SLuchar*) dst + frame * channels * dstSize, pcmType, n, channels, flags);
+            if (ret != SL_SUCCESS) return ret;
+        }
+        return SL_SUCCESS;
+    }
+
+    SLuint size = sl_pcm_type_size(wavBuf->dataChunk.pcmType);
+    if (channels == 0 || size == 0) return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+
+    SLullong frameCount = wavBuf->dataChunk.dataChunkSize / ((SLullong) size * channels);
+    return sl_convert_samples(wavBuf->dataChunk.waveformData, wavBuf->dataChunk.pcmType, dst, pcmType, frameCount, channels, flags);
+}
+
+// how far each 4 bit code moves the predictor, and how the step size changes after it. straight from the IMA ADPCM spec
+static const SLshort sl_ima_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060,
+    1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+    7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const SLchar sl_ima_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+DLL_EXPORT SLullong sl_wave_frame_count(const SL_WAV_FILE* wavBuf) {
+    SLuint channels = wavBuf->formatChunk.numChannels;
+    SLullong size = wavBuf->dataChunk.dataChunkSize;
+
+    if (channels == 0) return 0;
+
+    if (wavBuf->dataChunk.pcmType == SL_IMA_ADPCM) {
+        SLullong blockAlign = wavBuf->formatChunk.blockAlign;
+        SLullong frames = (size / blockAlign) * wavBuf->formatChunk.samplesPerBlock;
+        SLullong rest = size % blockAlign;
+
+        // a short last block has as many frames as its bytes hold
+        if (rest >= 4 * channels) {
+            SLullong last = (rest - 4 * channels) / (4 * channels) * 8 + 1;
+            frames += last < wavBuf->formatChunk.samplesPerBlock ? last : wavBuf->formatChunk.samplesPerBlock;
+        }
+        return frames;
+    }
+
+    if (sl_pcm_type_size(wavBuf->dataChunk.pcmType) == 0) return 0;
+    return size / ((SLullong) sl_pcm_type_size(wavBuf->dataChunk.pcmType) * channels);
+}
+
+DLL_EXPORT SLullong sl_decode_adpcm(const SL_WAV_FILE* wavBuf, SL_ADPCM_DECODER* decoder, SLullong firstFrame, SLshort* out, SLullong frameCount) {
+    SL_ADPCM_DECODER local;
+    const SLuchar* block;
+    SLuint channels, samplesPerBlock, pos;
+    SLullong frames, blockStart, end;
+
+    if (wavBuf == NULL || out == NULL || wavBuf->dataChunk.pcmType != SL_IMA_ADPCM || wavBuf->dataChunk.waveformData == NULL) return 0;
+
+    channels = wavBuf->formatChunk.numChannels;
+    samplesPerBlock = wavBuf->formatChunk.samplesPerBlock;
+    frames = sl_wave_frame_count(wavBuf);
+    if (firstFrame >= frames) return 0;
+    if (frameCount > frames - firstFrame) frameCount = frames - firstFrame;
+    end = firstFrame + frameCount;
+
+    if (decoder == NULL) {
+        memset(&local, 0, sizeof(SL_ADPCM_DECODER));
+        decoder = &local;
+    }
+
+    // the predictors only carry on from where the decoder is if that is in the same block and not past the first frame
+    blockStart = firstFrame - firstFrame % samplesPerBlock;
+    if (decoder->frame < blockStart || decoder->frame > firstFrame) decoder->frame = blockStart;
+
+    block = (const SLuchar*) wavBuf->dataChunk.waveformData + (decoder->frame / samplesPerBlock) * wavBuf->formatChunk.blockAlign;
+    pos = (SLuint) (decoder->frame % samplesPerBlock);
+
+    for (SLullong frame = decoder->frame; frame < end; ++frame) {
+        if (pos == 0) {
+            // each channel's block header is its first sample and where it is in the step table
+            for (SLuint c = 0; c < channels; ++c) {
+                const SLuchar* header = block + 4 * c;
+                decoder->predictor[c] = (SLshort) (header[0] | (header[1] << 8));
+                decoder->index[c] = header[2] > 88 ? 88 : header[2];
+            }
+        } else {
+            // 8 frames live in 4 bytes per channel, low nibble first
+            SLuint i = pos - 1;
+            const SLuchar* group = block + 4 * channels * (1 + i / 8) + (i % 8) / 2;
+            SLuint shift = (i & 1) * 4;
+
+            for (SLuint c = 0; c < channels; ++c)
+                sl_ima_decode_nibble(&decoder->predictor[c], &decoder->index[c], (group[4 * c] >> shift) & 15);
+        }
+
+        if (frame >= firstFrame) {
+            SLshort* dst = out + (frame - firstFrame) * channels;
+            for (SLuint c = 0; c < channels; ++c) dst[c] = (SLshort) decoder->predictor[c];
+        }
+
+        if (++pos == samplesPerBlock) {
+            pos = 0;
+            block += wavBuf->formatChunk.blockAlign;
+        }
+    }
+
+    decoder->frame = end;
+    return frameCount;
+}
+
+DLL_EXPORT void sl_ima_decode_nibble(SLint* predictor, SLint* index, SLuint nibble) {
+    SLint step = sl_ima_step_table[*index];
+    SLint diff = step >> 3;
+
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+
+    *predictor += (nibble & 8) ? -diff : diff;
+    if (*predictor > 32767) *predictor = 32767;
+    else if (*predictor < -32768) *predictor = -32768;
+
+    *index += sl_ima_index_table[nibble];
+    if (*index < 0) *index = 0;
+    else if (*index > 88) *index = 88;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_decompress_wave_file(SL_WAV_FILE* wavBuf) {
+    SLullong frames, size;
+    SLshort* decoded;
+    SLushort channels;
+
+    if (wavBuf == NULL) return SL_INVALID_VALUE;
+    if (wavBuf->dataChunk.pcmType != SL_IMA_ADPCM) return SL_SUCCESS;
+
+    channels = wavBuf->formatChunk.numChannels;
+    frames = sl_wave_frame_count(wavBuf);
+    size = frames * channels * sizeof(SLshort);
+    if (size == 0 || size > 0xFFFFFFFFULL) return SL_INVALID_CHUNK_DATA_SIZE;
+
+    decoded = (SLshort*) sl_aligned_malloc(size);
+    if (decoded == NULL) return SL_MALLOC_FAIL;
+
+    sl_decode_adpcm(wavBuf, NULL, 0, decoded, frames);
+
+    // let go of the compressed samples the same way sl_cleanup_wave_file would
+    sl_cleanup_wave_file(wavBuf);
+
+    wavBuf->dataChunk.waveformData = decoded;
+    wavBuf->dataChunk.dataChunkSize = (SLuint) size;
+    wavBuf->dataChunk.pcmType = SL_SIGNED_16PCM;
+    wavBuf->storage = SL_STORAGE_OWNED;
+
+    wavBuf->formatChunk.audioFormat = 1;
+    wavBuf->formatChunk.bitsPerSample = 16;
+    wavBuf->formatChunk.blockAlign = (SLushort) (channels * sizeof(SLshort));
+    wavBuf->formatChunk.byteRate = wavBuf->formatChunk.sampleRate * wavBuf->formatChunk.blockAlign;
+    wavBuf->formatChunk.samplesPerBlock = 0;
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_convert_block_double(const void* src, SLuint srcType, SLvoid dst, const SLfloat* noise, SLullong count) {
+    if (srcType == SL_SIGNED_32PCM) {
+        const SLint* in = (const SLint*) src;
+        SLdouble* out = (SLdouble*) dst;
+        for (SLullong i = 0; i < count; ++i) out[i] = (SLdouble) in[i] * (1.0 / 2147483648.0);
+    } else {
+        const SLdouble* in = (const SLdouble*) src;
+        SLint* out = (SLint*) dst;
+        for (SLullong i = 0; i < count; ++i) {
+            SLdouble v = in[i] * 2147483648.0;
+            if (noise != NULL) v += noise[i];
+            if (!(v > -2147483648.0)) v = -2147483648.0;
+            if (v > 2147483647.0) v = 2147483647.0;
+            out[i] = (SLint) (v >= 0 ? v + 0.5 : v - 0.5);
+        }
+    }
+}
+
+DLL_EXPORT void sl_scatter_planar(const SLuchar* in, SLuchar* out, SLullong first, SLullong count, SLuint channels, SLullong frameCount, SLuint size) {
+    SLullong frame = first / channels;
+    SLuint channel = (SLuint) (first % channels);
+
+    for (SLullong i = 0; i < count; ++i, in += size) {
+        SLuchar* p = out + ((SLullong) channel * frameCount + frame) * size;
+
+        // constant sizes let the compiler turn these into plain moves
+        switch (size) {
+            case 1: *p = *in; break;
+            case 2: memcpy(p, in, 2); break;
+            case 3: memcpy(p, in, 3); break;
+            case 4: memcpy(p, in, 4); break;
+            default: memcpy(p, in, 8); break;
+        }
+
+        if (++channel == channels) {
+            channel = 0;
+            frame++;
+        }
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_create_resampler(SL_RESAMPLER* resampler, SLuint inRate, SLuint outRate, SLuint channels, SLuint quality) {
+    SLdouble beta;
+    SLdouble rolloff;
+    SLuint divisor;
+    SLuint half;
+
+    if (resampler == NULL) return SL_INVALID_VALUE;
+    memset(resampler, 0, sizeof(SL_RESAMPLER));
+
+    if (inRate == 0 || outRate == 0 || channels == 0 || inRate / outRate >= SL_RESAMPLE_MAX_RATIO) return SL_INVALID_VALUE;
+
+    switch (quality) {
+        case SL_RESAMPLE_FAST: resampler->taps = 16; beta = 6.0; rolloff = 0.85; break;
+        case SL_RESAMPLE_MEDIUM: resampler->taps = 32; beta = 8.0; rolloff = 0.91; break;
+        case SL_RESAMPLE_BEST: resampler->taps = 64; beta = 10.0; rolloff = 0.95; break;
+        default: return SL_INVALID_VALUE;
+    }
+
+    divisor = sl_gcd(inRate, outRate);
+    resampler->inRate = inRate;
+    resampler->outRate = outRate;
+    resampler->channels = channels;
+    resampler->up = outRate / divisor;
+    resampler->down = inRate / divisor;
+    resampler->phaseCount = resampler->up < SL_RESAMPLE_MAX_PHASES ? resampler->up : SL_RESAMPLE_MAX_PHASES;
+
+    // same rate. samples go straight through
+    if (resampler->up == resampler->down) return SL_SUCCESS;
+
+    resampler->capacity = resampler->taps + SL_RESAMPLE_BLOCK;
+    // one phase past the end so the last phase has a neighbor to blend with
+    resampler->filter = (SLfloat*) sl_aligned_malloc(((SLullong) resampler->phaseCount + 1) * resampler->taps * sizeof(SLfloat));
+    resampler->history = (SLfloat*) sl_aligned_malloc(resampler->capacity * channels * sizeof(SLfloat));
+    if (resampler->filter == NULL || resampler->history == NULL) {
+        sl_destroy_resampler(resampler);
+        return SL_MALLOC_FAIL;
+    }
+
+    sl_make_resample_filter(resampler, beta, rolloff);
+
+    // the filter is centered on each output, so the first one looks at half a filter of zeros before the input
+    half = resampler->taps / 2;
+    resampler->fill = half - 1;
+    resampler->start = -(SLllong) resampler->fill;
+    for (SLuint c = 0; c < channels; ++c)
+        memset(resampler->history + c * resampler->capacity, 0, resampler->fill * sizeof(SLfloat));
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_destroy_resampler(SL_RESAMPLER* resampler) {
+    if (resampler != NULL) {
+        sl_free(resampler->filter);
+        sl_free(resampler->history);
+        resampler->filter = NULL;
+        resampler->history = NULL;
+    }
+}
+
+DLL_EXPORT SLullong sl_resample_max_output(const SL_RESAMPLER* resampler, SLullong frameCount) {
+    if (resampler->up == resampler->down) return frameCount;
+    return frameCount * resampler->up / resampler->down + 1;
+}
+
+DLL_EXPORT SLullong sl_resample(SL_RESAMPLER* resampler, const SLfloat* in, SLullong frameCount, SLfloat* out) {
+    if (resampler == NULL || in == NULL || out == NULL) return 0;
+
+    resampler->inTotal += frameCount;
+    return sl_resample_block(resampler, in, frameCount, out, INT64_MAX);
+}
+
+DLL_EXPORT SLullong sl_flush_resampler(SL_RESAMPLER* resampler, SLfloat* out) {
+    if (resampler == NULL || out == NULL || resampler->up == resampler->down) return 0;
+
+    // half a filter of zeros lets every output up to the end of the input see all of its taps
+    return sl_resample_block(resampler, NULL, resampler->taps / 2, out, (SLllong) resampler->inTotal);
+}
+
+DLL_EXPORT SLullong sl_resample_block(SL_RESAMPLER* resampler, const SLfloat* in, SLullong frameCount, SLfloat* out, SLllong limit) {
+    SL_DOT_FUNC dot = sl_get_convert_kernels()->dot;
+    SLuint channels = resampler->channels;
+    SLuint taps = resampler->taps;
+    SLuint half = taps / 2;
+    SLullong made = 0;
+
+    if (resampler->up == resampler->down) {
+        if (in != NULL) memcpy(out, in, frameCount * channels * sizeof(SLfloat));
+        else memset(out, 0, frameCount * channels * sizeof(SLfloat));
+        return frameCount;
+    }
+
+    while (frameCount > 0) {
+        SLullong count = resampler->capacity - resampler->fill;
+        SLllong first;
+
+        if (count > frameCount) count = frameCount;
+
+        // planar so every channel of every output is one straight dot product
+        for (SLuint c = 0; c < channels; ++c) {
+            SLfloat* dst = resampler->history + c * resampler->capacity + resampler->fill;
+
+            if (in == NULL) {
+                memset(dst, 0, count * sizeof(SLfloat));
+            } else {
+                const SLfloat* src = in + c;
+                for (SLullong i = 0; i < count; ++i, src += channels) dst[i] = *src;
+            }
+        }
+
+        resampler->fill += count;
+        if (in != NULL) in += count * channels;
+        frameCount -= count;
+
+        // make every output whose last tap is in the history
+        while (resampler->pos + half < resampler->start + (SLllong) resampler->fill && resampler->pos < limit) {
+            SLullong offset = (SLullong) (resampler->pos - half + 1 - resampler->start);
+            SLullong scaled = (SLullong) resampler->frac * resampler->phaseCount;
+            const SLfloat* coeffs = resampler->filter + (scaled / resampler->up) * taps;
+            // how far the output is past its phase. only ratios with more than SL_RESAMPLE_MAX_PHASES phases land between two
+            SLfloat blend = (SLfloat) (scaled % resampler->up) / (SLfloat) resampler->up;
+
+            for (SLuint c = 0; c < channels; ++c) {
+                const SLfloat* src = resampler->history + c * resampler->capacity + offset;
+                SLfloat v = dot(src, coeffs, taps);
+
+                if (blend != 0) v += (dot(src, coeffs + taps, taps) - v) * blend;
+                out[made * channels + c] = v;
+            }
+
+            made++;
+            resampler->frac += resampler->down;
+            resampler->pos += resampler->frac / resampler->up;
+            resampler->frac %= resampler->up;
+        }
+
+        // throw out what no output needs anymore
+        first = resampler->pos - half + 1 - resampler->start;
+        if (first > 0) {
+            SLullong drop = (SLullong) first < resampler->fill ? (SLullong) first : resampler->fill;
+
+            for (SLuint c = 0; c < channels; ++c) {
+                SLfloat* base = resampler->history + c * resampler->capacity;
+                memmove(base, base + drop, (resampler->fill - drop) * sizeof(SLfloat));
+            }
+
+            resampler->fill -= drop;
+            resampler->start += (SLllong) drop;
+        }
+    }
+
+    return made;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_resample_wave_file(const SL_WAV_FILE* wavBuf, SLuint outRate, SLuint quality, SL_WAV_FILE* out) {
+    SL_RESAMPLER resampler;
+    SL_RETURN_CODE ret;
+    SLfloat* in = NULL;
+    SLfloat* resampled = NULL;
+    SLuchar* dst;
+    SLuint channels;
+    SLuint sampleSize;
+    SLullong inFrames;
+    SLullong outFrames;
+    SLullong done = 0;
+
+    if (wavBuf == NULL || out == NULL || wavBuf->dataChunk.waveformData == NULL) return SL_INVALID_VALUE;
+
+    channels = wavBuf->formatChunk.numChannels;
+    sampleSize = sl_pcm_type_size(wavBuf->dataChunk.pcmType);
+    if (channels == 0 || sampleSize == 0) return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+
+    ret = sl_create_resampler(&resampler, wavBuf->formatChunk.sampleRate, outRate, channels, quality);
+    if (ret != SL_SUCCESS) return ret;
+
+    // every output frame before the end of the input
+    inFrames = wavBuf->dataChunk.dataChunkSize / ((SLullong) sampleSize * channels);
+    outFrames = (inFrames * resampler.up + resampler.down - 1) / resampler.down;
+    if (4 + 8 + wavBuf->formatChunk.fmtChunkSize + 8 + outFrames * sampleSize * channels + 1 > 0xFFFFFFFFULL) {
+        ret = SL_INVALID_CHUNK_DATA_SIZE;
+        goto resamplerCleanup;
+    }
+
+    memset(out, 0, sizeof(SL_WAV_FILE));
+    out->descriptorChunk = wavBuf->descriptorChunk;
+    out->formatChunk = wavBuf->formatChunk;
+    out->dataChunk = wavBuf->dataChunk;
+    out->formatChunk.sampleRate = outRate;
+    out->formatChunk.byteRate = outRate * wavBuf->formatChunk.blockAlign;
+    out->dataChunk.dataChunkSize = (SLuint) (outFrames * sampleSize * channels);
+    // the RIFF size covers the new data chunk and its pad byte, same as the writer puts it
+    out->descriptorChunk.descriptorChunkSize = 4 + 8 + out->formatChunk.fmtChunkSize + 8 + out->dataChunk.dataChunkSize + (out->dataChunk.dataChunkSize & 1);
+    out->dataChunk.dataOffset = 0;
+    out->storage = SL_STORAGE_OWNED;
+
+    out->dataChunk.waveformData = sl_aligned_malloc(out->dataChunk.dataChunkSize ? out->dataChunk.dataChunkSize : 1);
+    in = (SLfloat*) sl_aligned_malloc(SL_RESAMPLE_BLOCK * channels * sizeof(SLfloat));
+    // a block is always longer than the half filter a flush pushes through
+    resampled = (SLfloat*) sl_aligned_malloc(sl_resample_max_output(&resampler, SL_RESAMPLE_BLOCK) * channels * sizeof(SLfloat));
+    if (out->dataChunk.waveformData == NULL || in == NULL || resampled == NULL) {
+        ret = SL_MALLOC_FAIL;
+        goto bufferCleanup;
+    }
+
+    dst = (SLuchar*) out->dataChunk.waveformData;
+
+    // a block at a time through float and back so the whole file is never held as floats
+    for (SLullong pos = 0;; pos += SL_RESAMPLE_BLOCK) {
+        SLullong count = pos >= inFrames ? 0 : inFrames - pos < SL_RESAMPLE_BLOCK ? inFrames - pos : SL_RESAMPLE_BLOCK;
+        SLullong made;
+
+        // the last pass gets what the filter held back for the end
+        if (count > 0) {
+            sl_convert_samples((const SLuchar*) wavBuf->dataChunk.waveformData + pos * sampleSize * channels, wavBuf->dataChunk.pcmType,
+                               in, SL_FLOAT_32PCM, count, channels, SL_CONVERT_DEFAULT);
+            made = sl_resample(&resampler, in, count, resampled);
+        } else {
+            made = sl_flush_resampler(&resampler, resampled);
+        }
+
+        if (made > outFrames - done) made = outFrames - done;
+        sl_convert_samples(resampled, SL_FLOAT_32PCM, dst + done * sampleSize * channels, wavBuf->dataChunk.pcmType, made, channels, SL_CONVERT_DEFAULT);
+        done += made;
+
+        if (count == 0) break;
+    }
+
+    ret = SL_SUCCESS;
+
+    bufferCleanup:
+        sl_free(in);
+        sl_free(resampled);
+        if (ret != SL_SUCCESS) {
+            sl_free(out->dataChunk.waveformData);
+            out->dataChunk.waveformData = NULL;
+        }
+    resamplerCleanup:
+        sl_destroy_resampler(&resampler);
+        return ret;
+}
+
+DLL_EXPORT void sl_make_resample_filter(SL_RESAMPLER* resampler, SLdouble beta, SLdouble rolloff) {
+    const SLdouble pi = 3.14159265358979323846;
+    SLuint taps = resampler->taps;
+    SLdouble half = taps / 2.0;
+    // cutoff in cycles per input sample. going down it has to be under the output's Nyquist frequency instead
+    SLdouble cutoff = 0.5 * rolloff * (resampler->up < resampler->down ? (SLdouble) resampler->up / resampler->down : 1.0);
+    SLdouble norm = sl_bessel_i0(beta);
+
+    // the extra phase at the end is the first one a whole input sample later
+    for (SLuint p = 0; p <= resampler->phaseCount; ++p) {
+        SLfloat* coeffs = resampler->filter + (SLullong) p * taps;
+        SLdouble phase = (SLdouble) p / resampler->phaseCount;
+        SLdouble sum = 0;
+
+        for (SLuint k = 0; k < taps; ++k) {
+            // how far the output is from the input sample this tap lands on
+            SLdouble x = phase + half - 1 - k;
+            SLdouble r = x / half;
+            SLdouble window = r * r < 1 ? sl_bessel_i0(beta * sqrt(1 - r * r)) / norm : 0;
+            SLdouble sinc = x == 0 ? 1 : sin(2 * pi * cutoff * x) / (2 * pi * cutoff * x);
+            SLdouble v = 2 * cutoff * sinc * window;
+
+            coeffs[k] = (SLfloat) v;
+            sum += v;
+        }
+
+        // every phase passes DC as is, otherwise a steady signal picks up a ripple at the phase rate
+        for (SLuint k = 0; k < taps; ++k) coeffs[k] = (SLfloat) (coeffs[k] / sum);
+    }
+}
+
+DLL_EXPORT SLdouble sl_bessel_i0(SLdouble x) {
+    SLdouble term = 1;
+    SLdouble sum = 1;
+
+    // the series converges fast for the betas SAL uses
+    for (SLuint k = 1; k < 64 && term > sum * 1e-17; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+DLL_EXPORT SLuint sl_gcd(SLuint a, SLuint b) {
+    while (b != 0) {
+        SLuint t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+////////////////////////////////////////////////////
+///////////////// OpenAL Wrapper ///////////////////
+////////////////////////////////////////////////////
+
+#ifdef SL_OPENAL_WRAPPER
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+////////////////////////////////////////////////////////////////
+///////////////// Wrapper Struct Definitions ///////////////////
+////////////////////////////////////////////////////////////////
+
+struct sl_sound;
+
+// number of sources an engine tries to make when none is given.
+#define SL_ENGINE_DEFAULT_SOURCES 64
+
+// sounds with a gain under this are not worth a source and play virtually.
+#define SL_INAUDIBLE_GAIN 0.0001f
+
+// One OpenAL device and context that any number of sounds are played against.
+// Opening a device is slow, so open one of these at startup and keep it around.
+// The engine owns a pool of sources that its sounds share. When there are more sounds playing than sources the
+// least important ones keep playing "virtually" (their position keeps moving) and get a source back once one frees up.
+DLL_EXPORT typedef struct sl_engine {
+    ALCdevice* device;
+    ALCcontext* context;
+    SLbool events; // 1 if the context sends AL_SOFT_events to the async service.
+
+    SL_MUTEX mutex; // guards everything below and the voice fields of the engine's sounds.
+    ALuint* sources; // the source pool.
+    struct sl_sound** sourceOwners; // sound using each source of the pool. NULL if it is free.
+    SLuint sourceCount;
+    SLuint freeCount;
+    struct sl_sound* voices; // every sound playing on the engine, real or virtual.
+    SLuint virtualCount;
+    SLullong serviceTick; // last pass of the async service that updated this engine.
+} SL_ENGINE;
+
+// Where a sound playing on an engine is at.
+DLL_EXPORT typedef enum {
+    SL_VOICE_IDLE = 0, // not playing.
+    SL_VOICE_REAL = 1, // playing on a source from the pool.
+    SL_VOICE_VIRTUAL = 2 // playing without a source. only its position moves.
+} SL_VOICE_STATE;
+
+// Called from the async service thread once a sound started with sl_play_sound_async is done.
+DLL_EXPORT typedef void (*SL_SOUND_CALLBACK)(struct sl_sound* sound, SLvoid user);
+
+// Where a sound started with sl_play_sound_async is at.
+DLL_EXPORT typedef enum {
+    SL_ASYNC_NONE = 0, // not playing asynchronously.
+    SL_ASYNC_PLAYING = 1, // playing and watched by the async service.
+    SL_ASYNC_FINISHING = 2 // done playing. the service is cleaning it up and calling the callback.
+} SL_ASYNC_STATE;
+
+// how often the async service checks on sounds when it can't get events from OpenAL.
+#define SL_ASYNC_POLL_MS 20
+
+// how often the async service checks on sounds anyway when OpenAL sends events. only a safety net.
+#define SL_ASYNC_EVENT_POLL_MS 500
+
+DLL_EXPORT typedef struct sl_sound {
+    SL_WAV_FILE* waveBuf;
+
+    SL_ENGINE* engine; // set for sounds made with sl_engine_gen_sound. device and context are then the engine's.
+    SL_WAV_CACHE* cache; // set for sounds made from a cache. waveBuf is given back to it instead of freed.
+    ALCdevice* device;
+    ALCcontext* context;
+    ALuint source;
+    ALuint buffer;
+    ALsizei size;
+    ALsizei freq;
+    ALenum format;
+    SLuint dataType; // SL_WAVE_PCM_TYPE that OpenAL gets. not the file's when it had to be converted.
+    SLvoid converted; // the samples converted to dataType. NULL when waveformData is played as is.
+    ALfloat duration;
+    ALfloat pitch; // in % so 1.0 is 100%, 0.5 is 50% and so on.
+    ALfloat gain; // in % so 1.0 is 100%, 0.5 is 50% and so on.
+    SLint priority; // for engine sounds. when sources run out, higher priority sounds take them from lower ones.
+    struct sl_mixer* mixer; // last mixer it was played on. the mixer reads gain and pitch while mixing, so they are set under its lock.
+
+    // only used by engine sounds. guarded by the engine lock.
+    SLuint voiceState; // one of SL_VOICE_STATE.
+    SLint voiceSource; // index into the engine's pool while the voice is real.
+    SLdouble voiceStart; // sl_get_time() when the voice was (or would have been) at the very start of the sound.
+    struct sl_sound* voicePrev;
+    struct sl_sound* voiceNext;
+
+    // only used by sl_play_sound_async. everything below is guarded by the async service lock.
+    SL_SOUND_CALLBACK callback;
+    SLvoid callbackUser;
+    SLuint asyncState; // one of SL_ASYNC_STATE.
+    SLbool asyncEvents; // 1 if OpenAL tells us when this sound stops so it doesn't need polling.
+    struct sl_sound* asyncPrev;
+    struct sl_sound* asyncNext;
+} SL_SOUND;
+
+// The background thread that finishes sounds started with sl_play_sound_async. There is one per translation unit.
+DLL_EXPORT typedef struct sl_async_service {
+    SL_MUTEX mutex;
+    SL_COND wake; // wakes the service thread.
+    SL_COND done; // wakes everyone waiting on a sound.
+    SL_THREAD thread;
+    SLbool running;
+    SLbool stopping;
+    SLbool dirty; // an OpenAL event said a sound stopped.
+    SLuint pollCount; // number of active sounds without events.
+    SL_SOUND* active; // list of sounds that are playing.
+    ALCboolean (*setThreadContext)(ALCcontext* context); // alcSetThreadContext if the driver has it.
+} SL_ASYNC_SERVICE;
+
+static SL_ASYNC_SERVICE sl_async_service = {SL_MUTEX_INIT, SL_COND_INIT, SL_COND_INIT, 0, 0, 0, 0, 0, NULL, NULL};
+
+// number of OpenAL buffers a streamed sound cycles through.
+#define SL_STREAM_BUFFER_COUNT 4
+
+// length of one streamed buffer in milliseconds.
+#define SL_STREAM_BUFFER_MS 50
+
+// A sound that is read from the file and handed to OpenAL a block at a time while it plays.
+DLL_EXPORT typedef struct sl_sound_stream {
+    SL_WAV_STREAM wavStream;
+
+    ALCdevice* device;
+    ALCcontext* context;
+    ALuint source;
+    ALuint buffers[SL_STREAM_BUFFER_COUNT];
+    SLvoid block; // holds one buffer worth of samples. reused for every refill.
+    SLullong blockFrames;
+    SLvoid converted; // block converted to dataType. NULL when the blocks are played as is.
+    SLuint dataType; // SL_WAVE_PCM_TYPE that OpenAL gets.
+    ALsizei freq;
+    ALenum format;
+    ALfloat pitch; // in % so 1.0 is 100%, 0.5 is 50% and so on.
+    ALfloat gain; // in % so 1.0 is 100%, 0.5 is 50% and so on.
+} SL_SOUND_STREAM;
+
+// sample rate of a mixer's output when none is given.
+#define SL_MIXER_DEFAULT_FREQ 48000
+
+// number of sounds a mixer can play at once when none is given.
+#define SL_MIXER_DEFAULT_VOICES 256
+
+// length of one mixed buffer in milliseconds.
+#define SL_MIXER_BUFFER_MS 20
+
+// frames of a sound that are decoded at a time while mixing. this bounds the mixer's scratch memory.
+#define SL_MIXER_SCRATCH_FRAMES 256
+
+// A sound playing on a mixer. The same sound can be playing on any number of voices.
+DLL_EXPORT typedef struct sl_mixer_voice {
+    SL_SOUND* sound;
+    SLullong frame; // next frame of the sound to mix.
+    SLdouble frac; // how far between frame and the one after it we are. only not 0 when the pitch or sample rate differ.
+    SLullong frameCount; // number of frames in the sound.
+    SL_ADPCM_DECODER decoder; // where decoding got up to for IMA ADPCM sounds.
+} SL_MIXER_VOICE;
+
+// Sums any number of sounds into one stereo float stream that is played on a single OpenAL source.
+// A source per sound is limited by how many voices the device has. A mixer costs the same per buffer no matter how
+// many sounds are playing, other than the mixing itself, so use it for lots of short sounds.
+// Mono sounds play on both channels. Gain and pitch are read from each sound every buffer so they can be changed while it plays.
+DLL_EXPORT typedef struct sl_mixer {
+    ALCdevice* device;
+    ALCcontext* context;
+    ALuint source;
+    ALuint buffers[SL_STREAM_BUFFER_COUNT];
+    ALsizei freq;
+    SLullong blockFrames;
+    SLfloat* block; // one buffer of mixed stereo samples. reused for every refill.
+    SLfloat* scratch; // decoded samples of the voice being mixed.
+    SLfloat* resampled; // scratch after the pitch and sample rate were applied.
+    SLshort* decoded; // IMA ADPCM voices are decoded to this before scratch.
+
+    SL_MUTEX mutex; // guards the voices.
+    SL_MIXER_VOICE* voices; // playing voices. always packed at the front.
+    SLuint voiceCount;
+    SLuint maxVoices;
+} SL_MIXER;
+
+// number of commands a queue can hold when none is given.
+#define SL_COMMAND_QUEUE_DEFAULT_CAPACITY 4096
+
+// What a SL_COMMAND does to its sound.
+DLL_EXPORT typedef enum {
+    SL_COMMAND_PLAY = 0, // sl_start_sound.
+    SL_COMMAND_STOP = 1, // sl_stop_sound.
+    SL_COMMAND_SET_GAIN = 2,
+    SL_COMMAND_SET_PITCH = 3
+} SL_COMMAND_TYPE;
+
+// One thing for the audio thread to do.
+DLL_EXPORT typedef struct sl_command {
+    SLuint type; // one of SL_COMMAND_TYPE.
+    SL_SOUND* sound;
+    SLfloat value; // the gain or pitch to set.
+} SL_COMMAND;
+
+// A place in the queue. sequence says whose turn it is: producers can write it when it equals the position they claimed,
+// the audio thread can read it when it is one past that.
+DLL_EXPORT typedef struct sl_command_slot {
+    volatile SLullong sequence;
+    SL_COMMAND command;
+} SL_COMMAND_SLOT;
+
+// Lets any number of threads play, stop and change engine sounds without touching OpenAL or taking a lock.
+// They only push commands. One audio thread runs them all with sl_run_commands, so OpenAL is only ever called from there.
+// Pushing is a couple of atomics and never waits. When the queue is full the push fails instead.
+DLL_EXPORT typedef struct sl_command_queue {
+    SL_COMMAND_SLOT* slots;
+    SLullong mask; // capacity - 1. the capacity is always a power of two.
+    SLuchar pad0[64]; // producers hammer tail, so it gets a cache line to itself.
+    volatile SLullong tail; // next position a producer can claim.
+    SLuchar pad1[64];
+    SLullong head; // next position the audio thread runs. only the audio thread touches it.
+} SL_COMMAND_QUEUE;
+
+//////////////////////////////////////////////////////////////////
+///////////////// Wrapper Function Definitions ///////////////////
+//////////////////////////////////////////////////////////////////
+
+/**
+ * @brief Lowest level of playing a sound that this wrapper supports.
+ * @param sound - Sound to play.
+ * @param device - Device to play sound to.
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_play_sound(SL_SOUND* sound, SLstr device);
+
+/**
+ * @brief Plays a sound without waiting for it to finish.
+ * The sound itself is the handle. Use sl_is_sound_playing or sl_wait_sound on it, or pass a callback.
+ * One background thread watches every async sound, woken by AL_SOFT_events when the driver has it and polling every SL_ASYNC_POLL_MS otherwise.
+ * Once the sound is done its OpenAL things are cleaned up like sl_stop_sound and the callback is called from that thread.
+ * The sound counts as playing until the callback returns, so don't play the same SL_SOUND again from its own callback.
+ * @param sound - Sound to play. Must stay valid until it is done or stopped.
+ * @param device - Device to play sound to. Use NULL for default device.
+ * @param callback - Called when the sound is done. Can be NULL.
+ * @param user - Passed to the callback.
+ * @return SL_SUCCESS if the sound started. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_play_sound_async(SL_SOUND* sound, SLstr device, SL_SOUND_CALLBACK callback, SLvoid user);
+
+/**
+ * @brief Checks if a sound started with sl_play_sound_async is still playing.
+ * @param sound - Sound to check.
+ * @return 1 if it is still playing. 0 otherwise.
+ */
+DLL_EXPORT static SLbool sl_is_sound_playing(SL_SOUND* sound);
+
+/**
+ * @brief Waits until a sound started with sl_play_sound_async is done and its callback returned.
+ * Returns right away if the sound is not playing.
+ * @param sound - Sound to wait for.
+ */
+DLL_EXPORT static void sl_wait_sound(SL_SOUND* sound);
+
+/**
+ * @brief Stops the async service thread. Sounds that are still playing are stopped without calling their callbacks.
+ * The service starts again by itself on the next sl_play_sound_async.
+ */
+DLL_EXPORT static void sl_stop_async_service(void);
+
+/**
+ * @brief Opens a device and creates a context for an engine.
+ * @param engine - Buffer for the engine.
+ * @param device - Device to open. Use NULL for default device.
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_engine(SL_ENGINE* engine, SLstr device);
+
+/**
+ * @brief Opens a device and creates a context for an engine with a source pool of the given size.
+ * Fewer sources are made if the device can't give that many.
+ * @param engine - Buffer for the engine.
+ * @param device - Device to open. Use NULL for default device.
+ * @param maxSources - Number of sources in the pool.
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_engine_b(SL_ENGINE* engine, SLstr device, SLuint maxSources);
+
+/**
+ * @brief Destroys the context and closes the device of an engine.
+ * Clean up every sound made with the engine before calling this.
+ * @param engine - Engine to destroy.
+ */
+DLL_EXPORT static void sl_destroy_engine(SL_ENGINE* engine);
+
+/**
+ * @brief Generates a SL_SOUND that plays on an engine.
+ * Unlike sl_gen_sound_a the samples are uploaded to OpenAL and a source is made right here, so playing the sound later only has to start the source.
+ * Clean it up with sl_cleanup_sound like any other sound.
+ * @param engine - Engine to play the sound on.
+ * @param sound - Buffer for the sound.
+ * @param waveBuf - WAVE buffer for the sound.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if everything went right. Anything else means something happened.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_engine_gen_sound(SL_ENGINE* engine, SL_SOUND* sound, SL_WAV_FILE* waveBuf, SLfloat gain, SLfloat pitch);
+
+/**
+ * @brief Starts a sound made with sl_engine_gen_sound and returns right away.
+ * Playing a sound that is already playing starts it over.
+ * If every source is busy the sound takes one from the lowest priority (then quietest) voice that is below it, and that voice goes virtual.
+ * If there is no such voice the sound starts out virtual itself.
+ * Call sl_engine_update regularly so finished sounds give back their sources and virtual ones get them.
+ * For completion callbacks use sl_play_sound_async instead, which also works with engine sounds.
+ * @param engine - Engine the sound was made with.
+ * @param sound - Sound to play.
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_engine_play_sound(SL_ENGINE* engine, SL_SOUND* sound);
+
+/**
+ * @brief Returns sources of finished sounds to the pool, finishes virtual sounds that ran out, moves inaudible sounds off their sources and gives free sources to the most important virtual sounds.
+ * The async service calls this for you while it has engine sounds to watch. Otherwise call it about once a frame.
+ * @param engine - Engine to update.
+ */
+DLL_EXPORT static void sl_engine_update(SL_ENGINE* engine);
+
+/**
+ * @brief Finds a free source in an engine's pool, taking back sources of sounds that stopped. This is a helper function and should not be used except by SAL.
+ * @param engine - Engine to look in. Must be locked.
+ * @return Index of the free source. -1 if there is none.
+ */
+DLL_EXPORT static SLint sl_engine_find_source(SL_ENGINE* engine);
+
+/**
+ * @brief Starts a voice on a source of the pool from its current position. This is a helper function and should not be used except by SAL.
+ * @param engine - Engine of the sound. Must be locked.
+ * @param sound - Sound to start.
+ * @param index - Index of the free source to use.
+ * @param now - Current sl_get_time().
+ */
+DLL_EXPORT static void sl_engine_bind_voice(SL_ENGINE* engine, SL_SOUND* sound, SLint index, SLdouble now);
+
+/**
+ * @brief Takes the source away from a real voice. The voice keeps its position and becomes virtual. This is a helper function and should not be used except by SAL.
+ * @param engine - Engine of the sound. Must be locked.
+ * @param sound - Sound to make virtual.
+ * @param now - Current sl_get_time().
+ */
+DLL_EXPORT static void sl_engine_virtualize_voice(SL_ENGINE* engine, SL_SOUND* sound, SLdouble now);
+
+/**
+ * @brief Stops a voice and gives its source back to the pool. This is a helper function and should not be used except by SAL.
+ * @param engine - Engine of the sound. Must be locked.
+ * @param sound - Sound to stop.
+ */
+DLL_EXPORT static void sl_engine_release_voice(SL_ENGINE* engine, SL_SOUND* sound);
+
+/**
+ * @brief Makes the engine context current if it is not already. This is a helper function and should not be used except by SAL.
+ * @param engine - Engine to use.
+ */
+DLL_EXPORT static void sl_engine_make_current(SL_ENGINE* engine);
+
+/**
+ * @brief Opens an OpenAL device and times it for sl_get_stats. This is a helper function and should not be used except by SAL.
+ * @param device - Device to open. NULL for the default one.
+ * @return The device, or NULL if it could not be opened.
+ */
+DLL_EXPORT static ALCdevice* sl_open_device(SLstr device);
+
+/**
+ * @brief Hands samples to an OpenAL buffer and times it for sl_get_stats. This is a helper function and should not be used except by SAL.
+ * @param buffer - Buffer to fill.
+ * @param format - OpenAL format of the samples.
+ * @param data - The samples.
+ * @param size - Size of the samples in bytes.
+ * @param freq - Sample rate of the samples.
+ */
+DLL_EXPORT static void sl_buffer_data(ALuint buffer, ALenum format, const ALvoid* data, ALsizei size, ALsizei freq);
+
+/**
+ * @brief Gets the length of a sound in seconds, ignoring pitch. This is a helper function and should not be used except by SAL.
+ * @param sound - Sound to measure.
+ * @return Length of the sound in seconds.
+ */
+DLL_EXPORT static SLdouble sl_sound_length(SL_SOUND* sound);
+
+/**
+ * @brief Turns on AL_SOFT_events for the current context if the driver has them. This is a helper function and should not be used except by SAL.
+ * @return 1 if events are on. 0 otherwise.
+ */
+DLL_EXPORT static SLbool sl_enable_async_events(void);
+
+/**
+ * @brief Sets up OpenAL for a sound and starts playing it. This is a helper function and should not be used except by SAL.
+ * @param sound - Sound to start.
+ * @param device - Device to play sound to.
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_start_sound(SL_SOUND* sound, SLstr device);
+
+/**
+ * @brief The async service thread. This is a helper function and should not be used except by SAL.
+ * @param arg - Unused.
+ */
+DLL_EXPORT static void sl_async_service_loop(SLvoid arg);
+
+/**
+ * @brief Takes a sound away from the async service, waiting if the service is busy finishing it. This is a helper function and should not be used except by SAL.
+ * @param sound - Sound to take away.
+ */
+DLL_EXPORT static void sl_async_detach(SL_SOUND* sound);
+
+/**
+ * @brief Cleans up the OpenAL things of an async sound from the service thread. This is a helper function and should not be used except by SAL.
+ * @param sound - Sound to clean up.
+ */
+DLL_EXPORT static void sl_async_release(SL_SOUND* sound);
+
+/**
+ * @brief Makes a context current for the calling thread only if the driver allows it. This is a helper function and should not be used except by SAL.
+ * @param context - Context to make current.
+ */
+DLL_EXPORT static void sl_async_make_current(ALCcontext* context);
+
+/**
+ * @brief Lower level way of playing a sound.
+ * This function requires you to manually generate the sound you want to play.
+ * Does NOT clean up after itself. Call sl_cleanup_sound() after using this.
+ * @param sound - Sound to play.
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_play_sound_b(SL_SOUND* sound);
+
+/**
+ * @brief Plays sound in highest level way.
+ * This function parses the WAVE file at the specified path, generates a SL_SOUND, plays the sound, and frees the memory for you.
+ * @param path - Path of WAVE file to parse and play.
+ * @param device - Device to play the audio to.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_play_sound_c(SLstr path, SLstr device, float gain, float pitch);
+
+/**
+ * @brief Parses sound format for specified sound.
+ * Picks the nearest type OpenAL can play for the file and puts it in sound->dataType. 24 and 32 bit ints are played as floats, so are 64 bit floats with more than 2 channels.
+ * @param sound - Sound to parse sound format for.
+ * @return SL_SUCCESS if proeprly parsed. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_sound_format(SL_SOUND* sound);
+
+/**
+ * @brief Parses sound->dataType to mono (1 channel) for specified sound.
+ * This is a helper function for generating sounds.
+ * @param sound - Sound to parse PCM type for.
+ * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_mono(SL_SOUND* sound);
+
+/**
+ * @brief Parses sound->dataType to stereo (2 channels) for specified sound.
+ * This is a helper function for generating sounds.
+ * @param sound - Sound to parse PCM type for.
+ * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_stereo(SL_SOUND* sound);
+
+/**
+ * @brief Parses sound->dataType to QUAD (4 channels) for specified sound.
+ * This is a helper function for generating sounds.
+ * @param sound - Sound to parse PCM type for.
+ * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_quad(SL_SOUND* sound);
+
+/**
+ * @brief Parses sound->dataType to 5.1 (6 channels) for specified sound.
+ * This is a helper function for generating sounds.
+ * @param sound - Sound to parse PCM type for.
+ * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_51(SL_SOUND* sound);
+
+/**
+ * @brief Parses sound->dataType to 6.1 (7 channels) for specified sound.
+ * This is a helper function for generating sounds.
+ * @param sound - Sound to parse PCM type for.
+ * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_61(SL_SOUND* sound);
+
+/**
+ * @brief Parses sound->dataType to 7.1 (8 channels) for specified sound.
+ * This is a helper function for generating sounds.
+ * @param sound - Sound to parse PCM type for.
+ * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_parse_71(SL_SOUND* sound);
+
+/**
+ * @brief Stops the sound if it is currently playing and cleans up OpenAL related things.
+ * This does not free any other sound things. It simply stops the sound and cleans up OpenAL stuff.
+ * @param sound - Sound to stop.
+ */
+DLL_EXPORT static void sl_stop_sound(SL_SOUND* sound);
+
+/**
+ * @brief Cleans up the sound.
+ * Make sure to call this if you are doing things manually.
+ * @param sound - Sound to clean up.
+ */
+DLL_EXPORT static void sl_cleanup_sound(SL_SOUND* sound);
+
+/**
+ * @brief Generates a SL_SOUND from the provided parameters and stores it in the provided buffer.
+ * @param sound - Buffer for the sound.
+ * @param waveBuf - WAVE buffer for the sound.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if everything went right. Anything else means something happened.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_gen_sound_a(SL_SOUND* sound, SL_WAV_FILE* waveBuf, SLfloat gain, SLfloat pitch);
+
+/**
+ * @brief Generates a SL_SOUND from the provided parameters and stores it in the provided buffer.
+ * @param sound - Buffer for the sound.
+ * @param path - Path to the sound. Sound MUST be a WAVE file.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if everything went right. Anything else means something happened.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_gen_sound(SL_SOUND* sound, SLstr path, SLfloat gain, SLfloat pitch);
+
+/**
+ * @brief Generates a SL_SOUND from a WAVE file in a cache, loading it into the cache first if needed.
+ * sl_cleanup_sound gives the file back to the cache instead of freeing it.
+ * @param sound - Buffer for the sound.
+ * @param cache - Cache to get the WAVE file from.
+ * @param path - Path to the sound. Sound MUST be a WAVE file.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if everything went right. Anything else means something happened.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_gen_sound_cached(SL_SOUND* sound, SL_WAV_CACHE* cache, SLstr path, SLfloat gain, SLfloat pitch);
+
+/**
+ * @brief Same as sl_gen_sound_cached but the sound plays on an engine like sl_engine_gen_sound.
+ * @param engine - Engine to play the sound on.
+ * @param sound - Buffer for the sound.
+ * @param cache - Cache to get the WAVE file from.
+ * @param path - Path to the sound. Sound MUST be a WAVE file.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if everything went right. Anything else means something happened.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_engine_gen_sound_cached(SL_ENGINE* engine, SL_SOUND* sound, SL_WAV_CACHE* cache, SLstr path, SLfloat gain, SLfloat pitch);
+
+/**
+ * @brief Returns an array of audio devices.
+ * @return SLstr* array of audio devices.
+ */
+DLL_EXPORT static SLstr* sl_get_devices(void);
+
+/**
+ * @brief Frees the device list that is returned by sl_get_devices(void).
+ * Must be called on the device list that was returned to free it.
+ * @param devices - Device list to free.
+ */
+DLL_EXPORT static void sl_destroy_device_list(SLstr** devices);
+
+/**
+ * @brief Generates a SL_SOUND_STREAM for the WAVE file at the path.
+ * Only the chunks before the samples are read. Nothing is uploaded to OpenAL until sl_start_sound_stream.
+ * @param stream - Buffer for the stream.
+ * @param path - Path to the sound. Sound MUST be a WAVE file.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if everything went right. Anything else means something happened.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_gen_sound_stream(SL_SOUND_STREAM* stream, SLstr path, SLfloat gain, SLfloat pitch);
+
+/**
+ * @brief Starts playing a stream on the specified device. Use NULL for default device.
+ * Playback starts as soon as the first block is queued. This does not wait for the stream to finish.
+ * Call sl_update_sound_stream regularly (at least every SL_STREAM_BUFFER_MS milliseconds) to keep it fed.
+ * @param stream - Stream to play.
+ * @param device - Device to play the stream to.
+ * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_start_sound_stream(SL_SOUND_STREAM* stream, SLstr device);
+
+/**
+ * @brief Refills the buffers OpenAL is done with and queues them again.
+ * @param stream - Stream to update.
+ * @return 1 if the stream is still playing. 0 once everything has been played.
+ */
+DLL_EXPORT static SLbool sl_update_sound_stream(SL_SOUND_STREAM* stream);
+
+/**
+ * @brief Plays the WAVE file at the path as a stream and waits for it to finish.
+ * Use this over sl_play_sound_c for long sounds. Only SL_STREAM_BUFFER_COUNT small buffers are ever in memory.
+ * @param path - Path of WAVE file to play.
+ * @param device - Device to play the audio to.
+ * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
+ * @return SL_SUCCESS if succeeded. Anything else means something happened.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_play_sound_stream(SLstr path, SLstr device, SLfloat gain, SLfloat pitch);
+
+/**
+ * @brief Stops the stream if it is playing and cleans up OpenAL related things.
+ * The stream can be started again after this, but it continues from where it was stopped.
+ * @param stream - Stream to stop.
+ */
+DLL_EXPORT static void sl_stop_sound_stream(SL_SOUND_STREAM* stream);
+
+/**
+ * @brief Cleans up the stream. Stops it and closes the file.
+ * @param stream - Stream to clean up.
+ */
+DLL_EXPORT static void sl_cleanup_sound_stream(SL_SOUND_STREAM* stream);
+
+/**
+ * @brief Reads the next block of a stream into an OpenAL buffer. This is a helper function and should not be used except by SAL.
+ * @param stream - Stream to read from.
+ * @param buffer - OpenAL buffer to fill.
+ * @return 1 if the buffer was filled. 0 if the stream has nothing left.
+ */
+DLL_EXPORT static SLbool sl_fill_stream_buffer(SL_SOUND_STREAM* stream, ALuint buffer);
+
+/**
+ * @brief Opens a device and starts a mixer on it with SL_MIXER_DEFAULT_FREQ and SL_MIXER_DEFAULT_VOICES.
+ * @param mixer - Mixer to start.
+ * @param device - Device to play on. NULL for the default device.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_mixer(SL_MIXER* mixer, SLstr device);
+
+/**
+ * @brief Same as sl_create_mixer but with the output sample rate and voice limit given.
+ * Everything the mixer needs is allocated here. Playing and mixing never allocate.
+ * @param mixer - Mixer to start.
+ * @param device - Device to play on. NULL for the default device.
+ * @param freq - Sample rate of the mixed output. Sounds at other rates are resampled.
+ * @param maxVoices - Most sounds that can play at once.
+ * @return SL_SUCCESS if it succeeded. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_mixer_b(SL_MIXER* mixer, SLstr device, SLuint freq, SLuint maxVoices);
+
+/**
+ * @brief Stops the mixer, closes its device and frees it. The sounds that were playing are left alone.
+ * Sounds that finished on it earlier still point at it for sl_set_sound_param. Don't change their gain or pitch after this
+ * until they are played somewhere else or made again.
+ * @param mixer - Mixer to destroy.
+ */
+DLL_EXPORT static void sl_destroy_mixer(SL_MIXER* mixer);
+
+/**
+ * @brief Starts playing a sound on the mixer from the start. Playing the same sound again overlaps it instead of restarting it.
+ * The sound only needs sl_gen_sound or sl_gen_sound_a. It must stay alive until it is done or sl_mixer_stop_sound is called.
+ * @param mixer - Mixer to play on.
+ * @param sound - Sound to play. Mono and stereo sounds work.
+ * @return SL_SUCCESS if it succeeded. SL_FAIL if every voice is taken. Anything else means a failure.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_mixer_play_sound(SL_MIXER* mixer, SL_SOUND* sound);
+
+/**
+ * @brief Stops every voice of a sound on the mixer.
+ * @param mixer - Mixer the sound plays on.
+ * @param sound - Sound to stop.
+ */
+DLL_EXPORT static void sl_mixer_stop_sound(SL_MIXER* mixer, SL_SOUND* sound);
+
+/**
+ * @brief Mixes and queues a new buffer for every one OpenAL is done with. Call this at least every SL_MIXER_BUFFER_MS milliseconds.
+ * @param mixer - Mixer to update.
+ * @return Number of voices still playing.
+ */
+DLL_EXPORT static SLuint sl_mixer_update(SL_MIXER* mixer);
+
+/**
+ * @brief Mixes the next frames of every voice without going through OpenAL. sl_mixer_update uses this for each buffer.
+ * Voices that reach the end of their sound are dropped.
+ * @param mixer - Mixer whose voices to mix.
+ * @param out - Where the interleaved stereo float samples go. Must hold frameCount * 2 floats.
+ * @param frameCount - Number of frames to mix.
+ * @return Number of voices still playing.
+ */
+DLL_EXPORT static SLuint sl_mixer_mix(SL_MIXER* mixer, SLfloat* out, SLullong frameCount);
+
+/**
+ * @brief Adds the next frames of one voice to the output. This is a helper function and should not be used except by SAL.
+ * @param mixer - Mixer the voice is on. Its scratch buffers are used.
+ * @param voice - Voice to mix.
+ * @param out - Interleaved stereo output to add to.
+ * @param frameCount - Number of output frames.
+ * @return 1 if the voice has more to play. 0 once it reached the end of its sound.
+ */
+DLL_EXPORT static SLbool sl_mixer_mix_voice(SL_MIXER* mixer, SL_MIXER_VOICE* voice, SLfloat* out, SLullong frameCount);
+
+/**
+ * @brief Decodes the frames of a voice starting at its frame into the mixer's scratch as floats. This is a helper function and should not be used except by SAL.
+ * @param mixer - Mixer whose scratch to fill.
+ * @param voice - Voice to decode.
+ * @param frameCount - Number of frames. At most SL_MIXER_SCRATCH_FRAMES.
+ */
+DLL_EXPORT static void sl_mixer_decode(SL_MIXER* mixer, SL_MIXER_VOICE* voice, SLullong frameCount);
+
+/**
+ * @brief Adds mono or stereo samples to stereo output with the SIMD mixing loops. This is a helper function and should not be used except by SAL.
+ * @param out - Interleaved stereo output to add to.
+ * @param in - Samples to add.
+ * @param gain - What the samples are multiplied by first.
+ * @param frameCount - Number of frames.
+ * @param channels - Channels in in. 1 or 2.
+ */
+DLL_EXPORT static void sl_mixer_accumulate(SLfloat* out, const SLfloat* in, SLfloat gain, SLullong frameCount, SLuint channels);
+
+/**
+ * @brief Mixes a buffer and gives it to OpenAL. This is a helper function and should not be used except by SAL.
+ * @param mixer - Mixer to mix.
+ * @param buffer - OpenAL buffer to fill.
+ */
+DLL_EXPORT static void sl_mixer_fill_buffer(SL_MIXER* mixer, ALuint buffer);
+
+/**
+ * @brief Makes an empty command queue.
+ * @param queue - Buffer for the queue.
+ * @param capacity - Most commands it holds before pushes start failing. Rounded up to a power of two. 0 for SL_COMMAND_QUEUE_DEFAULT_CAPACITY.
+ * @return SL_SUCCESS if it succeeded. SL_MALLOC_FAIL otherwise.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_create_command_queue(SL_COMMAND_QUEUE* queue, SLuint capacity);
+
+/**
+ * @brief Frees a command queue. Commands still in it are dropped. Nobody may be pushing to it anymore.
+ * @param queue - Queue to destroy.
+ */
+DLL_EXPORT static void sl_destroy_command_queue(SL_COMMAND_QUEUE* queue);
+
+/**
+ * @brief Adds a command to the queue. Safe to call from any number of threads at once. Never blocks and never calls OpenAL.
+ * @param queue - Queue to push to.
+ * @param type - One of SL_COMMAND_TYPE.
+ * @param sound - Sound the command is for. It has to be on an engine and stay alive until the audio thread ran the command.
+ * Other sounds open and close their own device when they start and stop, which would hold up every command behind them.
+ * @param value - Gain or pitch for SL_COMMAND_SET_GAIN and SL_COMMAND_SET_PITCH. Ignored otherwise.
+ * @return SL_SUCCESS if it was queued. SL_FAIL if the queue is full. SL_INVALID_VALUE if the sound is not on an engine.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_push_command(SL_COMMAND_QUEUE* queue, SLuint type, SL_SOUND* sound, SLfloat value);
+
+/**
+ * @brief Queues sl_start_sound for a sound. See sl_push_command.
+ * Playing a sound that is already playing restarts it on its voice.
+ * @param queue - Queue to push to.
+ * @param sound - Sound to play. Made with sl_engine_gen_sound.
+ * @return SL_SUCCESS if it was queued. SL_FAIL if the queue is full. SL_INVALID_VALUE if the sound is not on an engine.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_queue_play_sound(SL_COMMAND_QUEUE* queue, SL_SOUND* sound);
+
+/**
+ * @brief Queues sl_stop_sound for a sound. See sl_push_command.
+ * @param queue - Queue to push to.
+ * @param sound - Sound to stop.
+ * @return SL_SUCCESS if it was queued. SL_FAIL if the queue is full. SL_INVALID_VALUE if the sound is not on an engine.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_queue_stop_sound(SL_COMMAND_QUEUE* queue, SL_SOUND* sound);
+
+/**
+ * @brief Queues a gain change for a sound. See sl_push_command.
+ * @param queue - Queue to push to.
+ * @param sound - Sound to change.
+ * @param gain - New gain in %.
+ * @return SL_SUCCESS if it was queued. SL_FAIL if the queue is full. SL_INVALID_VALUE if the sound is not on an engine.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_queue_set_gain(SL_COMMAND_QUEUE* queue, SL_SOUND* sound, SLfloat gain);
+
+/**
+ * @brief Queues a pitch change for a sound. See sl_push_command.
+ * @param queue - Queue to push to.
+ * @param sound - Sound to change.
+ * @param pitch - New pitch in %.
+ * @return SL_SUCCESS if it was queued. SL_FAIL if the queue is full. SL_INVALID_VALUE if the sound is not on an engine.
+ */
+DLL_EXPORT static SL_RETURN_CODE sl_queue_set_pitch(SL_COMMAND_QUEUE* queue, SL_SOUND* sound, SLfloat pitch);
+
+/**
+ * @brief Runs the commands in the queue in the order they were pushed. Only one thread, the audio thread, may call this.
+ * At most one queue's worth is run per call so producers that never stop can't keep the audio thread here forever.
+ * @param queue - Queue to run.
+ * @return Number of commands run.
+ */
+DLL_EXPORT static SLuint sl_run_commands(SL_COMMAND_QUEUE* queue);
+
+/**
+ * @brief Runs one command. This is a helper function and should not be used except by SAL.
+ * @param command - Command to run.
+ */
+DLL_EXPORT static void sl_run_command(const SL_COMMAND* command);
+
+/**
+ * @brief Changes the gain or pitch of a sound and of its source if it has one. This is a helper function and should not be used except by SAL.
+ * @param sound - Sound to change.
+ * @param param - AL_GAIN or AL_PITCH.
+ * @param value - New value.
+ */
+DLL_EXPORT static void sl_set_sound_param(SL_SOUND* sound, ALenum param, SLfloat value);
+
+//////////////////////////////////////////////////////////////////////
+///////////////// Wrapper Function Implementations ///////////////////
+//////////////////////////////////////////////////////////////////////
+
+DLL_EXPORT SL_RETURN_CODE sl_play_sound(SL_SOUND* sound, SLstr device) {
+    SL_RETURN_CODE ret = sl_start_sound(sound, device);
+    if (ret != SL_SUCCESS) return ret;
+
+    // engine sounds may not even have a source, so ask the engine instead
+    if (sound->engine != NULL) {
+        do {
+            sl_sleep(SL_ASYNC_POLL_MS / 1000.f);
+            sl_engine_update(sound->engine);
+        } while (sound->voiceState != SL_VOICE_IDLE);
+
+        return SL_SUCCESS;
+    }
+
+    // Wait for playback to finish
+    sl_sleep(sound->duration);
+
+    //ensure it's done playing. no need to spin the cpu while waiting on the last bit
+    ALint state;
+    alGetSourcei(sound->source, AL_SOURCE_STATE, &state);
+    while (state == AL_PLAYING) {
+        sl_sleep(SL_ASYNC_POLL_MS / 1000.f);
+        alGetSourcei(sound->source, AL_SOURCE_STATE, &state);
+    }
+
+    // cleanup
+    sl_stop_sound(sound);
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_start_sound(SL_SOUND* sound, SLstr device) {
+
+    if(sound == NULL) return SL_FAIL;
+
+    // engine sounds already have everything set up
+    if(sound->engine != NULL) return sl_engine_play_sound(sound->engine, sound);
+
+    // started before. give back its device, context, buffer and source first or they leak
+    if(sound->source != 0) sl_stop_sound(sound);
+
+    // Initialize OpenAL
+    sound->device = sl_open_device(device);
+    if(sound->device == NULL) return SL_FAIL;
+
+    sound->context = alcCreateContext(sound->device, NULL);
+    alcMakeContextCurrent(sound->context);
+
+    // Generate a buffer
+    alGenBuffers(1, &sound->buffer);
+
+    //Buffer stuff to data
+    sl_buffer_data(sound->buffer, sound->format, sound->converted != NULL ? sound->converted : sound->waveBuf->dataChunk.waveformData, sound->size, sound->freq);
+
+    // Generate a source
+    alGenSources(1, &sound->source);
+    SL_STATS_ADD(activeVoices, 1);
+
+    // Set the pitch
+    alSourcef(sound->source, AL_PITCH, sound->pitch);
+
+    // Set the gain
+    alSourcef(sound->source, AL_GAIN, sound->gain);
+
+
+    // Queue the buffer for playback
+    alSourceQueueBuffers(sound->source, 1, &sound->buffer);
+
+    // Start playback
+    alSourcePlay(sound->source);
+
+    return SL_SUCCESS;
+}
+
+#ifdef AL_SOFT_events
+// called from OpenAL's own thread, so all it does is poke the service
+static void AL_APIENTRY sl_async_event(ALenum eventType, ALuint object, ALuint param, ALsizei length, const ALchar* message, void* userParam) {
+    (void) object;
+    (void) length;
+    (void) message;
+    (void) userParam;
+
+    if (eventType != AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT || param != AL_STOPPED) return;
+
+    sl_mutex_lock(&sl_async_service.mutex);
+    sl_async_service.dirty = 1;
+    sl_cond_signal(&sl_async_service.wake);
+    sl_mutex_unlock(&sl_async_service.mutex);
+}
+#endif // AL_SOFT_events
+
+DLL_EXPORT SL_RETURN_CODE sl_play_sound_async(SL_SOUND* sound, SLstr device, SL_SOUND_CALLBACK callback, SLvoid user) {
+    SL_RETURN_CODE ret;
+    SLbool events = 0;
+
+    if(sound == NULL || sl_is_sound_playing(sound)) return SL_FAIL;
+
+    // get the service going the first time around
+    sl_mutex_lock(&sl_async_service.mutex);
+    if (!sl_async_service.running) {
+        if (alcIsExtensionPresent(NULL, "ALC_EXT_thread_local_context") == ALC_TRUE)
+            sl_async_service.setThreadContext = (ALCboolean (*)(ALCcontext*)) alcGetProcAddress(NULL, "alcSetThreadContext");
+
+        if (sl_thread_create(&sl_async_service.thread, sl_async_service_loop, NULL) != SL_SUCCESS) {
+            sl_mutex_unlock(&sl_async_service.mutex);
+            return SL_FAIL;
+        }
+        sl_async_service.running = 1;
+    }
+    sl_mutex_unlock(&sl_async_service.mutex);
+
+    ret = sl_start_sound(sound, device);
+    if (ret != SL_SUCCESS) {
+        sl_stop_sound(sound);
+        return ret;
+    }
+
+    // the engine turned events on for its context when it was made
+    events = sound->engine != NULL ? sound->engine->events : sl_enable_async_events();
+
+    sl_mutex_lock(&sl_async_service.mutex);
+    sound->callback = callback;
+    sound->callbackUser = user;
+    sound->asyncState = SL_ASYNC_PLAYING;
+    sound->asyncEvents = events;
+    if (!events) sl_async_service.pollCount++;
+
+    sound->asyncPrev = NULL;
+    sound->asyncNext = sl_async_service.active;
+    if (sl_async_service.active != NULL) sl_async_service.active->asyncPrev = sound;
+    sl_async_service.active = sound;
+
+    // the source may have stopped before we registered the event callback. one look right away covers that
+    sl_async_service.dirty = 1;
+    sl_cond_signal(&sl_async_service.wake);
+    sl_mutex_unlock(&sl_async_service.mutex);
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SLbool sl_enable_async_events(void) {
+    #ifdef AL_SOFT_events
+        // let OpenAL tell us when the source stops instead of asking it over and over
+        if (alIsExtensionPresent("AL_SOFT_events")) {
+            LPALEVENTCONTROLSOFT eventControl = (LPALEVENTCONTROLSOFT) alGetProcAddress("alEventControlSOFT");
+            LPALEVENTCALLBACKSOFT eventCallback = (LPALEVENTCALLBACKSOFT) alGetProcAddress("alEventCallbackSOFT");
+            ALenum types[1] = {AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT};
+
+            if (eventControl != NULL && eventCallback != NULL) {
+                eventCallback(sl_async_event, NULL);
+                eventControl(1, types, AL_TRUE);
+                return 1;
+            }
+        }
+    #endif // AL_SOFT_events
+
+    return 0;
+}
+
+DLL_EXPORT SLbool sl_is_sound_playing(SL_SOUND* sound) {
+    SLbool playing;
+
+    if(sound == NULL) return 0;
+
+    sl_mutex_lock(&sl_async_service.mutex);
+    playing = sound->asyncState != SL_ASYNC_NONE;
+    sl_mutex_unlock(&sl_async_service.mutex);
+
+    return playing;
+}
+
+DLL_EXPORT void sl_wait_sound(SL_SOUND* sound) {
+    if(sound == NULL) return;
+
+    sl_mutex_lock(&sl_async_service.mutex);
+    while (sound->asyncState != SL_ASYNC_NONE) sl_cond_wait(&sl_async_service.done, &sl_async_service.mutex);
+    sl_mutex_unlock(&sl_async_service.mutex);
+}
+
+DLL_EXPORT void sl_stop_async_service(void) {
+    sl_mutex_lock(&sl_async_service.mutex);
+    if (!sl_async_service.running) {
+        sl_mutex_unlock(&sl_async_service.mutex);
+        return;
+    }
+    sl_async_service.stopping = 1;
+    sl_cond_signal(&sl_async_service.wake);
+    sl_mutex_unlock(&sl_async_service.mutex);
+
+    sl_thread_join(sl_async_service.thread);
+
+    // nobody is watching these anymore so stop them here
+    sl_mutex_lock(&sl_async_service.mutex);
+    while (sl_async_service.active != NULL) {
+        SL_SOUND* sound = sl_async_service.active;
+        sl_async_service.active = sound->asyncNext;
+
+        sl_async_release(sound);
+        sound->asyncState = SL_ASYNC_NONE;
+        sound->asyncPrev = sound->asyncNext = NULL;
+    }
+
+    sl_async_service.pollCount = 0;
+    sl_async_service.running = 0;
+    sl_async_service.stopping = 0;
+    sl_cond_broadcast(&sl_async_service.done);
+    sl_mutex_unlock(&sl_async_service.mutex);
+}
+
+DLL_EXPORT void sl_async_service_loop(SLvoid arg) {
+    (void) arg;
+    sl_mutex_lock(&sl_async_service.mutex);
+
+    SLullong tick = 0;
+
+    while (!sl_async_service.stopping) {
+        SL_SOUND* finished = NULL;
+        SL_SOUND* sound = sl_async_service.active;
+        SLbool virtualVoices = 0;
+
+        sl_async_service.dirty = 0;
+        tick++;
+
+        // pull every sound that stopped off the active list
+        while (sound != NULL) {
+            SL_SOUND* next = sound->asyncNext;
+            SLbool stopped;
+
+            if (sound->engine != NULL) {
+                // update each engine once per pass. that also moves its virtual voices along
+                sl_async_make_current(sound->engine->context);
+                if (sound->engine->serviceTick != tick) {
+                    sound->engine->serviceTick = tick;
+                    sl_engine_update(sound->engine);
+                }
+
+                sl_mutex_lock(&sound->engine->mutex);
+                stopped = sound->voiceState == SL_VOICE_IDLE;
+                if (sound->engine->virtualCount > 0) virtualVoices = 1;
+                sl_mutex_unlock(&sound->engine->mutex);
+            } else {
+                ALint state;
+                sl_async_make_current(sound->context);
+                alGetSourcei(sound->source, AL_SOURCE_STATE, &state);
+                stopped = state != AL_PLAYING && state != AL_PAUSED;
+            }
+
+            if (stopped) {
+                if (sound->asyncPrev != NULL) sound->asyncPrev->asyncNext = next;
+                else sl_async_service.active = next;
+                if (next != NULL) next->asyncPrev = sound->asyncPrev;
+
+                if (!sound->asyncEvents) sl_async_service.pollCount--;
+                sound->asyncState = SL_ASYNC_FINISHING;
+                sound->asyncPrev = NULL;
+                sound->asyncNext = finished;
+                finished = sound;
+            }
+
+            sound = next;
+        }
+        sl_async_make_current(NULL);
+
+        // the callbacks may take a while or play more sounds, so let go of the lock for them
+        if (finished != NULL) {
+            sl_mutex_unlock(&sl_async_service.mutex);
+
+            for (sound = finished; sound != NULL; sound = sound->asyncNext) {
+                sl_async_release(sound);
+                if (sound->callback != NULL) sound->callback(sound, sound->callbackUser);
+            }
+
+            sl_mutex_lock(&sl_async_service.mutex);
+
+            while (finished != NULL) {
+                sound = finished;
+                finished = sound->asyncNext;
+                sound->asyncNext = NULL;
+                sound->asyncState = SL_ASYNC_NONE;
+            }
+            sl_cond_broadcast(&sl_async_service.done);
+        }
+
+        if (sl_async_service.stopping || sl_async_service.dirty) continue;
+
+        if (sl_async_service.active == NULL) sl_cond_wait(&sl_async_service.wake, &sl_async_service.mutex);
+        else sl_cond_timed_wait(&sl_async_service.wake, &sl_async_service.mutex, sl_async_service.pollCount > 0 || virtualVoices ? SL_ASYNC_POLL_MS : SL_ASYNC_EVENT_POLL_MS);
+    }
+
+    sl_mutex_unlock(&sl_async_service.mutex);
+}
+
+DLL_EXPORT void sl_async_detach(SL_SOUND* sound) {
+    sl_mutex_lock(&sl_async_service.mutex);
+
+    if (sound->asyncState == SL_ASYNC_PLAYING) {
+        if (sound->asyncPrev != NULL) sound->asyncPrev->asyncNext = sound->asyncNext;
+        else sl_async_service.active = sound->asyncNext;
+        if (sound->asyncNext != NULL) sound->asyncNext->asyncPrev = sound->asyncPrev;
+
+        if (!sound->asyncEvents) sl_async_service.pollCount--;
+        sound->asyncPrev = sound->asyncNext = NULL;
+        sound->asyncState = SL_ASYNC_NONE;
+        sl_cond_broadcast(&sl_async_service.done);
+    }
+
+    // the service is already cleaning this one up. let it finish
+    while (sound->asyncState == SL_ASYNC_FINISHING) sl_cond_wait(&sl_async_service.done, &sl_async_service.mutex);
+
+    sl_mutex_unlock(&sl_async_service.mutex);
+}
+
+DLL_EXPORT void sl_async_release(SL_SOUND* sound) {
+    // engine sounds keep their buffer so they can be played again. the source goes back to the pool
+    if (sound->engine != NULL) {
+        sl_async_make_current(sound->engine->context);
+        sl_mutex_lock(&sound->engine->mutex);
+        sl_engine_release_voice(sound->engine, sound);
+        sl_mutex_unlock(&sound->engine->mutex);
+        sl_async_make_current(NULL);
+        return;
+    }
+
+    sl_async_make_current(sound->context);
+
+    if (sound->source) {
+        alSourceStop(sound->source);
+        alDeleteSources(1, &sound->source);
+        sound->source = 0;
+    }
+
+    if (sound->buffer) {
+        alDeleteBuffers(1, &sound->buffer);
+        sound->buffer = 0;
+    }
+
+    sl_async_make_current(NULL);
+
+    if (sound->context) {
+        alcDestroyContext(sound->context);
+        sound->context = NULL;
+    }
+
+    if (sound->device) {
+        alcCloseDevice(sound->device);
+        sound->device = NULL;
+    }
+}
+
+DLL_EXPORT void sl_async_make_current(ALCcontext* context) {
+    // without the thread local extension this changes the context for every thread. it is the best we can do
+    if (sl_async_service.setThreadContext != NULL) sl_async_service.setThreadContext(context);
+    else if (context != NULL) alcMakeContextCurrent(context);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_play_sound_b(SL_SOUND* sound) {
+    return sl_play_sound(sound, NULL);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_play_sound_c(SLstr path, SLstr device, float gain, float pitch) {
+    SL_SOUND sound;
+    SL_WAV_FILE buf;
+    SL_RETURN_CODE out = sl_read_wave_file(path, &buf);
+
+    if (out != SL_SUCCESS) return out;
+
+    out = sl_gen_sound_a(&sound, &buf, gain, pitch);
+
+    if (out != SL_SUCCESS) {
+        sl_cleanup_wave_file(&buf);
+        return out;
+    }
+
+    out = sl_play_sound(&sound, device);
+
+    sl_cleanup_sound(&sound);
+
+    return out;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_sound_format(SL_SOUND* sound) {
+    SL_RETURN_CODE ret;
+    SLuint pcmType = sound->waveBuf->dataChunk.pcmType;
+
+    // OpenAL has no 24 or 32 bit int formats and doubles only come in mono and stereo. floats are the nearest thing for all of them
+    sound->dataType = pcmType;
+    if (pcmType == SL_SIGNED_24PCM || pcmType == SL_SIGNED_32PCM ||
+        (pcmType == SL_FLOAT_64PCM && sound->waveBuf->formatChunk.numChannels > 2))
+        sound->dataType = SL_FLOAT_32PCM;
+    // IMA ADPCM is 16 bit once it is decoded
+    else if (pcmType == SL_IMA_ADPCM)
+        sound->dataType = SL_SIGNED_16PCM;
+
+    switch(sound->waveBuf->formatChunk.numChannels) {
+        case 1: {
+            ret = sl_parse_mono(sound);
+            break;
+        }
+        case 2: {
+            ret = sl_parse_stereo(sound);
+            break;
+        }
+        case 4: {
+            ret = sl_parse_quad(sound);
+            break;
+        }
+        case 6: {
+            ret = sl_parse_51(sound);
+            break;
+        }
+        case 7: {
+            ret = sl_parse_61(sound);
+            break;
+        }
+        case 8: {
+            ret = sl_parse_71(sound);
+            break;
+        }
+        default: {
+            ret = SL_FAIL;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_mono(SL_SOUND* sound) {
+    switch(sound->dataType) {
+        case SL_UNSIGNED_8PCM: {
+            sound->format = AL_FORMAT_MONO8;
+            break;
+        }
+        case SL_SIGNED_16PCM: {
+            sound->format = AL_FORMAT_MONO16;
+            break;
+        }
+        case SL_FLOAT_32PCM: {
+            sound->format = AL_FORMAT_MONO_FLOAT32;
+            break;
+        }
+        case SL_FLOAT_64PCM: {
+            sound->format = AL_FORMAT_MONO_DOUBLE_EXT;
+            break;
+        }
+        default:
+            return SL_FAIL;
+    }
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_stereo(SL_SOUND* sound) {
+    switch(sound->dataType) {
+        case SL_UNSIGNED_8PCM: {
+            sound->format = AL_FORMAT_STEREO8;
+            break;
+        }
+        case SL_SIGNED_16PCM: {
+            sound->format = AL_FORMAT_STEREO16;
+            break;
+        }
+        case SL_FLOAT_32PCM: {
+            sound->format = AL_FORMAT_STEREO_FLOAT32;
+            break;
+        }
+        case SL_FLOAT_64PCM: {
+            sound->format = AL_FORMAT_STEREO_DOUBLE_EXT;
+            break;
+        }
+        default:
+            return SL_FAIL;
+    }
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_quad(SL_SOUND* sound) {
+    switch(sound->dataType) {
+        case SL_UNSIGNED_8PCM: {
+            sound->format = AL_FORMAT_QUAD8;
+            break;
+        }
+        case SL_SIGNED_16PCM: {
+            sound->format = AL_FORMAT_QUAD16;
+            break;
+        }
+        case SL_FLOAT_32PCM: {
+            sound->format = AL_FORMAT_QUAD32;
+            break;
+        }
+        default:
+            return SL_FAIL;
+    }
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_51(SL_SOUND* sound) {
+    switch(sound->dataType) {
+        case SL_UNSIGNED_8PCM: {
+            sound->format = AL_FORMAT_51CHN8;
+            break;
+        }
+        case SL_SIGNED_16PCM: {
+            sound->format = AL_FORMAT_51CHN16;
+            break;
+        }
+        case SL_FLOAT_32PCM: {
+            sound->format = AL_FORMAT_51CHN32;
+            break;
+        }
+        default:
+            return SL_FAIL;
+    }
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_61(SL_SOUND* sound) {
+    switch(sound->dataType) {
+        case SL_UNSIGNED_8PCM: {
+            sound->format = AL_FORMAT_61CHN8;
+            break;
+        }
+        case SL_SIGNED_16PCM: {
+            sound->format = AL_FORMAT_61CHN16;
+            break;
+        }
+        case SL_FLOAT_32PCM: {
+            sound->format = AL_FORMAT_61CHN32;
+            break;
+        }
+        default:
+            return SL_FAIL;
+    }
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_parse_71(SL_SOUND* sound) {
+    switch(sound->dataType) {
+        case SL_UNSIGNED_8PCM: {
+            sound->format = AL_FORMAT_71CHN8;
+            break;
+        }
+        case SL_SIGNED_16PCM: {
+            sound->format = AL_FORMAT_71CHN16;
+            break;
+        }
+        case SL_FLOAT_32PCM: {
+            sound->format = AL_FORMAT_71CHN32;
+            break;
+        }
+        default:
+            return SL_FAIL;
+    }
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT void sl_stop_sound(SL_SOUND* sound) {
+    // make sure the async service is not looking at this sound anymore
+    sl_async_detach(sound);
+
+    // engine sounds only give their source back. the buffer is deleted by sl_cleanup_sound
+    if (sound->engine != NULL) {
+        sl_engine_make_current(sound->engine);
+        sl_mutex_lock(&sound->engine->mutex);
+        sl_engine_release_voice(sound->engine, sound);
+        sl_mutex_unlock(&sound->engine->mutex);
+        return;
+    }
+
+    // with more than one sound around the current context may not be this one
+    if (sound->context) alcMakeContextCurrent(sound->context);
+
+    if (sound->source) {
+        // Stop the source and delete the source
+        alSourceStop(sound->source);
+        alDeleteSources(1, &sound->source);
+        sound->source = 0;
+        SL_STATS_ADD(activeVoices, -1);
+    }
+
+    if (sound->buffer) {
+        // Delete the buffer
+        alDeleteBuffers(1, &sound->buffer);
+        sound->buffer = 0;
+    }
+
+    if (sound->context) {
+        // Destroy the context
+        alcMakeContextCurrent(NULL);
+        alcDestroyContext(sound->context);
+        sound->context = NULL;
+    }
+
+    if (sound->device) {
+        // Close the device
+        alcCloseDevice(sound->device);
+        sound->device = NULL;
+    }
+}
+
+DLL_EXPORT void sl_cleanup_sound(SL_SOUND* sound) {
+    if(sound != NULL) {
+        //stop sound
+        sl_stop_sound(sound);
+
+        if (sound->engine != NULL) {
+            if (sound->buffer) alDeleteBuffers(1, &sound->buffer);
+            sound->buffer = 0;
+            sound->engine = NULL;
+        }
+
+        if (sound->converted != NULL) sl_free(sound->converted);
+        sound->converted = NULL;
+
+        //free wav file. files from a cache go back to it
+        if (sound->cache != NULL) sl_cache_release(sound->cache, sound->waveBuf);
+        else sl_cleanup_wave_file(sound->waveBuf);
+        sound->waveBuf = NULL;
+        sound->cache = NULL;
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_gen_sound_a(SL_SOUND* sound, SL_WAV_FILE* waveBuf, SLfloat gain, SLfloat pitch) {
+
+    if(waveBuf == NULL) return SL_FAIL;
+
+    memset(sound, 0, sizeof(SL_SOUND));
+
+    sound->waveBuf = waveBuf;
+    sound->gain    = gain;
+    sound->pitch   = pitch;
+    sound->freq    = waveBuf->formatChunk.sampleRate;
+    sound->size    = waveBuf->dataChunk.dataChunkSize;
+
+    SLullong frames = sl_wave_frame_count(waveBuf);
+    if (frames == 0) return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+    sound->duration = ((frames / sound->freq) / pitch) + 0.5;
+
+    SL_RETURN_CODE ret = sl_parse_sound_format(sound);
+    if (ret != SL_SUCCESS) return ret;
+
+    // convert once here in a single pass so every play can hand OpenAL the samples as they are
+    // compressed files get decoded here, a block at a time
+    if (sound->dataType != waveBuf->dataChunk.pcmType) {
+        SLuint channels = waveBuf->formatChunk.numChannels;
+        SLullong size = frames * channels * sl_pcm_type_size(sound->dataType);
+
+        sound->converted = sl_aligned_malloc(size);
+        if (sound->converted == NULL) return SL_MALLOC_FAIL;
+
+        ret = sl_convert_wave_data(waveBuf, sound->dataType, sound->converted, SL_CONVERT_DEFAULT);
+        if (ret != SL_SUCCESS) {
+            sl_free(sound->converted);
+            sound->converted = NULL;
+            return ret;
+        }
+
+        sound->size = (ALsizei) size;
+    }
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_create_engine(SL_ENGINE* engine, SLstr device) {
+    return sl_create_engine_b(engine, device, SL_ENGINE_DEFAULT_SOURCES);
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_create_engine_b(SL_ENGINE* engine, SLstr device, SLuint maxSources) {
+    if(engine == NULL || maxSources == 0) return SL_FAIL;
+
+    memset(engine, 0, sizeof(SL_ENGINE));
+
+    engine->device = sl_open_device(device);
+    if (engine->device == NULL) return SL_FAIL;
+
+    engine->context = alcCreateContext(engine->device, NULL);
+    if (engine->context == NULL) goto deviceCleanup;
+
+    alcMakeContextCurrent(engine->context);
+    engine->events = sl_enable_async_events();
+
+    engine->sources = (ALuint*) sl_malloc(maxSources * sizeof(ALuint));
+    engine->sourceOwners = (SL_SOUND**) sl_calloc(maxSources, sizeof(SL_SOUND*));
+    if (engine->sources == NULL || engine->sourceOwners == NULL) goto contextCleanup;
+
+    // make the whole pool now so playing never has to. stop early if the device runs out
+    alGetError();
+    while (engine->sourceCount < maxSources) {
+        alGenSources(1, &engine->sources[engine->sourceCount]);
+        if (alGetError() != AL_NO_ERROR) break;
+        engine->sourceCount++;
+    }
+    if (engine->sourceCount == 0) goto contextCleanup;
+
+    engine->freeCount = engine->sourceCount;
+    sl_mutex_init(&engine->mutex);
+
+    return SL_SUCCESS;
+
+    contextCleanup:
+        sl_free(engine->sources);
+        sl_free(engine->sourceOwners);
+        engine->sources = NULL;
+        engine->sourceOwners = NULL;
+        alcMakeContextCurrent(NULL);
+        alcDestroyContext(engine->context);
+        engine->context = NULL;
+    deviceCleanup:
+        alcCloseDevice(engine->device);
+        engine->device = NULL;
+        return SL_FAIL;
+}
+
+DLL_EXPORT void sl_destroy_engine(SL_ENGINE* engine) {
+    if(engine == NULL) return;
+
+    if (engine->context) {
+        sl_engine_make_current(engine);
+        if (engine->sourceCount > 0) alDeleteSources((ALsizei) engine->sourceCount, engine->sources);
+
+        alcMakeContextCurrent(NULL);
+        alcDestroyContext(engine->context);
+        engine->context = NULL;
+
+        sl_mutex_destroy(&engine->mutex);
+    }
+
+    if (engine->device) {
+        alcCloseDevice(engine->device);
+        engine->device = NULL;
+    }
+
+    sl_free(engine->sources);
+    sl_free(engine->sourceOwners);
+    engine->sources = NULL;
+    engine->sourceOwners = NULL;
+    engine->sourceCount = 0;
+    engine->freeCount = 0;
+    engine->voices = NULL;
+    engine->virtualCount = 0;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_engine_gen_sound(SL_ENGINE* engine, SL_SOUND* sound, SL_WAV_FILE* waveBuf, SLfloat gain, SLfloat pitch) {
+    SL_RETURN_CODE ret;
+
+    if(engine == NULL || engine->context == NULL) return SL_FAIL;
+
+    ret = sl_gen_sound_a(sound, waveBuf, gain, pitch);
+    if (ret != SL_SUCCESS) return ret;
+
+    sound->engine = engine;
+    sound->voiceSource = -1;
+    sl_engine_make_current(engine);
+
+    // do the slow upload now so playing is just starting a source
+    alGetError();
+    alGenBuffers(1, &sound->buffer);
+    sl_buffer_data(sound->buffer, sound->format, sound->converted != NULL ? sound->converted : sound->waveBuf->dataChunk.waveformData, sound->size, sound->freq);
+
+    // OpenAL has its own copy now
+    sl_free(sound->converted);
+    sound->converted = NULL;
+
+    if (alGetError() != AL_NO_ERROR) {
+        if (sound->buffer) alDeleteBuffers(1, &sound->buffer);
+        sound->buffer = 0;
+        sound->engine = NULL;
+        return SL_FAIL;
+    }
+
+    return SL_SUCCESS;
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_engine_play_sound(SL_ENGINE* engine, SL_SOUND* sound) {
+    SLdouble now = sl_get_time();
+    SLint index;
+
+    if(engine == NULL || sound == NULL || sound->engine != engine || sound->buffer == 0) return SL_FAIL;
+
+    sl_engine_make_current(engine);
+    sl_mutex_lock(&engine->mutex);
+
+    // playing again starts over from the top
+    sl_engine_release_voice(engine, sound);
+
+    sound->voiceStart = now;
+    sound->voicePrev = NULL;
+    sound->voiceNext = engine->voices;
+    if (engine->voices != NULL) engine->voices->voicePrev = sound;
+    engine->voices = sound;
 
-///////////////////////////////////////////////////////////////////////////////
-///////////////// Wave File Parser Function Implementations ///////////////////
-///////////////////////////////////////////////////////////////////////////////
+    sound->voiceState = SL_VOICE_VIRTUAL;
+    engine->virtualCount++;
+    SL_STATS_ADD(activeVoices, 1);
 
-DLL_EXPORT SL_RETURN_CODE sl_read_wave_file(SLstr path, SL_WAV_FILE* wavBuf) {
-    SL_RETURN_CODE ret = SL_SUCCESS;
-    memset(wavBuf, 0, sizeof(SL_WAV_FILE));
+    // not worth a source if nobody can hear it
+    if (sound->gain < SL_INAUDIBLE_GAIN) goto unlock;
 
-    FILE* file;
+    index = sl_engine_find_source(engine);
 
-    //ensure pointers are good were just going to assume the user allocated stuff right
-    if (path == NULL) {
-        ret = SL_INVALID_VALUE;
-        goto exit;
-    }
+    // out of sources. steal from the least important real voice if it is below us
+    if (index < 0) {
+        SL_SOUND* victim = NULL;
 
-    //ensures that this file we are reading is a wave file-or at least ends with it
-    if(sl_is_wave_file(path) == SL_FAIL) {
-        ret = SL_FILE_ERROR;
-        goto exit;
-    }
+        for (SL_SOUND* voice = engine->voices; voice != NULL; voice = voice->voiceNext) {
+            if (voice->voiceState != SL_VOICE_REAL) continue;
 
-    // try to open file
-    file = fopen(path, "rb");
-    if (file == NULL) {
-        ret = SL_FILE_ERROR;
-        goto exit;
+            if (victim == NULL || voice->priority < victim->priority ||
+                (voice->priority == victim->priority && voice->gain < victim->gain))
+                victim = voice;
+        }
+
+        if (victim == NULL || victim->priority > sound->priority ||
+            (victim->priority == sound->priority && victim->gain >= sound->gain))
+            goto unlock;
+
+        index = victim->voiceSource;
+        sl_engine_virtualize_voice(engine, victim, now);
     }
 
-    ret = sl_read_wave_descriptor(file, wavBuf);
-    if(ret != SL_SUCCESS) goto bufCleanup;
+    sl_engine_bind_voice(engine, sound, index, now);
 
-    ret = sl_parse_wave_chunks(file, wavBuf);
-    if(ret != SL_SUCCESS) goto bufCleanup;
+    unlock:
+        sl_mutex_unlock(&engine->mutex);
+        return SL_SUCCESS;
+}
 
-    ret = sl_validate_wave_data(wavBuf);
-    if(ret != SL_SUCCESS) goto bufCleanup;
+DLL_EXPORT void sl_engine_update(SL_ENGINE* engine) {
+    SLdouble now = sl_get_time();
+    SL_SOUND* voice;
 
-    ret = sl_ensure_wave_endianness(wavBuf);
-    if(ret != SL_SUCCESS) goto bufCleanup;
+    if(engine == NULL || engine->context == NULL) return;
+
+    sl_engine_make_current(engine);
+    sl_mutex_lock(&engine->mutex);
+
+    // finish sounds that are done and move inaudible ones off their sources
+    voice = engine->voices;
+    while (voice != NULL) {
+        SL_SOUND* next = voice->voiceNext;
 
-    if (wavBuf->dataChunk.waveformData != NULL) goto fileCleanup;
-    else {
-        ret = SL_FAIL;
-        goto bufCleanup;
+        if (voice->voiceState == SL_VOICE_REAL) {
+            ALint state;
+            alGetSourcei(voice->source, AL_SOURCE_STATE, &state);
+
+            if (state == AL_STOPPED) sl_engine_release_voice(engine, voice);
+            else if (voice->gain < SL_INAUDIBLE_GAIN) sl_engine_virtualize_voice(engine, voice, now);
+        } else if ((now - voice->voiceStart) * voice->pitch >= sl_sound_length(voice)) {
+            sl_engine_release_voice(engine, voice);
+        }
+
+        voice = next;
     }
 
-    bufCleanup:
-        if(wavBuf->dataChunk.waveformData != NULL) free(wavBuf->dataChunk.waveformData);
-            wavBuf->dataChunk.waveformData = NULL;
-    fileCleanup:
-        fclose(file);
-    exit:
-        return ret;
-}
+    // hand free sources to the most important virtual voices that can be heard
+    while (engine->virtualCount > 0 && engine->freeCount > 0) {
+        SL_SOUND* best = NULL;
 
-DLL_EXPORT void sl_cleanup_wave_file(SL_WAV_FILE* wavBuf) {
-    if(wavBuf != NULL) {
-        if(wavBuf->dataChunk.waveformData != NULL) free(wavBuf->dataChunk.waveformData);
-        wavBuf->dataChunk.waveformData = NULL;
+        for (voice = engine->voices; voice != NULL; voice = voice->voiceNext) {
+            if (voice->voiceState != SL_VOICE_VIRTUAL || voice->gain < SL_INAUDIBLE_GAIN) continue;
+
+            if (best == NULL || voice->priority > best->priority ||
+                (voice->priority == best->priority && voice->gain > best->gain))
+                best = voice;
+        }
+
+        if (best == NULL) break;
+        sl_engine_bind_voice(engine, best, sl_engine_find_source(engine), now);
     }
-}
 
-DLL_EXPORT SL_RETURN_CODE sl_read_wave_descriptor(FILE* file, SL_WAV_FILE* wavBuf) {
-    const SLuchar riffID_bytes[4] = {0x52, 0x49, 0x46, 0x46};
-    const SLuchar waveID_bytes[4] = {0x57, 0x41, 0x56, 0x45};
-    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
-    SLullong blocksRead;
+    sl_mutex_unlock(&engine->mutex);
+}
 
-    //read and validate chunkID
-    blocksRead = fread(wavBuf->descriptorChunk.descriptorId, 4, 1, file);
-    if (!blocksRead)
-        return SL_INVALID_CHUNK_DESCRIPTOR_ID;
+DLL_EXPORT SLint sl_engine_find_source(SL_ENGINE* engine) {
+    if (engine->freeCount == 0) {
+        // sounds that ran out since the last update still hold their source. take those back first
+        for (SLuint i = 0; i < engine->sourceCount; i++) {
+            ALint state;
+            if (engine->sourceOwners[i] == NULL) continue;
 
-    if (memcmp(wavBuf->descriptorChunk.descriptorId, riffID_bytes, 4) != 0)
-        return SL_INVALID_CHUNK_DESCRIPTOR_ID;
+            alGetSourcei(engine->sources[i], AL_SOURCE_STATE, &state);
+            if (state == AL_STOPPED) sl_engine_release_voice(engine, engine->sourceOwners[i]);
+        }
 
-    //read and validate chunk size
-    blocksRead = fread(buffer4, 4, 1, file);
-    wavBuf->descriptorChunk.descriptorChunkSize = sl_buf_to_native_uint(buffer4, 4);
-    if (!blocksRead || wavBuf->descriptorChunk.descriptorChunkSize == 0)
-        return SL_INVALID_CHUNK_DESCRIPTOR_SIZE;
+        if (engine->freeCount == 0) return -1;
+    }
 
-    //read and validate wave format
-    blocksRead = fread(wavBuf->descriptorChunk.chunkFormat, 4, 1, file);
-    if (!blocksRead || memcmp(wavBuf->descriptorChunk.chunkFormat, waveID_bytes, 4) != 0)
-        return SL_INVALID_CHUNK_DESCRIPTOR_FORMAT;
+    for (SLuint i = 0; i < engine->sourceCount; i++)
+        if (engine->sourceOwners[i] == NULL) return (SLint) i;
 
-    return SL_SUCCESS;
+    return -1;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_wave_chunks(FILE* file, SL_WAV_FILE* wavBuf) {
-    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
-    const SLuchar fmtID_bytes [4] = {0x66, 0x6d, 0x74, 0x20};
-    const SLuchar dataID_bytes[4] = {0x64, 0x61, 0x74, 0x61};
-    SLullong blocksRead;
-    SLbool foundFmt = 0;
-    SLbool foundData = 0;
+DLL_EXPORT void sl_engine_bind_voice(SL_ENGINE* engine, SL_SOUND* sound, SLint index, SLdouble now) {
+    ALuint source = engine->sources[index];
+    SLdouble position = (now - sound->voiceStart) * sound->pitch;
 
-    // Implement the logic for reading the wave descriptor here
-    blocksRead = fread(buffer4, 4, 1, file);
+    engine->sourceOwners[index] = sound;
+    engine->freeCount--;
+    if (sound->voiceState == SL_VOICE_VIRTUAL) engine->virtualCount--;
 
-    while(blocksRead) {
-        SLuint foundMatch = 0;
+    sound->voiceState = SL_VOICE_REAL;
+    sound->voiceSource = index;
+    sound->source = source;
 
-        // check if everything is valid
-        if (feof(file) || ferror(file))
-            return SL_INVALID_WAVE_FORMAT;
+    alSourcei(source, AL_BUFFER, (ALint) sound->buffer);
+    alSourcef(source, AL_PITCH, sound->pitch);
+    alSourcef(source, AL_GAIN, sound->gain);
 
-        //FORMAT CHUNK
-        if(!foundFmt && memcmp(buffer4, fmtID_bytes, 4) == 0) {
-            foundMatch = 1;
-            foundFmt = 1;
-            //store format id
-            memcpy(wavBuf->formatChunk.fmtId, buffer4, 4);
+    // pick up where the voice would be by now
+    if (position > 0) alSourcef(source, AL_SEC_OFFSET, (ALfloat) position);
+    alSourcePlay(source);
+}
 
-            SL_RETURN_CODE ret = sl_read_wave_format_chunk(file, wavBuf);
-            if(ret != SL_SUCCESS)
-                return ret;
-        }
+DLL_EXPORT void sl_engine_virtualize_voice(SL_ENGINE* engine, SL_SOUND* sound, SLdouble now) {
+    ALfloat offset = 0.f;
+    ALuint source = engine->sources[sound->voiceSource];
 
-        // DATA CHUNK
-        else if(!foundData && memcmp(buffer4, dataID_bytes, 4) == 0) {
-            foundMatch = 1;
-            foundData = 1;
+    // the source knows exactly where it is. use that instead of our guess
+    alGetSourcef(source, AL_SEC_OFFSET, &offset);
+    if (sound->pitch > 0) sound->voiceStart = now - offset / sound->pitch;
 
-            //store data id
-            memcpy(wavBuf->dataChunk.dataId, buffer4, 4);
-            SL_RETURN_CODE ret = sl_read_wave_data_chunk(file, wavBuf);
-            if(ret != SL_SUCCESS) return ret;
-        }
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, 0);
 
-        if(foundFmt && foundData) break;
+    engine->sourceOwners[sound->voiceSource] = NULL;
+    engine->freeCount++;
+    engine->virtualCount++;
 
-        if(foundMatch) {
-            blocksRead = fread(buffer4, 4, 1, file);
-        } else {
-            SLuint size;
-            blocksRead = fread(buffer4, 4, 1, file);
-            if (!blocksRead)
-                return SL_INVALID_WAVE_FORMAT;
+    sound->voiceState = SL_VOICE_VIRTUAL;
+    sound->voiceSource = -1;
+    sound->source = 0;
+}
 
-            size = sl_buf_to_native_uint(buffer4, 4);
-            if (size == 0)
-                return SL_INVALID_WAVE_FORMAT;
+DLL_EXPORT void sl_engine_release_voice(SL_ENGINE* engine, SL_SOUND* sound) {
+    if (sound->voiceState == SL_VOICE_IDLE) return;
+    SL_STATS_ADD(activeVoices, -1);
 
-            // skip chunk and read next ID
-            fseek(file, size, SEEK_CUR);
-            blocksRead = fread(buffer4, 4, 1, file);
-        }
+    if (sound->voiceState == SL_VOICE_REAL) {
+        alSourceStop(sound->source);
+        alSourcei(sound->source, AL_BUFFER, 0);
+
+        engine->sourceOwners[sound->voiceSource] = NULL;
+        engine->freeCount++;
+    } else {
+        engine->virtualCount--;
     }
 
-    if(!foundFmt)
-        return SL_CHUNK_FORMAT_NOT_FOUND;
-    else if(!foundData)
-        return SL_CHUNK_DATA_NOT_FOUND;
+    if (sound->voicePrev != NULL) sound->voicePrev->voiceNext = sound->voiceNext;
+    else engine->voices = sound->voiceNext;
+    if (sound->voiceNext != NULL) sound->voiceNext->voicePrev = sound->voicePrev;
 
-    return SL_SUCCESS;
+    sound->voicePrev = sound->voiceNext = NULL;
+    sound->voiceState = SL_VOICE_IDLE;
+    sound->voiceSource = -1;
+    sound->source = 0;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_read_wave_format_chunk(FILE* file, SL_WAV_FILE* wavBuf) {
-    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
-    SLuchar buffer2[2] = {0x00, 0x00};
-    SLullong blocksRead;
+DLL_EXPORT void sl_engine_make_current(SL_ENGINE* engine) {
+    if (alcGetCurrentContext() != engine->context) alcMakeContextCurrent(engine->context);
+}
 
-    //read and validate fmt chunk size
-    blocksRead = fread(buffer4, 4, 1, file);
-    wavBuf->formatChunk.fmtChunkSize = sl_buf_to_native_uint(buffer4, 4);
-    if (!blocksRead || wavBuf->formatChunk.fmtChunkSize == 0)
-        return SL_INVALID_CHUNK_FMT_SIZE;
+DLL_EXPORT ALCdevice* sl_open_device(SLstr device) {
+    ALCdevice* opened;
+    SL_STATS_TIME(deviceOpenTime, opened = alcOpenDevice(device));
 
-    //read only. audio format is verified later when parsing bits per sample
-    blocksRead = fread(buffer2, 2, 1, file);
-    if (!blocksRead)
-        return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
-    wavBuf->formatChunk.audioFormat = sl_buf_to_native_ushort(buffer2, 2);
+    return opened;
+}
 
-    //read and validate num channels.
-    blocksRead = fread(buffer2, 2, 1, file);
-    wavBuf->formatChunk.numChannels = sl_buf_to_native_ushort(buffer2, 2);
-    if (!blocksRead || wavBuf->formatChunk.numChannels == 0)
-        return SL_INVALID_CHUNK_FMT_CHANNELS;
+DLL_EXPORT void sl_buffer_data(ALuint buffer, ALenum format, const ALvoid* data, ALsizei size, ALsizei freq) {
+    SL_STATS_TIME(uploadTime, alBufferData(buffer, format, data, size, freq));
+    SL_STATS_ADD(uploadedBytes, size);
+}
 
+DLL_EXPORT SLdouble sl_sound_length(SL_SOUND* sound) {
+    SLuint blockAlign = sound->waveBuf->formatChunk.blockAlign;
+    if (blockAlign == 0 || sound->freq == 0) return 0;
 
-    //read and validate sample rate
-    blocksRead = fread(buffer4, 4, 1, file);
-    wavBuf->formatChunk.sampleRate = sl_buf_to_native_uint(buffer4, 4);
-    if (!blocksRead || wavBuf->formatChunk.sampleRate == 0)
-        return SL_INVALID_CHUNK_FMT_SAMPLE_RATE;
+    // size is what OpenAL got, which may have been converted. the file still has the real frame count, ADPCM blocks included
+    return (SLdouble) sl_wave_frame_count(sound->waveBuf) / (SLdouble) sound->freq;
+}
 
+DLL_EXPORT SL_RETURN_CODE sl_gen_sound(SL_SOUND* sound, SLstr path, SLfloat gain, SLfloat pitch) {
+    SL_WAV_FILE buf;
+    SL_RETURN_CODE out = sl_read_wave_file(path, &buf);
 
-    //read and validate byte rate
-    blocksRead = fread(buffer4, 4, 1, file);
-    wavBuf->formatChunk.byteRate = sl_buf_to_native_uint(buffer4, 4);
-    if (!blocksRead || wavBuf->formatChunk.byteRate == 0)
-        return SL_INVALID_CHUNK_FMT_BYTE_RATE;
+    if (out == SL_SUCCESS) out = sl_gen_sound_a(sound, &buf, gain, pitch);
 
-    //read and validate block align
-    blocksRead = fread(buffer2, 2, 1, file);
-    wavBuf->formatChunk.blockAlign = sl_buf_to_native_ushort(buffer2, 2);
-    if (!blocksRead || wavBuf->formatChunk.blockAlign == 0)
-        return SL_INVALID_CHUNK_FMT_BLOCK_ALIGN;
+    return out;
+}
 
-    //read and validate bits per sample
-    blocksRead = fread(buffer2, 2, 1, file);
-    if (!blocksRead)
-        return SL_INVALID_CHUNK_FMT_BITS_PER_SAMPLE;
+DLL_EXPORT SL_RETURN_CODE sl_gen_sound_cached(SL_SOUND* sound, SL_WAV_CACHE* cache, SLstr path, SLfloat gain, SLfloat pitch) {
+    SL_WAV_FILE* buf;
+    SL_RETURN_CODE out = sl_cache_acquire(cache, path, &buf);
 
-    wavBuf->formatChunk.bitsPerSample = sl_buf_to_native_ushort(buffer2, 2);
+    if (out != SL_SUCCESS) return out;
 
-    if(wavBuf->formatChunk.audioFormat == 1) {
-        switch (wavBuf->formatChunk.bitsPerSample) {
-            case 8: {
-                wavBuf->dataChunk.pcmType = SL_UNSIGNED_8PCM;
-                break;
-            }
-            case 16: {
-                wavBuf->dataChunk.pcmType = SL_SIGNED_16PCM;
-                break;
-            }
-            case 24: {
-                wavBuf->dataChunk.pcmType = SL_SIGNED_24PCM;
-                break;
-            }
-            case 32: {
-                wavBuf->dataChunk.pcmType = SL_SIGNED_32PCM;
-                break;
-            }
-            default: break;
-        }
-    } else if (wavBuf->formatChunk.audioFormat == 3) {
-        switch (wavBuf->formatChunk.bitsPerSample) {
-            case 32: {
-                wavBuf->dataChunk.pcmType = SL_FLOAT_32PCM;
-                break;
-            }
-            case 64: {
-                wavBuf->dataChunk.pcmType = SL_FLOAT_64PCM;
-                break;
-            }
-            default: break;
-        }
-    } else {
-        return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+    out = sl_gen_sound_a(sound, buf, gain, pitch);
+    if (out != SL_SUCCESS) {
+        sl_cache_release(cache, buf);
+        return out;
     }
 
-    if (wavBuf->dataChunk.pcmType == 0)
-        return SL_INVALID_CHUNK_FMT_BITS_PER_SAMPLE;
-
+    sound->cache = cache;
     return SL_SUCCESS;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_read_wave_data_chunk(FILE* file, SL_WAV_FILE* wavBuf) {
-    SLuchar buffer4[4] = {0x00, 0x00, 0x00, 0x00};
-    SLullong blocksRead;
-    //read data chunk size
-    blocksRead = fread(buffer4, 4, 1, file);
-    wavBuf->dataChunk.dataChunkSize = sl_buf_to_native_uint(buffer4, 4);
-    if (!blocksRead || wavBuf->dataChunk.dataChunkSize == 0)
-        return SL_INVALID_CHUNK_DATA_SIZE;
+DLL_EXPORT SL_RETURN_CODE sl_engine_gen_sound_cached(SL_ENGINE* engine, SL_SOUND* sound, SL_WAV_CACHE* cache, SLstr path, SLfloat gain, SLfloat pitch) {
+    SL_WAV_FILE* buf;
+    SL_RETURN_CODE out = sl_cache_acquire(cache, path, &buf);
 
-    wavBuf->dataChunk.waveformData = malloc(wavBuf->dataChunk.dataChunkSize);
-    if (wavBuf->dataChunk.waveformData == NULL)
-        return SL_MALLOC_FAIL;
+    if (out != SL_SUCCESS) return out;
 
-    // Ensure the buffer size is even
-    blocksRead = fread(wavBuf->dataChunk.waveformData, wavBuf->dataChunk.dataChunkSize, 1, file);
-    if (!blocksRead)
-        return SL_INVALID_CHUNK_DATA_DATA;
+    out = sl_engine_gen_sound(engine, sound, buf, gain, pitch);
+    if (out != SL_SUCCESS) {
+        sl_cache_release(cache, buf);
+        return out;
+    }
 
+    sound->cache = cache;
     return SL_SUCCESS;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_validate_wave_data(SL_WAV_FILE* wavBuf) {
-    switch (wavBuf->dataChunk.pcmType) {
-        case SL_UNSIGNED_8PCM:
-        case SL_SIGNED_16PCM:
-        case SL_SIGNED_32PCM:
-        case SL_FLOAT_32PCM:
-        case SL_FLOAT_64PCM:
-            if (wavBuf->dataChunk.dataChunkSize % 2 != 0) return SL_INVALID_CHUNK_DATA_DATA;
-            break;
-        case SL_SIGNED_24PCM:
-            if (wavBuf->dataChunk.dataChunkSize % 3 != 0) return SL_INVALID_CHUNK_DATA_DATA;
-            break;
-        default:
-            return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+DLL_EXPORT SLstr* sl_get_devices(void) {
+    if (alcIsExtensionPresent(NULL, "ALC_ENUMERATE_ALL_EXT") != AL_TRUE) return NULL;
+
+    SLstr devices = alcGetString(NULL, ALC_ALL_DEVICES_SPECIFIER);
+    if (devices == NULL) return NULL;
+
+    SLstr device = devices;
+
+    SLullong numDevices = 0;
+    while (*device != '\0') {
+        device += strlen(device) + 1;
+        numDevices++;
+    }
+
+    // the array and a copy of the names after it, all in one allocation
+    SLullong namesSize = (SLullong) (device - devices) + 1;
+    SLstr* arr = (SLstr*)sl_malloc((numDevices + 1) * sizeof(SLstr) + namesSize);
+    if (arr == NULL) return NULL;
+
+    char* names = (char*) (arr + numDevices + 1);
+    memcpy(names, devices, namesSize);
+
+    // Point the array at the names
+    for (SLullong i = 0; i < numDevices; i++) {
+        arr[i] = names;
+        names += strlen(names) + 1;
+    }
+
+    // Null-terminate the array
+    arr[numDevices] = NULL;
+
+    return arr;
+}
+
+DLL_EXPORT void sl_destroy_device_list(SLstr** devices) {
+    if (devices != NULL && *devices != NULL) {
+        // the names live in the same block
+        sl_free(*devices);
+        *devices = NULL;
+    }
+}
+
+DLL_EXPORT SL_RETURN_CODE sl_gen_sound_stream(SL_SOUND_STREAM* stream, SLstr path, SLfloat gain, SLfloat pitch) {
+    SL_SOUND formatSound;
+    SL_RETURN_CODE ret;
+
+    if(stream == NULL) return SL_FAIL;
+
+    memset(stream, 0, sizeof(SL_SOUND_STREAM));
+
+    ret = sl_open_wave_stream(path, &stream->wavStream);
+    if (ret != SL_SUCCESS) return ret;
+
+    // borrow the normal format parser. it only looks at the format chunk
+    memset(&formatSound, 0, sizeof(SL_SOUND));
+    formatSound.waveBuf = &stream->wavStream.header;
+    ret = sl_parse_sound_format(&formatSound);
+    if (ret != SL_SUCCESS) goto streamCleanup;
+
+    stream->format = formatSound.format;
+    stream->dataType = formatSound.dataType;
+    stream->freq = stream->wavStream.header.formatChunk.sampleRate;
+    stream->gain = gain;
+    stream->pitch = pitch;
+
+    stream->blockFrames = (SLullong) stream->freq * SL_STREAM_BUFFER_MS / 1000;
+    if (stream->blockFrames == 0) stream->blockFrames = 1;
+
+    stream->block = sl_aligned_malloc(stream->blockFrames * stream->wavStream.header.formatChunk.blockAlign);
+    if (stream->block == NULL) {
+        ret = SL_MALLOC_FAIL;
+        goto streamCleanup;
+    }
+
+    // each block is converted as it is read when OpenAL can't take the file's samples
+    if (stream->dataType != stream->wavStream.header.dataChunk.pcmType) {
+        stream->converted = sl_aligned_malloc(stream->blockFrames * stream->wavStream.header.formatChunk.numChannels * sl_pcm_type_size(stream->dataType));
+        if (stream->converted == NULL) {
+            ret = SL_MALLOC_FAIL;
+            goto blockCleanup;
+        }
     }
+
     return SL_SUCCESS;
+
+    blockCleanup:
+        sl_free(stream->block);
+        stream->block = NULL;
+    streamCleanup:
+        sl_close_wave_stream(&stream->wavStream);
+        return ret;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_ensure_wave_endianness(SL_WAV_FILE* wavBuf) {
-    volatile SLbool endianness = sl_get_native_endianness();
-    if(endianness != SL_LITTLE_ENDIAN) {
-        switch (wavBuf->dataChunk.pcmType) {
-            case SL_UNSIGNED_8PCM:
-                break;
-            case SL_SIGNED_16PCM: {
-                SLshort* data = (SLshort*) wavBuf->dataChunk.waveformData;
-                SLullong len = wavBuf->dataChunk.dataChunkSize / 2;
-                for(SLullong i = 0; i < len; ++i) data[i] = sl_flip_endian_short(data[i]);
+DLL_EXPORT SL_RETURN_CODE sl_start_sound_stream(SL_SOUND_STREAM* stream, SLstr device) {
+    if(stream == NULL || stream->block == NULL) return SL_FAIL;
+
+    // Initialize OpenAL
+    stream->device = sl_open_device(device);
+    if (stream->device == NULL) return SL_FAIL;
+
+    stream->context = alcCreateContext(stream->device, NULL);
+    alcMakeContextCurrent(stream->context);
 
-                break;
-            }
-            case SL_SIGNED_24PCM: {
-                SLchar* data = (SLchar*) wavBuf->dataChunk.waveformData;
-                SLullong len = wavBuf->dataChunk.dataChunkSize / 3;
-                for(SLullong i = 0; i < len; ++i) {
-                    SLchar temp = data[i*3];
-                    data[i*3] = data[i*3+2];
-                    data[i*3+2] = temp;
-                }
-                break;
-            }
-            case SL_SIGNED_32PCM: {
-                SLint* data = (SLint*) wavBuf->dataChunk.waveformData;
-                SLullong len = wavBuf->dataChunk.dataChunkSize / 4;
-                for(SLullong i = 0; i < len; ++i) data[i] = sl_flip_endian_int(data[i]);
+    alGenBuffers(SL_STREAM_BUFFER_COUNT, stream->buffers);
+    alGenSources(1, &stream->source);
+    SL_STATS_ADD(activeVoices, 1);
 
-                break;
-            }
-            case SL_FLOAT_32PCM: {
-                SLfloat* data = (SLfloat*) wavBuf->dataChunk.waveformData;
-                SLullong len = wavBuf->dataChunk.dataChunkSize / 4;
-                for(SLullong i = 0; i < len; ++i) data[i] = sl_flip_endian_float(data[i]);
+    alSourcef(stream->source, AL_PITCH, stream->pitch);
+    alSourcef(stream->source, AL_GAIN, stream->gain);
 
-                break;
-            }
-            case SL_FLOAT_64PCM: {
-                SLdouble* data = (SLdouble*) wavBuf->dataChunk.waveformData;
-                SLullong len = wavBuf->dataChunk.dataChunkSize / 8;
-                for(SLullong i = 0; i < len; ++i)     data[i] = sl_flip_endian_double(data[i]);
+    // get the first block going before reading the rest so the sound starts as early as possible
+    if (!sl_fill_stream_buffer(stream, stream->buffers[0])) {
+        sl_stop_sound_stream(stream);
+        return SL_FAIL;
+    }
 
-                break;
-            }
-            default:
-                return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
-        }
+    alSourceQueueBuffers(stream->source, 1, &stream->buffers[0]);
+    alSourcePlay(stream->source);
+
+    for (SLuint i = 1; i < SL_STREAM_BUFFER_COUNT; i++) {
+        if (!sl_fill_stream_buffer(stream, stream->buffers[i])) break;
+        alSourceQueueBuffers(stream->source, 1, &stream->buffers[i]);
     }
+
     return SL_SUCCESS;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_is_wave_file(SLstr path) {
-    SLstr wavExtension = ".wav";
-    SLstr waveExtension = ".wave";
-    SLullong path_len = strlen(path);
-    SLullong wavExtensionLen = strlen(wavExtension);
-    SLullong waveExtensionLen = strlen(waveExtension);
-
-    if (wavExtensionLen > path_len && waveExtensionLen > path_len) return SL_FAIL;
+DLL_EXPORT SLbool sl_update_sound_stream(SL_SOUND_STREAM* stream) {
+    ALint processed = 0;
+    ALint queued = 0;
+    ALint state;
 
-    char* toCheck = (char*) malloc(sizeof(char) * path_len + 1);
+    if(stream == NULL || stream->source == 0) return 0;
 
-    if(toCheck == NULL) return SL_MALLOC_FAIL;
+    alcMakeContextCurrent(stream->context);
 
-    strcpy(toCheck, path);
+    alGetSourcei(stream->source, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buffer;
+        alSourceUnqueueBuffers(stream->source, 1, &buffer);
 
-    for (int i = path_len-1; i >= 0; i--) {
-        if(toCheck[i] == '.') break;
-        toCheck[i] = tolower(toCheck[i]);
+        if (sl_fill_stream_buffer(stream, buffer))
+            alSourceQueueBuffers(stream->source, 1, &buffer);
     }
 
-    SL_RETURN_CODE res = (strcmp(wavExtension, toCheck + path_len - wavExtensionLen) == 0 ||
-                  strcmp(waveExtension, toCheck + path_len - waveExtensionLen) == 0)
-                 ? SL_SUCCESS
-                 : SL_FAIL;
+    alGetSourcei(stream->source, AL_BUFFERS_QUEUED, &queued);
+    if (queued == 0) return 0;
 
-    free(toCheck);
-    return res;
+    // if we were too slow the source runs dry and stops. kick it again since there is more to play
+    alGetSourcei(stream->source, AL_SOURCE_STATE, &state);
+    if (state != AL_PLAYING && state != AL_PAUSED) alSourcePlay(stream->source);
+
+    return 1;
 }
 
-DLL_EXPORT SLushort sl_buf_to_native_ushort(const SLuchar* buf, SLullong bufLen) {
-    //who needs comments, am i right?
-    if(buf == NULL || bufLen < 2) return 0;
+DLL_EXPORT SL_RETURN_CODE sl_play_sound_stream(SLstr path, SLstr device, SLfloat gain, SLfloat pitch) {
+    SL_SOUND_STREAM stream;
+    SL_RETURN_CODE out = sl_gen_sound_stream(&stream, path, gain, pitch);
 
-    SLuint value;
-    volatile SLbool endianness = sl_get_native_endianness();
-    if(endianness == SL_LITTLE_ENDIAN) value = buf[0] | (buf[1] << 8);
-    else value = buf[1] | (buf[0] << 8);
+    if (out != SL_SUCCESS) return out;
 
-    return value;
-}
+    out = sl_start_sound_stream(&stream, device);
 
-DLL_EXPORT SLuint sl_buf_to_native_uint(const SLuchar* buf, SLullong bufLen) {
-    if(buf == NULL || bufLen < 4) return 0;
+    if (out == SL_SUCCESS) {
+        // half a buffer keeps the queue topped up without spinning
+        while (sl_update_sound_stream(&stream)) sl_sleep(SL_STREAM_BUFFER_MS / 2000.f);
+    }
 
-    SLuint value;
-    volatile SLbool endianness = sl_get_native_endianness();
-    if(endianness == SL_LITTLE_ENDIAN) value = buf[0] | (buf[1] << 8) | (buf[2] << 16) | (buf[3] << 24);
-    else value = buf[3] | (buf[2] << 8) | (buf[1] << 16) | (buf[0] << 24);
+    sl_cleanup_sound_stream(&stream);
 
-    return value;
+    return out;
 }
 
-DLL_EXPORT SLshort sl_flip_endian_short(SLshort s) {
-    return (s >> 8) | (s << 8);
-}
+DLL_EXPORT void sl_stop_sound_stream(SL_SOUND_STREAM* stream) {
+    if (stream->source) {
+        // stopping marks every queued buffer as processed so they can all be unqueued and deleted
+        alSourceStop(stream->source);
+        alSourcei(stream->source, AL_BUFFER, 0);
+        alDeleteSources(1, &stream->source);
+        stream->source = 0;
+        SL_STATS_ADD(activeVoices, -1);
+    }
 
-DLL_EXPORT SLint sl_flip_endian_int(SLint i) {
-    return ((i >> 24) & 0xff) |
-           ((i << 8) & 0xff0000) |
-           ((i >> 8) & 0xff00) |
-           ((i << 24) & 0xff000000);
-}
+    if (stream->buffers[0]) {
+        alDeleteBuffers(SL_STREAM_BUFFER_COUNT, stream->buffers);
+        memset(stream->buffers, 0, sizeof(stream->buffers));
+    }
 
-DLL_EXPORT SLfloat sl_flip_endian_float(SLfloat f) {
-    // i love c because of this right here
-    unsigned long num_int;
-    memcpy(&num_int, &f, sizeof(float));
+    if (stream->context) {
+        // Destroy the context
+        alcMakeContextCurrent(NULL);
+        alcDestroyContext(stream->context);
+        stream->context = NULL;
+    }
 
-    unsigned long swapped_int = ((num_int >> 24) & 0xff) |
-                                ((num_int << 8) & 0xff0000) |
-                                ((num_int >> 8) & 0xff00) |
-                                ((num_int << 24) & 0xff000000);
-    float swapped;
-    memcpy(&swapped, &swapped_int, sizeof(float));
-    return swapped;
+    if (stream->device) {
+        // Close the device
+        alcCloseDevice(stream->device);
+        stream->device = NULL;
+    }
 }
 
-DLL_EXPORT SLdouble sl_flip_endian_double(SLdouble d) {
-    // i love c because of this right here
-    uint64_t num_int;
-    memcpy(&num_int, &d, sizeof(double));
+DLL_EXPORT void sl_cleanup_sound_stream(SL_SOUND_STREAM* stream) {
+    if(stream != NULL) {
+        sl_stop_sound_stream(stream);
+        sl_close_wave_stream(&stream->wavStream);
 
-    uint64_t swapped_int = ((num_int >> 56) & 0x00000000000000ff) |
-                           ((num_int >> 40) & 0x000000000000ff00) |
-                           ((num_int >> 24) & 0x0000000000ff0000) |
-                           ((num_int >> 8)  & 0x00000000ff000000) |
-                           ((num_int << 8)  & 0x000000ff00000000) |
-                           ((num_int << 24) & 0x0000ff0000000000) |
-                           ((num_int << 40) & 0x00ff000000000000) |
-                           ((num_int << 56) & 0xff00000000000000);
+        if(stream->block != NULL) sl_free(stream->block);
+        stream->block = NULL;
 
-    double swapped;
-    memcpy(&swapped, &swapped_int, sizeof(double));
-    return swapped;
+        if(stream->converted != NULL) sl_free(stream->converted);
+        stream->converted = NULL;
+    }
 }
 
-////////////////////////////////////////////////////
-///////////////// OpenAL Wrapper ///////////////////
-////////////////////////////////////////////////////
-
-#ifdef SL_OPENAL_WRAPPER
+DLL_EXPORT SLbool sl_fill_stream_buffer(SL_SOUND_STREAM* stream, ALuint buffer) {
+    SLullong frames = sl_read_wave_stream(&stream->wavStream, stream->block, stream->blockFrames);
+    if (frames == 0) return 0;
 
-#include <AL/al.h>
-#include <AL/alc.h>
-#include <AL/alext.h>
+    if (stream->converted != NULL) {
+        SLuint channels = stream->wavStream.header.formatChunk.numChannels;
+        sl_convert_samples(stream->block, stream->wavStream.header.dataChunk.pcmType, stream->converted, stream->dataType, frames, channels, SL_CONVERT_DEFAULT);
+        sl_buffer_data(buffer, stream->format, stream->converted, (ALsizei) (frames * channels * sl_pcm_type_size(stream->dataType)), stream->freq);
+        return 1;
+    }
 
-////////////////////////////////////////////////////////////////
-///////////////// Wrapper Struct Definitions ///////////////////
-////////////////////////////////////////////////////////////////
+    sl_buffer_data(buffer, stream->format, stream->block, (ALsizei) (frames * stream->wavStream.header.formatChunk.blockAlign), stream->freq);
+    return 1;
+}
 
-DLL_EXPORT typedef struct sl_sound {
-    SL_WAV_FILE* waveBuf;
+DLL_EXPORT SL_RETURN_CODE sl_create_mixer(SL_MIXER* mixer, SLstr device) {
+    return sl_create_mixer_b(mixer, device, SL_MIXER_DEFAULT_FREQ, SL_MIXER_DEFAULT_VOICES);
+}
 
-    ALCdevice* device;
-    ALCcontext* context;
-    ALuint source;
-    ALuint buffer;
-    ALsizei size;
-    ALsizei freq;
-    ALenum format;
-    ALfloat duration;
-    ALfloat pitch; // in % so 1.0 is 100%, 0.5 is 50% and so on.
-    ALfloat gain; // in % so 1.0 is 100%, 0.5 is 50% and so on.
-} SL_SOUND;
+DLL_EXPORT SL_RETURN_CODE sl_create_mixer_b(SL_MIXER* mixer, SLstr device, SLuint freq, SLuint maxVoices) {
+    if(mixer == NULL || freq == 0 || maxVoices == 0) return SL_FAIL;
+
+    memset(mixer, 0, sizeof(SL_MIXER));
+    sl_mutex_init(&mixer->mutex);
+
+    mixer->freq = (ALsizei) freq;
+    mixer->maxVoices = maxVoices;
+    mixer->blockFrames = (SLullong) freq * SL_MIXER_BUFFER_MS / 1000;
+    if (mixer->blockFrames == 0) mixer->blockFrames = 1;
+
+    mixer->voices = (SL_MIXER_VOICE*) sl_malloc(maxVoices * sizeof(SL_MIXER_VOICE));
+    mixer->block = (SLfloat*) sl_aligned_malloc(mixer->blockFrames * 2 * sizeof(SLfloat));
+    // one more frame so interpolating the last frame of a sound can look past it
+    mixer->scratch = (SLfloat*) sl_aligned_malloc((SL_MIXER_SCRATCH_FRAMES + 1) * 2 * sizeof(SLfloat));
+    mixer->resampled = (SLfloat*) sl_aligned_malloc(SL_MIXER_SCRATCH_FRAMES * 2 * sizeof(SLfloat));
+    mixer->decoded = (SLshort*) sl_aligned_malloc(SL_MIXER_SCRATCH_FRAMES * 2 * sizeof(SLshort));
+    if (mixer->voices == NULL || mixer->block == NULL || mixer->scratch == NULL || mixer->resampled == NULL || mixer->decoded == NULL) {
+        sl_destroy_mixer(mixer);
+        return SL_MALLOC_FAIL;
+    }
 
-//////////////////////////////////////////////////////////////////
-///////////////// Wrapper Function Definitions ///////////////////
-//////////////////////////////////////////////////////////////////
+    mixer->device = sl_open_device(device);
+    if (mixer->device == NULL) goto mixerCleanup;
 
-/**
- * @brief Lowest level of playing a sound that this wrapper supports.
- * @param sound - Sound to play.
- * @param device - Device to play sound to.
- * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_play_sound(SL_SOUND* sound, SLstr device);
+    mixer->context = alcCreateContext(mixer->device, NULL);
+    if (mixer->context == NULL) goto mixerCleanup;
 
-/**
- * @brief Lower level way of playing a sound.
- * This function requires you to manually generate the sound you want to play.
- * Does NOT clean up after itself. Call sl_cleanup_sound() after using this.
- * @param sound - Sound to play.
- * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_play_sound_b(SL_SOUND* sound);
+    alcMakeContextCurrent(mixer->context);
 
-/**
- * @brief Plays sound in highest level way.
- * This function parses the WAVE file at the specified path, generates a SL_SOUND, plays the sound, and frees the memory for you.
- * @param path - Path of WAVE file to parse and play.
- * @param device - Device to play the audio to.
- * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
- * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
- * @return SL_SUCCESS if succeeded. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_play_sound_c(SLstr path, SLstr device, float gain, float pitch);
+    alGenBuffers(SL_STREAM_BUFFER_COUNT, mixer->buffers);
+    alGenSources(1, &mixer->source);
 
-/**
- * @brief Parses sound format for specified sound.
- * @param sound - Sound to parse sound format for.
- * @return SL_SUCCESS if proeprly parsed. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_sound_format(SL_SOUND* sound);
+    // queue silence right away so the source is always a few buffers ahead of what gets played
+    for (SLuint i = 0; i < SL_STREAM_BUFFER_COUNT; i++) {
+        sl_mixer_fill_buffer(mixer, mixer->buffers[i]);
+        alSourceQueueBuffers(mixer->source, 1, &mixer->buffers[i]);
+    }
 
-/**
- * @brief Parses PCM type of sound to mono (1 channel) for specified sound.
- * This is a helper function for generating sounds.
- * @param sound - Sound to parse PCM type for.
- * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_mono(SL_SOUND* sound);
+    alSourcePlay(mixer->source);
 
-/**
- * @brief Parses PCM type of sound to stereo (2 channels) for specified sound.
- * This is a helper function for generating sounds.
- * @param sound - Sound to parse PCM type for.
- * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_stereo(SL_SOUND* sound);
+    return SL_SUCCESS;
 
-/**
- * @brief Parses PCM type of sound to QUAD (4 channels) for specified sound.
- * This is a helper function for generating sounds.
- * @param sound - Sound to parse PCM type for.
- * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_quad(SL_SOUND* sound);
+    mixerCleanup:
+        sl_destroy_mixer(mixer);
+        return SL_FAIL;
+}
 
-/**
- * @brief Parses PCM type of sound to 5.1 (6 channels) for specified sound.
- * This is a helper function for generating sounds.
- * @param sound - Sound to parse PCM type for.
- * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_51(SL_SOUND* sound);
+DLL_EXPORT void sl_destroy_mixer(SL_MIXER* mixer) {
+    if (mixer == NULL) return;
 
-/**
- * @brief Parses PCM type of sound to 6.1 (7 channels) for specified sound.
- * This is a helper function for generating sounds.
- * @param sound - Sound to parse PCM type for.
- * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_61(SL_SOUND* sound);
+    if (mixer->source) {
+        alcMakeContextCurrent(mixer->context);
+        alSourceStop(mixer->source);
+        alSourcei(mixer->source, AL_BUFFER, 0);
+        alDeleteSources(1, &mixer->source);
+        mixer->source = 0;
+    }
 
-/**
- * @brief Parses PCM type of sound to 7.1 (8 channels) for specified sound.
- * This is a helper function for generating sounds.
- * @param sound - Sound to parse PCM type for.
- * @return SL_SUCCESS if parsed correctly. SL_FAIL otherwise.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_parse_71(SL_SOUND* sound);
+    if (mixer->buffers[0]) {
+        alDeleteBuffers(SL_STREAM_BUFFER_COUNT, mixer->buffers);
+        memset(mixer->buffers, 0, sizeof(mixer->buffers));
+    }
 
-/**
- * @brief Stops the sound if it is currently playing and cleans up OpenAL related things.
- * This does not free any other sound things. It simply stops the sound and cleans up OpenAL stuff.
- * @param sound - Sound to stop.
- */
-DLL_EXPORT static void sl_stop_sound(SL_SOUND* sound);
+    if (mixer->context) {
+        alcMakeContextCurrent(NULL);
+        alcDestroyContext(mixer->context);
+        mixer->context = NULL;
+    }
 
-/**
- * @brief Cleans up the sound.
- * Make sure to call this if you are doing things manually.
- * @param sound - Sound to clean up.
- */
-DLL_EXPORT static void sl_cleanup_sound(SL_SOUND* sound);
+    if (mixer->device) {
+        alcCloseDevice(mixer->device);
+        mixer->device = NULL;
+    }
 
-/**
- * @brief Generates a SL_SOUND from the provided parameters and stores it in the provided buffer.
- * @param sound - Buffer for the sound.
- * @param waveBuf - WAVE buffer for the sound.
- * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
- * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
- * @return SL_SUCCESS if everything went right. Anything else means something happened.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_gen_sound_a(SL_SOUND* sound, SL_WAV_FILE* waveBuf, SLfloat gain, SLfloat pitch);
+    // the sounds still playing shouldn't lock a mixer that is gone
+    for (SLuint i = 0; i < mixer->voiceCount; i++)
+        if (mixer->voices[i].sound->mixer == mixer) mixer->voices[i].sound->mixer = NULL;
+
+    sl_free(mixer->voices);
+    sl_free(mixer->block);
+    sl_free(mixer->scratch);
+    sl_free(mixer->decoded);
+    sl_free(mixer->resampled);
+    mixer->voices = NULL;
+    mixer->block = NULL;
+    mixer->scratch = NULL;
+    mixer->decoded = NULL;
+    mixer->resampled = NULL;
+    SL_STATS_ADD(activeVoices, -(SLllong) mixer->voiceCount);
+    mixer->voiceCount = 0;
+
+    sl_mutex_destroy(&mixer->mutex);
+}
 
-/**
- * @brief Generates a SL_SOUND from the provided parameters and stores it in the provided buffer.
- * @param sound - Buffer for the sound.
- * @param path - Path to the sound. Sound MUST be a WAVE file.
- * @param gain - Control the volume of the sound. (1.f is 100%, 0.5 is 50% and so on)
- * @param pitch - Control the speed/pitch of the sound. (1.f is 100%, 0.5 is 50% and so on)
- * @return SL_SUCCESS if everything went right. Anything else means something happened.
- */
-DLL_EXPORT static SL_RETURN_CODE sl_gen_sound(SL_SOUND* sound, SLstr path, SLfloat gain, SLfloat pitch);
+DLL_EXPORT SL_RETURN_CODE sl_mixer_play_sound(SL_MIXER* mixer, SL_SOUND* sound) {
+    SL_WAV_FILE* wav;
+    SL_MIXER_VOICE* voice;
+    SLullong frameCount;
 
-/**
- * @brief Returns an array of audio devices.
- * @return SLstr* array of audio devices.
- */
-DLL_EXPORT static SLstr* sl_get_devices(void);
+    if(mixer == NULL || mixer->voices == NULL || sound == NULL || sound->waveBuf == NULL) return SL_FAIL;
 
-/**
- * @brief Frees the device list that is returned by sl_get_devices(void).
- * Must be called on the device list that was returned to free it.
- * @param devices - Device list to free.
- */
-DLL_EXPORT static void sl_destroy_device_list(SLstr** devices);
+    wav = sound->waveBuf;
+    frameCount = sl_wave_frame_count(wav);
+    if (frameCount == 0) return SL_INVALID_CHUNK_FMT_AUDIO_FORMAT;
+    if (wav->formatChunk.numChannels != 1 && wav->formatChunk.numChannels != 2) return SL_INVALID_CHUNK_FMT_CHANNELS;
 
-//////////////////////////////////////////////////////////////////////
-///////////////// Wrapper Function Implementations ///////////////////
-//////////////////////////////////////////////////////////////////////
+    sl_mutex_lock(&mixer->mutex);
 
-DLL_EXPORT SL_RETURN_CODE sl_play_sound(SL_SOUND* sound, SLstr device) {
+    if (mixer->voiceCount == mixer->maxVoices) {
+        sl_mutex_unlock(&mixer->mutex);
+        return SL_FAIL;
+    }
 
-    if(sound == NULL) return SL_FAIL;
-    // Initialize OpenAL
-    sound->device = alcOpenDevice(device);
-    sound->context = alcCreateContext(sound->device, NULL);
-    alcMakeContextCurrent(sound->context);
+    voice = &mixer->voices[mixer->voiceCount++];
+    SL_STATS_ADD(activeVoices, 1);
+    voice->sound = sound;
+    voice->frame = 0;
+    voice->frac = 0;
+    voice->frameCount = frameCount;
+    memset(&voice->decoder, 0, sizeof(SL_ADPCM_DECODER));
+    sound->mixer = mixer;
 
-    // Generate a buffer
-    alGenBuffers(1, &sound->buffer);
+    sl_mutex_unlock(&mixer->mutex);
 
-    //Buffer stuff to data
-    alBufferData(sound->buffer, sound->format, sound->waveBuf->dataChunk.waveformData, sound->size, sound->freq);
+    return SL_SUCCESS;
+}
 
-    // Generate a source
-    if (sound->source) alDeleteSources(1, &sound->source);
-    alGenSources(1, &sound->source);
+DLL_EXPORT void sl_mixer_stop_sound(SL_MIXER* mixer, SL_SOUND* sound) {
+    if(mixer == NULL || mixer->voices == NULL) return;
 
-    // Set the pitch
-    alSourcef(sound->source, AL_PITCH, sound->pitch);
+    sl_mutex_lock(&mixer->mutex);
 
-    // Set the gain
-    alSourcef(sound->source, AL_GAIN, sound->gain);
+    for (SLuint i = 0; i < mixer->voiceCount;) {
+        if (mixer->voices[i].sound == sound) {
+            sound->mixer = NULL;
+            mixer->voices[i] = mixer->voices[--mixer->voiceCount];
+            SL_STATS_ADD(activeVoices, -1);
+        } else {
+            i++;
+        }
+    }
 
+    sl_mutex_unlock(&mixer->mutex);
+}
 
-    // Queue the buffer for playback
-    alSourceQueueBuffers(sound->source, 1, &sound->buffer);
+DLL_EXPORT SLuint sl_mixer_update(SL_MIXER* mixer) {
+    ALint processed = 0;
+    ALint state;
+    SLuint count;
 
-    // Start playback
-    alSourcePlay(sound->source);
+    if(mixer == NULL || mixer->source == 0) return 0;
 
-    // Wait for playback to finish
-    sl_sleep(sound->duration);
+    alcMakeContextCurrent(mixer->context);
 
-    //ensure it's done playing
-    ALint state;
-    do {
-        alGetSourcei(sound->source, AL_SOURCE_STATE, &state);
-    } while (state == AL_PLAYING);
+    alGetSourcei(mixer->source, AL_BUFFERS_PROCESSED, &processed);
+    while (processed-- > 0) {
+        ALuint buffer;
+        alSourceUnqueueBuffers(mixer->source, 1, &buffer);
+        sl_mixer_fill_buffer(mixer, buffer);
+        alSourceQueueBuffers(mixer->source, 1, &buffer);
+    }
 
-    // cleanup
-    sl_stop_sound(sound);
+    // if we were too slow the source runs dry and stops. the mixer never ends so always kick it again
+    alGetSourcei(mixer->source, AL_SOURCE_STATE, &state);
+    if (state != AL_PLAYING) alSourcePlay(mixer->source);
 
-    return SL_SUCCESS;
-}
+    sl_mutex_lock(&mixer->mutex);
+    count = mixer->voiceCount;
+    sl_mutex_unlock(&mixer->mutex);
 
-DLL_EXPORT SL_RETURN_CODE sl_play_sound_b(SL_SOUND* sound) {
-    return sl_play_sound(sound, NULL);
+    return count;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_play_sound_c(SLstr path, SLstr device, float gain, float pitch) {
-    SL_SOUND sound;
-    SL_WAV_FILE buf;
-    SL_RETURN_CODE out = sl_read_wave_file(path, &buf);
+DLL_EXPORT SLuint sl_mixer_mix(SL_MIXER* mixer, SLfloat* out, SLullong frameCount) {
+    SLuint count;
 
-    if (out != SL_SUCCESS) return out;
+    memset(out, 0, frameCount * 2 * sizeof(SLfloat));
 
-    out = sl_gen_sound_a(&sound, &buf, gain, pitch);
+    sl_mutex_lock(&mixer->mutex);
 
-    if (out != SL_SUCCESS) {
-        sl_cleanup_wave_file(&buf);
-        return out;
+    for (SLuint i = 0; i < mixer->voiceCount;) {
+        if (sl_mixer_mix_voice(mixer, &mixer->voices[i], out, frameCount)) i++;
+        // done. the last voice takes its slot so the list stays packed
+        else {
+            mixer->voices[i] = mixer->voices[--mixer->voiceCount];
+            SL_STATS_ADD(activeVoices, -1);
+        }
     }
 
-    out = sl_play_sound(&sound, device);
-
-    sl_cleanup_sound(&sound);
+    count = mixer->voiceCount;
+    sl_mutex_unlock(&mixer->mutex);
 
-    return out;
+    return count;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_sound_format(SL_SOUND* sound) {
-    SL_RETURN_CODE ret;
+DLL_EXPORT SLbool sl_mixer_mix_voice(SL_MIXER* mixer, SL_MIXER_VOICE* voice, SLfloat* out, SLullong frameCount) {
+    SL_WAV_FILE* wav = voice->sound->waveBuf;
+    SLuint channels = wav->formatChunk.numChannels;
+    SLfloat gain = voice->sound->gain;
+    // source frames we move through for each output frame
+    SLdouble step = (SLdouble) voice->sound->pitch * wav->formatChunk.sampleRate / mixer->freq;
+    SLullong done = 0;
 
-    switch(sound->waveBuf->formatChunk.numChannels) {
-        case 1: {
-            ret = sl_parse_mono(sound);
-            break;
-        }
-        case 2: {
-            ret = sl_parse_stereo(sound);
-            break;
-        }
-        case 4: {
-            ret = sl_parse_quad(sound);
-            break;
+    // a pitch of 0 holds the voice where it is
+    if (!(step > 0)) return 1;
+
+    while (done < frameCount && voice->frame < voice->frameCount) {
+        SLullong left = voice->frameCount - voice->frame;
+        SLullong n = frameCount - done;
+        SLullong need, k;
+
+        if (n > SL_MIXER_SCRATCH_FRAMES) n = SL_MIXER_SCRATCH_FRAMES;
+
+        if (step == 1.0 && voice->frac == 0) {
+            // same rate and no pitch change. the samples go straight in
+            if (n > left) n = left;
+
+            sl_mixer_decode(mixer, voice, n);
+            sl_mixer_accumulate(out + done * 2, mixer->scratch, gain, n, channels);
+
+            voice->frame += n;
+            done += n;
+            continue;
         }
-        case 6: {
-            ret = sl_parse_51(sound);
-            break;
+
+        // linear interpolation between the two source frames around each output frame.
+        // only the source frames this piece of output lands between get decoded
+        need = (SLullong) (voice->frac + (n - 1) * step) + 2;
+        if (need > SL_MIXER_SCRATCH_FRAMES) {
+            n = (SLullong) ((SL_MIXER_SCRATCH_FRAMES - 2 - voice->frac) / step) + 1;
+            need = (SLullong) (voice->frac + (n - 1) * step) + 2;
+            if (need > SL_MIXER_SCRATCH_FRAMES) need = SL_MIXER_SCRATCH_FRAMES;
         }
-        case 7: {
-            ret = sl_parse_61(sound);
-            break;
+        if (need > left) need = left;
+
+        sl_mixer_decode(mixer, voice, need);
+        // after the end of the sound is silence
+        memset(mixer->scratch + need * channels, 0, channels * sizeof(SLfloat));
+
+        for (k = 0; k < n; ++k) {
+            SLdouble pos = voice->frac + k * step;
+            SLullong i = (SLullong) pos;
+            SLfloat t = (SLfloat) (pos - i);
+            const SLfloat* a = mixer->scratch + i * channels;
+
+            if (i >= need) break;
+
+            mixer->resampled[k * channels] = a[0] + (a[channels] - a[0]) * t;
+            if (channels == 2) mixer->resampled[k * 2 + 1] = a[1] + (a[3] - a[1]) * t;
         }
-        case 8: {
-            ret = sl_parse_71(sound);
+
+        sl_mixer_accumulate(out + done * 2, mixer->resampled, gain, k, channels);
+        done += k;
+
+        if (k < n) {
+            // ran off the end of the sound
+            voice->frame = voice->frameCount;
             break;
         }
-        default: {
-            ret = SL_FAIL;
-            break;
+
+        {
+            SLdouble pos = voice->frac + k * step;
+            SLullong whole = (SLullong) pos;
+            voice->frame += whole;
+            voice->frac = pos - whole;
         }
     }
 
-    return ret;
+    return voice->frame < voice->frameCount;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_mono(SL_SOUND* sound) {
-    switch(sound->waveBuf->dataChunk.pcmType) {
-        case SL_UNSIGNED_8PCM: {
-            sound->format = AL_FORMAT_MONO8;
-            break;
-        }
-        case SL_SIGNED_16PCM: {
-            sound->format = AL_FORMAT_MONO16;
-            break;
-        }
-        case SL_FLOAT_32PCM: {
-            sound->format = AL_FORMAT_MONO_FLOAT32;
-            break;
-        }
-        case SL_FLOAT_64PCM: {
-            sound->format = AL_FORMAT_MONO_DOUBLE_EXT;
-            break;
-        }
-        default:
-            return SL_FAIL;
+DLL_EXPORT void sl_mixer_decode(SL_MIXER* mixer, SL_MIXER_VOICE* voice, SLullong frameCount) {
+    const SL_CONVERT_KERNELS* kernels = sl_get_convert_kernels();
+    SL_WAV_FILE* wav = voice->sound->waveBuf;
+    SLuint channels = wav->formatChunk.numChannels;
+
+    // compressed sounds only ever have the frames being mixed decoded. the voice's decoder carries on where the last buffer stopped
+    if (wav->dataChunk.pcmType == SL_IMA_ADPCM) {
+        sl_decode_adpcm(wav, &voice->decoder, voice->frame, mixer->decoded, frameCount);
+        kernels->decode[SL_SIGNED_16PCM](mixer->decoded, mixer->scratch, frameCount * channels);
+        return;
     }
-    return SL_SUCCESS;
+
+    kernels->decode[wav->dataChunk.pcmType]((const SLuchar*) wav->dataChunk.waveformData + voice->frame * sl_pcm_type_size(wav->dataChunk.pcmType) * channels,
+                                            mixer->scratch, frameCount * channels);
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_stereo(SL_SOUND* sound) {
-    switch(sound->waveBuf->dataChunk.pcmType) {
-        case SL_UNSIGNED_8PCM: {
-            sound->format = AL_FORMAT_STEREO8;
-            break;
-        }
-        case SL_SIGNED_16PCM: {
-            sound->format = AL_FORMAT_STEREO16;
-            break;
-        }
-        case SL_FLOAT_32PCM: {
-            sound->format = AL_FORMAT_STEREO_FLOAT32;
-            break;
-        }
-        case SL_FLOAT_64PCM: {
-            sound->format = AL_FORMAT_STEREO_DOUBLE_EXT;
-            break;
-        }
-        default:
-            return SL_FAIL;
-    }
-    return SL_SUCCESS;
+DLL_EXPORT void sl_mixer_accumulate(SLfloat* out, const SLfloat* in, SLfloat gain, SLullong frameCount, SLuint channels) {
+    const SL_CONVERT_KERNELS* kernels = sl_get_convert_kernels();
+
+    if (channels == 1) kernels->mixMono(out, in, gain, frameCount);
+    else kernels->mix(out, in, gain, frameCount * 2);
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_quad(SL_SOUND* sound) {
-    switch(sound->waveBuf->dataChunk.pcmType) {
-        case SL_UNSIGNED_8PCM: {
-            sound->format = AL_FORMAT_QUAD8;
-            break;
-        }
-        case SL_SIGNED_16PCM: {
-            sound->format = AL_FORMAT_QUAD16;
-            break;
-        }
-        case SL_SIGNED_32PCM: {
-            sound->format = AL_FORMAT_QUAD32;
-            break;
-        }
-        case SL_FLOAT_32PCM: {
-            sound->format = AL_FORMAT_UHJ4CHN_FLOAT32_SOFT;
-            break;
-        }
-        default:
-            return SL_FAIL;
-    }
-    return SL_SUCCESS;
+DLL_EXPORT void sl_mixer_fill_buffer(SL_MIXER* mixer, ALuint buffer) {
+    sl_mixer_mix(mixer, mixer->block, mixer->blockFrames);
+    sl_buffer_data(buffer, AL_FORMAT_STEREO_FLOAT32, mixer->block, (ALsizei) (mixer->blockFrames * 2 * sizeof(SLfloat)), mixer->freq);
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_51(SL_SOUND* sound) {
-    switch(sound->waveBuf->dataChunk.pcmType) {
-        case SL_UNSIGNED_8PCM: {
-            sound->format = AL_FORMAT_51CHN8;
-            break;
-        }
-        case SL_SIGNED_16PCM: {
-            sound->format = AL_FORMAT_51CHN16;
-            break;
-        }
-        case SL_SIGNED_32PCM: {
-            sound->format = AL_FORMAT_51CHN32;
-            break;
-        }
-        default:
-            return SL_FAIL;
-    }
+DLL_EXPORT SL_RETURN_CODE sl_create_command_queue(SL_COMMAND_QUEUE* queue, SLuint capacity) {
+    SLullong size = 2;
+
+    memset(queue, 0, sizeof(SL_COMMAND_QUEUE));
+
+    if (capacity == 0) capacity = SL_COMMAND_QUEUE_DEFAULT_CAPACITY;
+    while (size < capacity) size <<= 1;
+
+    queue->slots = (SL_COMMAND_SLOT*) sl_malloc(size * sizeof(SL_COMMAND_SLOT));
+    if (queue->slots == NULL) return SL_MALLOC_FAIL;
+
+    // every slot starts out free for the first lap
+    for (SLullong i = 0; i < size; ++i) queue->slots[i].sequence = i;
+    queue->mask = size - 1;
+
     return SL_SUCCESS;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_61(SL_SOUND* sound) {
-    switch(sound->waveBuf->dataChunk.pcmType) {
-        case SL_UNSIGNED_8PCM: {
-            sound->format = AL_FORMAT_61CHN8;
-            break;
-        }
-        case SL_SIGNED_16PCM: {
-            sound->format = AL_FORMAT_61CHN16;
-            break;
-        }
-        case SL_SIGNED_32PCM: {
-            sound->format = AL_FORMAT_61CHN32;
-            break;
-        }
-        default:
-            return SL_FAIL;
+DLL_EXPORT void sl_destroy_command_queue(SL_COMMAND_QUEUE* queue) {
+    if (queue != NULL) {
+        sl_free(queue->slots);
+        queue->slots = NULL;
     }
-    return SL_SUCCESS;
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_parse_71(SL_SOUND* sound) {
-    switch(sound->waveBuf->dataChunk.pcmType) {
-        case SL_UNSIGNED_8PCM: {
-            sound->format = AL_FORMAT_71CHN8;
-            break;
-        }
-        case SL_SIGNED_16PCM: {
-            sound->format = AL_FORMAT_71CHN16;
-            break;
-        }
-        case SL_SIGNED_32PCM: {
-            sound->format = AL_FORMAT_71CHN32;
-            break;
-        }
-        default:
+DLL_EXPORT SL_RETURN_CODE sl_push_command(SL_COMMAND_QUEUE* queue, SLuint type, SL_SOUND* sound, SLfloat value) {
+    SL_COMMAND_SLOT* slot;
+    SLullong pos;
+
+    // only engine sounds are quick to run. the rest open or close a device on the audio thread
+    if (sound == NULL || sound->engine == NULL) return SL_INVALID_VALUE;
+
+    pos = sl_atomic_load(&queue->tail);
+    for (;;) {
+        SLllong diff;
+
+        slot = &queue->slots[pos & queue->mask];
+        diff = (SLllong) (sl_atomic_load(&slot->sequence) - pos);
+
+        if (diff == 0) {
+            // free. claim it before another producer does. on a miss pos is the new tail
+            if (sl_atomic_cas(&queue->tail, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            // the audio thread has not run this slot from the last lap yet
             return SL_FAIL;
+        } else {
+            // another producer claimed it first
+            pos = sl_atomic_load(&queue->tail);
+        }
     }
-    return SL_SUCCESS;
-}
 
-DLL_EXPORT void sl_stop_sound(SL_SOUND* sound) {
-    if (sound->source) {
-        // Stop the source and delete the source
-        alSourceStop(sound->source);
-        alDeleteSources(1, &sound->source);
-        sound->source = 0;
-    }
+    slot->command.type = type;
+    slot->command.sound = sound;
+    slot->command.value = value;
 
-    if (sound->buffer) {
-        // Delete the buffer
-        alDeleteBuffers(1, &sound->buffer);
-        sound->buffer = 0;
-    }
+    // hand it to the audio thread. it won't look at the command until it sees this
+    sl_atomic_store(&slot->sequence, pos + 1);
 
-    if (sound->context) {
-        // Destroy the context
-        alcMakeContextCurrent(NULL);
-        alcDestroyContext(sound->context);
-        sound->context = NULL;
-    }
+    return SL_SUCCESS;
+}
 
-    if (sound->device) {
-        // Close the device
-        alcCloseDevice(sound->device);
-        sound->device = NULL;
-    }
+DLL_EXPORT SL_RETURN_CODE sl_queue_play_sound(SL_COMMAND_QUEUE* queue, SL_SOUND* sound) {
+    return sl_push_command(queue, SL_COMMAND_PLAY, sound, 0);
 }
 
-DLL_EXPORT void sl_cleanup_sound(SL_SOUND* sound) {
-    if(sound != NULL) {
-        //stop sound
-        sl_stop_sound(sound);
+DLL_EXPORT SL_RETURN_CODE sl_queue_stop_sound(SL_COMMAND_QUEUE* queue, SL_SOUND* sound) {
+    return sl_push_command(queue, SL_COMMAND_STOP, sound, 0);
+}
 
-        //free wav file
-        sl_cleanup_wave_file(sound->waveBuf);
-        sound->waveBuf = NULL;
-    }
+DLL_EXPORT SL_RETURN_CODE sl_queue_set_gain(SL_COMMAND_QUEUE* queue, SL_SOUND* sound, SLfloat gain) {
+    return sl_push_command(queue, SL_COMMAND_SET_GAIN, sound, gain);
 }
 
-DLL_EXPORT SL_RETURN_CODE sl_gen_sound_a(SL_SOUND* sound, SL_WAV_FILE* waveBuf, SLfloat gain, SLfloat pitch) {
+DLL_EXPORT SL_RETURN_CODE sl_queue_set_pitch(SL_COMMAND_QUEUE* queue, SL_SOUND* sound, SLfloat pitch) {
+    return sl_push_command(queue, SL_COMMAND_SET_PITCH, sound, pitch);
+}
 
-    if(waveBuf == NULL) return SL_FAIL;
+DLL_EXPORT SLuint sl_run_commands(SL_COMMAND_QUEUE* queue) {
+    SLuint count = 0;
 
-    memset(sound, 0, sizeof(SL_SOUND));
+    if (queue == NULL || queue->slots == NULL) return 0;
 
-    sound->waveBuf = waveBuf;
-    sound->gain    = gain;
-    sound->pitch   = pitch;
-    sound->freq    = waveBuf->formatChunk.sampleRate;
-    sound->size    = waveBuf->dataChunk.dataChunkSize;
+    while (count <= queue->mask) {
+        SL_COMMAND_SLOT* slot = &queue->slots[queue->head & queue->mask];
+        SL_COMMAND command;
 
-    SLint denom = sound->freq * waveBuf->formatChunk.numChannels * (waveBuf->formatChunk.bitsPerSample / 8);
-    sound->duration = ((sound->size / denom) / pitch) + 0.5;
+        // empty, or the producer that claimed it is still writing
+        if (sl_atomic_load(&slot->sequence) != queue->head + 1) break;
 
-    return sl_parse_sound_format(sound);
-}
+        command = slot->command;
 
-DLL_EXPORT SL_RETURN_CODE sl_gen_sound(SL_SOUND* sound, SLstr path, SLfloat gain, SLfloat pitch) {
-    SL_WAV_FILE buf;
-    SL_RETURN_CODE out = sl_read_wave_file(path, &buf);
+        // free the slot for the next lap before running anything slow
+        sl_atomic_store(&slot->sequence, queue->head + queue->mask + 1);
+        queue->head++;
 
-    if (out == SL_SUCCESS) out = sl_gen_sound_a(sound, &buf, gain, pitch);
+        sl_run_command(&command);
+        count++;
+    }
 
-    return out;
+    return count;
 }
 
-DLL_EXPORT SLstr* sl_get_devices(void) {
-    if (alcIsExtensionPresent(NULL, "ALC_ENUMERATE_ALL_EXT") != AL_TRUE) return NULL;
-
-    SLstr devices = alcGetString(NULL, ALC_ALL_DEVICES_SPECIFIER);
-    if (devices == NULL) return NULL;
-
-    SLstr device = devices;
+DLL_EXPORT void sl_run_command(const SL_COMMAND* command) {
+    // sl_push_command never lets these in
+    if (command->sound == NULL || command->sound->engine == NULL) return;
 
-    SLullong numDevices = 0;
-    while (*device != '\0') {
-        device += strlen(device) + 1;
-        numDevices++;
+    switch (command->type) {
+        case SL_COMMAND_PLAY: sl_start_sound(command->sound, NULL); break;
+        case SL_COMMAND_STOP: sl_stop_sound(command->sound); break;
+        case SL_COMMAND_SET_GAIN: sl_set_sound_param(command->sound, AL_GAIN, command->value); break;
+        case SL_COMMAND_SET_PITCH: sl_set_sound_param(command->sound, AL_PITCH, command->value); break;
+        default: break;
     }
+}
 
-    // Allocate memory for the array of device names
-    SLstr* arr = (SLstr*)malloc((numDevices + 1) * sizeof(SLstr));
-    if (arr == NULL) return NULL;
+DLL_EXPORT void sl_set_sound_param(SL_SOUND* sound, ALenum param, SLfloat value) {
+    if (sound->engine != NULL) {
+        SL_ENGINE* engine = sound->engine;
 
-    // Copy the device names into the array
-    device = devices;
-    for (SLullong i = 0; i < numDevices; i++) {
-        SLullong len = strlen(device);
-        arr[i] = strdup(device);
-        if (arr[i] == NULL) {
-            // clean up and return NULL
-            for (SLullong j = 0; j < i; j++) {
-                free((void*)arr[j]);
-            }
-            free(arr);
-            return NULL;
+        sl_engine_make_current(engine);
+        sl_mutex_lock(&engine->mutex);
+
+        // a virtual voice's position comes from its pitch, so move its start to keep it where it is
+        if (param == AL_PITCH && sound->voiceState == SL_VOICE_VIRTUAL && value > 0) {
+            SLdouble now = sl_get_time();
+            sound->voiceStart = now - (now - sound->voiceStart) * sound->pitch / value;
         }
-        device += len + 1;
-    }
 
-    // Null-terminate the array
-    arr[numDevices] = NULL;
+        if (param == AL_GAIN) sound->gain = value;
+        else sound->pitch = value;
 
-    return arr;
-}
+        if (sound->voiceState == SL_VOICE_REAL) alSourcef(engine->sources[sound->voiceSource], param, value);
 
-DLL_EXPORT void sl_destroy_device_list(SLstr** devices) {
-    if (devices != NULL && *devices != NULL) {
-        // free device names
-        for (SLullong i = 0; (*devices)[i] != NULL; i++) free((void*)((*devices)[i]));
+        sl_mutex_unlock(&engine->mutex);
+        return;
+    }
 
-        free(*devices);
-        *devices = NULL;
+    // a mixer reads them while it mixes on its own thread
+    if (sound->mixer != NULL) {
+        sl_mutex_lock(&sound->mixer->mutex);
+        if (param == AL_GAIN) sound->gain = value;
+        else sound->pitch = value;
+        sl_mutex_unlock(&sound->mixer->mutex);
+    } else {
+        if (param == AL_GAIN) sound->gain = value;
+        else sound->pitch = value;
+    }
+
+    if (sound->source) {
+        // with more than one sound around the current context may not be this one
+        if (sound->context) alcMakeContextCurrent(sound->context);
+        alSourcef(sound->source, param, value);
     }
 }
 
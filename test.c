@@ -6,7 +6,942 @@
 //#define AL_TEST
 #define SIMPLE_SOUND_TEST
 
-#ifdef PARSER_TEST
+// UNIT_TEST is defined by the sal_unit_test target. it needs no sound device or input, so ctest can run it
+#ifdef UNIT_TEST
+
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+// small fixed generator so every run checks the same numbers
+static SLuint test_seed = 12345;
+static SLuint test_random(void) {
+    test_seed = test_seed * 1664525u + 1013904223u;
+    return test_seed >> 8;
+}
+
+// every SIMD level has to give exactly what the plain C loops give, tails included
+static void check_simd_parity(void) {
+    static SLuchar src[8 * 1040];
+    static SLfloat in[1040];
+    static SLfloat scalarOut[1040], simdOut[1040];
+    static SLuchar scalarBytes[8 * 1040], simdBytes[8 * 1040];
+    static SLfloat noise[1040], other[1040];
+    const SL_CONVERT_KERNELS* scalar;
+
+    sl_set_simd_level(SL_SIMD_SCALAR);
+    scalar = sl_get_convert_kernels();
+
+    for (SLint level = SL_SIMD_SSE2; level <= SL_SIMD_AVX2; level++) {
+        const SL_CONVERT_KERNELS* kernels;
+
+        // the CPU doesn't have it
+        sl_set_simd_level(level);
+        if (sl_get_simd_level() != (SLuint) level) continue;
+        kernels = sl_get_convert_kernels();
+
+        for (SLuint type = SL_UNSIGNED_8PCM; type <= SL_FLOAT_64PCM; type++) {
+            SLuint size = sl_pcm_type_size(type);
+
+            // every count up to a few vectors, then some bigger odd ones
+            for (SLullong count = 0; count < 1040; count += count < 70 ? 1 : 97) {
+                for (SLullong i = 0; i < count * size; i++) src[i] = (SLuchar) test_random();
+                if (type == SL_FLOAT_32PCM) for (SLullong i = 0; i < count; i++) ((SLfloat*) src)[i] = ((SLint) test_random() - (1 << 23)) / (SLfloat) (1 << 22);
+                if (type == SL_FLOAT_64PCM) for (SLullong i = 0; i < count; i++) ((SLdouble*) src)[i] = ((SLint) test_random() - (1 << 23)) / (SLdouble) (1 << 22);
+
+                scalar->decode[type](src, scalarOut, count);
+                kernels->decode[type](src, simdOut, count);
+                CHECK(memcmp(scalarOut, simdOut, count * sizeof(SLfloat)) == 0);
+
+                // past full scale and the values that round halfway
+                for (SLullong i = 0; i < count; i++) in[i] = ((SLint) test_random() - (1 << 23)) / (SLfloat) (1 << 22) * 1.2f;
+                if (count > 4) {
+                    in[0] = 1.0f;
+                    in[1] = -1.0f;
+                    in[2] = 0.5f / 32768;
+                    in[3] = -1.5f / 32768;
+                }
+
+                scalar->encode[type](in, NULL, scalarBytes, count);
+                kernels->encode[type](in, NULL, simdBytes, count);
+                CHECK(memcmp(scalarBytes, simdBytes, count * size) == 0);
+
+                if (size > 1) {
+                    memcpy(scalarBytes, src, count * size);
+                    memcpy(simdBytes, src, count * size);
+                    scalar->swap(scalarBytes, count, size);
+                    kernels->swap(simdBytes, count, size);
+                    CHECK(memcmp(scalarBytes, simdBytes, count * size) == 0);
+                }
+            }
+        }
+
+        // dither, mixing and the resampler's dot product
+        for (SLullong count = 0; count < 1040; count += count < 70 ? 1 : 97) {
+            SLuint scalarState[8], simdState[8];
+            SLfloat gain = (SLfloat) test_random() / (1 << 24) * 2.0f;
+
+            for (SLuint k = 0; k < 8; k++) scalarState[k] = simdState[k] = test_random() | 1;
+            scalar->noise(scalarState, noise, count);
+            kernels->noise(simdState, simdOut, count);
+            CHECK(memcmp(noise, simdOut, count * sizeof(SLfloat)) == 0);
+            CHECK(memcmp(scalarState, simdState, sizeof(scalarState)) == 0);
+
+            for (SLullong i = 0; i < count; i++) {
+                in[i] = ((SLint) test_random() - (1 << 23)) / (SLfloat) (1 << 22) * 1.2f;
+                other[i] = ((SLint) test_random() - (1 << 23)) / (SLfloat) (1 << 23);
+            }
+
+            for (SLuint type = SL_UNSIGNED_8PCM; type <= SL_SIGNED_32PCM; type++) {
+                scalar->encode[type](in, noise, scalarBytes, count);
+                kernels->encode[type](in, noise, simdBytes, count);
+                CHECK(memcmp(scalarBytes, simdBytes, count * sl_pcm_type_size(type)) == 0);
+            }
+
+            memcpy(scalarOut, in, count * sizeof(SLfloat));
+            memcpy(simdOut, in, count * sizeof(SLfloat));
+            scalar->mix(scalarOut, other, gain, count);
+            kernels->mix(simdOut, other, gain, count);
+            CHECK(memcmp(scalarOut, simdOut, count * sizeof(SLfloat)) == 0);
+
+            // count / 2 mono frames into as many stereo ones
+            memcpy(scalarOut, in, count * sizeof(SLfloat));
+            memcpy(simdOut, in, count * sizeof(SLfloat));
+            scalar->mixMono(scalarOut, other, gain, count / 2);
+            kernels->mixMono(simdOut, other, gain, count / 2);
+            CHECK(memcmp(scalarOut, simdOut, count * sizeof(SLfloat)) == 0);
+
+            CHECK(scalar->dot(in, other, count & ~7ULL) == kernels->dot(in, other, count & ~7ULL));
+        }
+    }
+
+    sl_set_simd_level(-1);
+}
+
+static void put_le(SLuchar* dst, SLuint value, SLuint size) {
+    for (SLuint i = 0; i < size; i++) dst[i] = (SLuchar) (value >> (8 * i));
+}
+
+// a mono 16 bit WAVE file with frameCount frames of a ramp
+static SLullong make_test_wave(SLuchar* dst, SLuint frameCount) {
+    memcpy(dst, "RIFF", 4);
+    put_le(dst + 4, 36 + frameCount * 2, 4);
+    memcpy(dst + 8, "WAVEfmt ", 8);
+    put_le(dst + 16, 16, 4);
+    put_le(dst + 20, 1, 2);
+    put_le(dst + 22, 1, 2);
+    put_le(dst + 24, 22050, 4);
+    put_le(dst + 28, 22050 * 2, 4);
+    put_le(dst + 32, 2, 2);
+    put_le(dst + 34, 16, 2);
+    memcpy(dst + 36, "data", 4);
+    put_le(dst + 40, frameCount * 2, 4);
+    for (SLuint i = 0; i < frameCount; i++) put_le(dst + 44 + i * 2, (SLuint) (SLshort) (i * 37 - 1000), 2);
+    return 44 + frameCount * 2;
+}
+
+// puts bytes in a file for the checks that need one on disk
+static SLbool write_test_file(const char* path, const void* data, SLullong size) {
+    FILE* file = fopen(path, "wb");
+    SLbool ok;
+
+    if (file == NULL) return 0;
+    ok = fwrite(data, 1, (size_t) size, file) == size;
+    fclose(file);
+    return ok;
+}
+
+// a mapped file has the same samples as a read one and gives the mapping back when it is cleaned up
+static void check_map(void) {
+    static const char* path = "sal_unit_test_map.wav";
+    static SLuchar wave[44 + 2 * 500];
+    SL_WAV_FILE copy, mapped;
+
+    CHECK(write_test_file(path, wave, make_test_wave(wave, 500)));
+    CHECK(sl_read_wave_file(path, &copy) == SL_SUCCESS);
+
+    CHECK(sl_map_wave_file(path, &mapped, SL_MAP_ADVICE_SEQUENTIAL) == SL_SUCCESS);
+    CHECK(mapped.storage == SL_STORAGE_MAPPED && mapped.storageBase != NULL);
+    CHECK(mapped.formatChunk.sampleRate == 22050 && mapped.dataChunk.pcmType == SL_SIGNED_16PCM);
+    CHECK(mapped.dataChunk.dataChunkSize == copy.dataChunk.dataChunkSize &&
+          memcmp(mapped.dataChunk.waveformData, copy.dataChunk.waveformData, copy.dataChunk.dataChunkSize) == 0);
+    CHECK(sl_advise_wave_file(&mapped, SL_MAP_ADVICE_RANDOM) == SL_SUCCESS);
+    CHECK(sl_advise_wave_file(&copy, SL_MAP_ADVICE_RANDOM) == SL_INVALID_VALUE);
+
+    sl_cleanup_wave_file(&mapped);
+    CHECK(mapped.storageBase == NULL && mapped.dataChunk.waveformData == NULL);
+    sl_cleanup_wave_file(&copy);
+
+    // samples that run past the end of the file
+    CHECK(write_test_file(path, wave, 44 + 2 * 400));
+    CHECK(sl_map_wave_file(path, &mapped, SL_MAP_ADVICE_NORMAL) == SL_INVALID_CHUNK_DATA_DATA);
+
+    remove(path);
+}
+
+// a file streamed in uneven pieces, and after seeking, gives the same frames as reading it all at once
+static void check_stream(void) {
+    static const char* path = "sal_unit_test_stream.wav";
+    static SLuchar wave[44 + 2 * 3000];
+    static SLshort frames[3000];
+    SL_WAV_STREAM stream;
+    SL_WAV_FILE whole;
+    const SLuchar* expected;
+    SLullong done = 0, step = 1;
+
+    // bigger than the handle's buffer so reads go around it too
+    CHECK(write_test_file(path, wave, make_test_wave(wave, 3000)));
+    CHECK(sl_read_wave_memory(wave, sizeof(wave), &whole, 0) == SL_SUCCESS);
+    expected = (const SLuchar*) whole.dataChunk.waveformData;
+    CHECK(sl_open_wave_stream(path, &stream) == SL_SUCCESS);
+    CHECK(stream.frameCount == 3000 && stream.header.dataChunk.waveformData == NULL);
+
+    while (done < 3000) {
+        SLullong got = sl_read_wave_stream(&stream, frames + done, step);
+        CHECK(got > 0);
+        if (got == 0) break;
+        done += got;
+        step = step * 7 + 1;
+    }
+    CHECK(done == 3000 && memcmp(frames, expected, sizeof(frames)) == 0);
+    CHECK(sl_read_wave_stream(&stream, frames, 10) == 0);
+
+    CHECK(sl_seek_wave_stream(&stream, 2345) == SL_SUCCESS);
+    CHECK(sl_read_wave_stream(&stream, frames, 100) == 100);
+    CHECK(memcmp(frames, expected + 2 * 2345, 2 * 100) == 0);
+
+    CHECK(sl_seek_wave_stream(&stream, 10) == SL_SUCCESS);
+    CHECK(sl_read_wave_stream(&stream, frames, 1) == 1 && memcmp(frames, expected + 2 * 10, 2) == 0);
+
+    CHECK(sl_seek_wave_stream(&stream, 3000) == SL_SUCCESS);
+    CHECK(sl_read_wave_stream(&stream, frames, 1) == 0);
+    CHECK(sl_seek_wave_stream(&stream, 3001) == SL_INVALID_VALUE);
+
+    sl_close_wave_stream(&stream);
+    sl_cleanup_wave_file(&whole);
+    remove(path);
+}
+
+// the cache hands out one copy per path, keeps what is in use and throws out the least recently used rest once over budget
+static void check_cache(void) {
+    static const char* first = "sal_unit_test_cache1.wav";
+    static const char* second = "sal_unit_test_cache2.wav";
+    static SLuchar wave[44 + 2 * 1000];
+    SL_WAV_CACHE cache;
+    SL_WAV_CACHE_STATS stats;
+    SL_WAV_FILE copy;
+    SL_WAV_FILE* a;
+    SL_WAV_FILE* again;
+    SL_WAV_FILE* b;
+
+    CHECK(write_test_file(first, wave, make_test_wave(wave, 1000)));
+    CHECK(write_test_file(second, wave, make_test_wave(wave, 999)));
+
+    // room for one file, not two
+    CHECK(sl_create_wav_cache(&cache, 3000) == SL_SUCCESS);
+
+    CHECK(sl_cache_acquire(&cache, first, &a) == SL_SUCCESS);
+    CHECK(sl_cache_acquire(&cache, first, &again) == SL_SUCCESS);
+    CHECK(a == again && a->dataChunk.dataChunkSize == 2000);
+    CHECK(sl_read_wave_file(first, &copy) == SL_SUCCESS);
+    CHECK(memcmp(a->dataChunk.waveformData, copy.dataChunk.waveformData, 2000) == 0);
+    sl_cleanup_wave_file(&copy);
+
+    // both in use, so both stay even over budget
+    CHECK(sl_cache_acquire(&cache, second, &b) == SL_SUCCESS);
+    CHECK(b != a && b->dataChunk.dataChunkSize == 2 * 999);
+    sl_get_wav_cache_stats(&cache, &stats);
+    CHECK(stats.entryCount == 2 && stats.evictions == 0);
+
+    // the first is the least recently used, so it goes once nobody holds it
+    sl_cache_release(&cache, a);
+    sl_cache_release(&cache, again);
+    sl_cache_release(&cache, b);
+    sl_get_wav_cache_stats(&cache, &stats);
+    CHECK(stats.entryCount == 1 && stats.evictions == 1 && stats.bytes <= stats.budget);
+
+    CHECK(sl_cache_acquire(&cache, first, &a) == SL_SUCCESS);
+    CHECK(a->dataChunk.dataChunkSize == 2000);
+    sl_cache_release(&cache, a);
+
+    CHECK(sl_cache_acquire(&cache, "sal_unit_test_missing.wav", &a) != SL_SUCCESS && a == NULL);
+
+    sl_get_wav_cache_stats(&cache, &stats);
+    CHECK(stats.hits == 1 && stats.misses == 4 && stats.evictions == 2 && stats.entryCount == 1);
+
+    sl_destroy_wav_cache(&cache);
+    remove(first);
+    remove(second);
+}
+
+// a SL_IO of the caller's own over a block of memory, counting how often and how much it is read
+typedef struct {
+    const SLuchar* data;
+    SLllong size;
+    SLllong pos;
+    SLuint reads;
+    SLullong bytes;
+} TEST_IO;
+
+static SLullong test_io_read(SLvoid user, SLvoid dst, SLullong size) {
+    TEST_IO* io = (TEST_IO*) user;
+
+    io->reads++;
+    if (io->pos >= io->size) return 0;
+    if (size > (SLullong) (io->size - io->pos)) size = (SLullong) (io->size - io->pos);
+    memcpy(dst, io->data + io->pos, (size_t) size);
+    io->pos += (SLllong) size;
+    io->bytes += size;
+    return size;
+}
+
+static SLint test_io_seek(SLvoid user, SLllong offset, SLint origin) {
+    TEST_IO* io = (TEST_IO*) user;
+    SLllong base = origin == SEEK_SET ? 0 : origin == SEEK_CUR ? io->pos : io->size;
+
+    if (base + offset < 0) return -1;
+    io->pos = base + offset;
+    return 0;
+}
+
+static SLllong test_io_tell(SLvoid user) {
+    return ((TEST_IO*) user)->pos;
+}
+
+// memory, a FILE and callbacks of the caller's own all parse to the same samples. aliasing points into the caller's bytes
+static void check_memory_io(void) {
+    static const char* path = "sal_unit_test_io.wav";
+    static SLuchar wave[44 + 2 * 700];
+    SLullong size = make_test_wave(wave, 700);
+    TEST_IO user = { wave, (SLllong) size, 0, 0, 0 };
+    SL_IO io = { test_io_read, test_io_seek, test_io_tell, &user };
+    SL_WAV_FILE copied, aliased, custom, fromFile;
+    FILE* file;
+
+    CHECK(sl_read_wave_memory(wave, size, &copied, 0) == SL_SUCCESS);
+    CHECK(copied.storage == SL_STORAGE_OWNED && copied.dataChunk.waveformData != (SLvoid) (wave + 44));
+    CHECK(copied.dataChunk.dataChunkSize == 2 * 700 && copied.formatChunk.sampleRate == 22050);
+
+    CHECK(sl_read_wave_memory(wave, size, &aliased, 1) == SL_SUCCESS);
+    CHECK(aliased.storage == SL_STORAGE_BORROWED && aliased.dataChunk.waveformData == (SLvoid) (wave + 44));
+    CHECK(memcmp(aliased.dataChunk.waveformData, copied.dataChunk.waveformData, 2 * 700) == 0);
+
+    CHECK(sl_read_wave_io(&io, &custom) == SL_SUCCESS);
+    CHECK(user.reads > 0 && custom.dataChunk.dataChunkSize == 2 * 700);
+    CHECK(memcmp(custom.dataChunk.waveformData, copied.dataChunk.waveformData, 2 * 700) == 0);
+
+    CHECK(write_test_file(path, wave, size));
+    file = fopen(path, "rb");
+    CHECK(file != NULL);
+    if (file != NULL) {
+        sl_io_from_file(&io, file);
+        CHECK(sl_read_wave_io(&io, &fromFile) == SL_SUCCESS);
+        CHECK(memcmp(fromFile.dataChunk.waveformData, copied.dataChunk.waveformData, 2 * 700) == 0);
+        sl_cleanup_wave_file(&fromFile);
+        fclose(file);
+    }
+    remove(path);
+
+    // cleaning up a borrowed file leaves the caller's bytes alone
+    sl_cleanup_wave_file(&aliased);
+    CHECK(aliased.dataChunk.waveformData == NULL && wave[0] == 'R');
+
+    // samples cut short, whichever way they come in
+    CHECK(sl_read_wave_memory(wave, size - 1, &aliased, 1) != SL_SUCCESS);
+    CHECK(sl_read_wave_memory(wave, size - 1, &aliased, 0) != SL_SUCCESS);
+    CHECK(sl_read_wave_memory(NULL, size, &aliased, 0) == SL_INVALID_VALUE);
+
+    sl_cleanup_wave_file(&copied);
+    sl_cleanup_wave_file(&custom);
+}
+
+// a batch gives every file what a read of it alone gives, and one bad file only fails itself
+static void check_batch(void) {
+    static SLuchar wave[44 + 2 * 800];
+    static char names[8][40];
+    SLstr paths[8];
+    SL_WAV_FILE out[8];
+    SL_RETURN_CODE results[8];
+    SL_BATCH_OPTIONS opts = { 3 };
+
+    for (SLuint i = 0; i < 8; i++) {
+        sprintf(names[i], "sal_unit_test_batch%u.wav", i);
+        paths[i] = names[i];
+        // one left out on purpose
+        if (i != 5) CHECK(write_test_file(names[i], wave, make_test_wave(wave, 100 * (i + 1))));
+    }
+
+    CHECK(sl_read_wave_files(paths, 8, out, results, &opts) == SL_FAIL);
+    for (SLuint i = 0; i < 8; i++) {
+        SL_WAV_FILE alone;
+
+        if (i == 5) {
+            CHECK(results[i] != SL_SUCCESS && out[i].dataChunk.waveformData == NULL);
+            continue;
+        }
+
+        CHECK(results[i] == SL_SUCCESS && sl_read_wave_file(paths[i], &alone) == SL_SUCCESS);
+        CHECK(out[i].dataChunk.dataChunkSize == 2 * 100 * (i + 1) && out[i].dataChunk.dataChunkSize == alone.dataChunk.dataChunkSize);
+        CHECK(memcmp(out[i].dataChunk.waveformData, alone.dataChunk.waveformData, alone.dataChunk.dataChunkSize) == 0);
+        sl_cleanup_wave_file(&alone);
+    }
+    for (SLuint i = 0; i < 8; i++) sl_cleanup_wave_file(&out[i]);
+
+    // every file there, default threads
+    paths[5] = names[4];
+    CHECK(sl_read_wave_files(paths, 8, out, NULL, NULL) == SL_SUCCESS);
+    CHECK(out[5].dataChunk.dataChunkSize == out[4].dataChunk.dataChunkSize);
+    for (SLuint i = 0; i < 8; i++) sl_cleanup_wave_file(&out[i]);
+
+    CHECK(sl_read_wave_files(NULL, 8, out, NULL, NULL) == SL_INVALID_VALUE);
+
+    for (SLuint i = 0; i < 8; i++) remove(names[i]);
+}
+
+// stores a number in either byte order
+static void put_number(SLuchar* dst, SLullong value, SLuint size, SLbool big) {
+    for (SLuint i = 0; i < size; i++) dst[big ? size - 1 - i : i] = (SLuchar) (value >> (8 * i));
+}
+
+// a RIFX file is a RIFF file with every number flipped, so both have to come out as the same native samples
+static void check_rifx(void) {
+    static const SLushort formats[6][2] = { {1, 8}, {1, 16}, {1, 24}, {1, 32}, {3, 32}, {3, 64} };
+    static SLuchar files[2][44 + 8 * 2 * 301];
+    static SLullong samples[2 * 301];
+
+    for (SLuint f = 0; f < 6; f++) {
+        SLuint size = formats[f][1] / 8;
+        SLuint dataSize = size * 2 * 301;
+        SL_WAV_FILE little, big, aliased;
+
+        for (SLuint i = 0; i < 2 * 301; i++) {
+            if (formats[f][0] == 3 && size == 4) {
+                SLfloat v = ((SLint) test_random() - (1 << 23)) / (SLfloat) (1 << 23);
+                SLuint bits;
+                memcpy(&bits, &v, 4);
+                samples[i] = bits;
+            } else if (formats[f][0] == 3) {
+                SLdouble v = ((SLint) test_random() - (1 << 23)) / (SLdouble) (1 << 23);
+                memcpy(&samples[i], &v, 8);
+            } else {
+                samples[i] = ((SLullong) test_random() << 24) ^ test_random();
+            }
+        }
+
+        // stereo, an odd number of frames. the second file is the same one big endian
+        for (SLbool isBig = 0; isBig <= 1; isBig++) {
+            SLuchar* dst = files[isBig];
+
+            memcpy(dst, isBig ? "RIFX" : "RIFF", 4);
+            put_number(dst + 4, 36 + dataSize, 4, isBig);
+            memcpy(dst + 8, "WAVEfmt ", 8);
+            put_number(dst + 16, 16, 4, isBig);
+            put_number(dst + 20, formats[f][0], 2, isBig);
+            put_number(dst + 22, 2, 2, isBig);
+            put_number(dst + 24, 44100, 4, isBig);
+            put_number(dst + 28, 44100 * 2 * size, 4, isBig);
+            put_number(dst + 32, 2 * size, 2, isBig);
+            put_number(dst + 34, formats[f][1], 2, isBig);
+            memcpy(dst + 36, "data", 4);
+            put_number(dst + 40, dataSize, 4, isBig);
+            for (SLuint i = 0; i < 2 * 301; i++) put_number(dst + 44 + i * size, samples[i], size, isBig);
+        }
+
+        CHECK(sl_read_wave_memory(files[0], 44 + dataSize, &little, 0) == SL_SUCCESS);
+        CHECK(sl_read_wave_memory(files[1], 44 + dataSize, &big, 0) == SL_SUCCESS);
+        CHECK(big.descriptorChunk.endianness == SL_BIG_ENDIAN && little.descriptorChunk.endianness == SL_LITTLE_ENDIAN);
+        CHECK(big.dataChunk.pcmType == little.dataChunk.pcmType && big.formatChunk.sampleRate == 44100 && big.formatChunk.numChannels == 2);
+        CHECK(big.dataChunk.dataChunkSize == dataSize && memcmp(big.dataChunk.waveformData, little.dataChunk.waveformData, dataSize) == 0);
+
+        // can't point into bytes that need flipping
+        CHECK(sl_read_wave_memory(files[1], 44 + dataSize, &aliased, 1) == SL_SUCCESS);
+        CHECK(aliased.storage == SL_STORAGE_OWNED && memcmp(aliased.dataChunk.waveformData, little.dataChunk.waveformData, dataSize) == 0);
+
+        sl_cleanup_wave_file(&little);
+        sl_cleanup_wave_file(&big);
+        sl_cleanup_wave_file(&aliased);
+    }
+}
+
+// what the writer writes reads back the same, whole files and ones written a piece at a time
+static void check_writer(void) {
+    static const char* path = "sal_unit_test_write.wav";
+    static SLuchar wave[44 + 2 * 900], written[sizeof(wave)];
+    static SLuchar samples[3 * 5001];
+    SLullong size = make_test_wave(wave, 900);
+    SL_WAV_FILE original, back;
+    SL_WAV_WRITER writer;
+    FILE* file;
+
+    // the writer's header is the plain 44 byte one, so the whole file comes out byte for byte
+    CHECK(sl_read_wave_memory(wave, size, &original, 0) == SL_SUCCESS);
+    CHECK(sl_write_wave_file(path, &original) == SL_SUCCESS);
+    file = fopen(path, "rb");
+    CHECK(file != NULL);
+    if (file != NULL) {
+        CHECK(fread(written, 1, sizeof(written), file) == size && memcmp(written, wave, (size_t) size) == 0);
+        fclose(file);
+    }
+    CHECK(sl_read_wave_file(path, &back) == SL_SUCCESS);
+    CHECK(back.dataChunk.dataChunkSize == original.dataChunk.dataChunkSize &&
+          memcmp(back.dataChunk.waveformData, original.dataChunk.waveformData, original.dataChunk.dataChunkSize) == 0);
+    sl_cleanup_wave_file(&back);
+    sl_cleanup_wave_file(&original);
+
+    // 24 bit mono with an odd number of frames ends in a pad byte. direct where the file system lets it
+    for (SLuint i = 0; i < sizeof(samples); i++) samples[i] = (SLuchar) test_random();
+    CHECK(sl_open_wave_writer(&writer, path, SL_SIGNED_24PCM, 1, 96000, SL_WRITE_DIRECT) == SL_SUCCESS);
+    CHECK(sl_write_wave_frames(&writer, samples, 1) == SL_SUCCESS);
+    CHECK(sl_write_wave_frames(&writer, samples + 3, 3000) == SL_SUCCESS);
+    CHECK(sl_write_wave_frames(&writer, samples + 3 * 3001, 2000) == SL_SUCCESS);
+    CHECK(sl_close_wave_writer(&writer) == SL_SUCCESS);
+
+    CHECK(sl_read_wave_file(path, &back) == SL_SUCCESS);
+    CHECK(back.dataChunk.pcmType == SL_SIGNED_24PCM && back.formatChunk.sampleRate == 96000 && back.formatChunk.numChannels == 1);
+    CHECK(back.dataChunk.dataChunkSize == sizeof(samples) && memcmp(back.dataChunk.waveformData, samples, sizeof(samples)) == 0);
+    CHECK(back.descriptorChunk.descriptorChunkSize == 36 + sizeof(samples) + 1);
+    sl_cleanup_wave_file(&back);
+
+    // floats keep their format tag
+    CHECK(sl_open_wave_writer(&writer, path, SL_FLOAT_32PCM, 2, 48000, SL_WRITE_DEFAULT) == SL_SUCCESS);
+    CHECK(sl_write_wave_frames(&writer, samples, 1250) == SL_SUCCESS);
+    CHECK(sl_close_wave_writer(&writer) == SL_SUCCESS);
+    CHECK(sl_read_wave_file(path, &back) == SL_SUCCESS);
+    CHECK(back.dataChunk.pcmType == SL_FLOAT_32PCM && back.dataChunk.dataChunkSize == 1250 * 8 &&
+          memcmp(back.dataChunk.waveformData, samples, 1250 * 8) == 0);
+    sl_cleanup_wave_file(&back);
+
+    remove(path);
+}
+
+// probing gives the header a full read gives without the samples, wherever the chunks are
+static void check_probe(void) {
+    static const char* path = "sal_unit_test_probe.wav";
+    static SLuchar wave[44 + 2 * 3000], moved[sizeof(wave) + 12];
+    SLullong size = make_test_wave(wave, 3000);
+    SL_WAV_FILE probed, full;
+
+    CHECK(write_test_file(path, wave, size));
+    CHECK(sl_probe_wave_file(path, &probed) == SL_SUCCESS);
+    CHECK(sl_read_wave_file(path, &full) == SL_SUCCESS);
+    CHECK(probed.dataChunk.waveformData == NULL && probed.dataChunk.dataOffset == 44);
+    CHECK(probed.dataChunk.dataChunkSize == full.dataChunk.dataChunkSize && probed.dataChunk.pcmType == full.dataChunk.pcmType);
+    CHECK(memcmp(&probed.formatChunk, &full.formatChunk, sizeof(probed.formatChunk)) == 0);
+    sl_cleanup_wave_file(&full);
+
+    // a chunk nobody knows, then the samples, then the format
+    memcpy(moved, wave, 12);
+    memcpy(moved + 12, "junk", 4);
+    put_le(moved + 16, 4, 4);
+    memcpy(moved + 24, wave + 36, (size_t) (size - 36));
+    memcpy(moved + 24 + size - 36, wave + 12, 24);
+    put_le(moved + 4, (SLuint) (sizeof(moved) - 8), 4);
+    CHECK(write_test_file(path, moved, sizeof(moved)));
+    CHECK(sl_probe_wave_file(path, &full) == SL_SUCCESS);
+    CHECK(full.dataChunk.dataOffset == 32 && full.dataChunk.dataChunkSize == probed.dataChunk.dataChunkSize);
+    CHECK(memcmp(&probed.formatChunk, &full.formatChunk, sizeof(probed.formatChunk)) == 0);
+
+    // samples cut short fail the same way a read would
+    CHECK(write_test_file(path, wave, size - 100));
+    CHECK(sl_probe_wave_file(path, &full) != SL_SUCCESS);
+    CHECK(sl_read_wave_file(path, &full) != SL_SUCCESS);
+
+    remove(path);
+}
+
+// makes and removes the folders the catalog check walks
+static void make_test_dir(const char* path) {
+#ifdef _WIN32
+    CreateDirectoryA(path, NULL);
+#else
+    mkdir(path, 0755);
+#endif
+}
+
+static void remove_test_dir(const char* path) {
+#ifdef _WIN32
+    RemoveDirectoryA(path);
+#else
+    rmdir(path);
+#endif
+}
+
+// a catalog written from a folder reopens to the same headers a probe gives, and only changed files are parsed again
+static void check_catalog(void) {
+    static const char* index = "sal_unit_test.catalog";
+    static SLuchar wave[44 + 2 * 1200];
+    SL_CATALOG_SCAN_STATS stats;
+    SL_CATALOG catalog;
+    SL_WAV_FILE found, probed;
+
+    make_test_dir("sal_unit_test_catalog");
+    make_test_dir("sal_unit_test_catalog/sub");
+    CHECK(write_test_file("sal_unit_test_catalog/a.wav", wave, make_test_wave(wave, 500)));
+    CHECK(write_test_file("sal_unit_test_catalog/sub/b.wav", wave, make_test_wave(wave, 1200)));
+    CHECK(write_test_file("sal_unit_test_catalog/bad.wav", "RIFF????WAVE", 12));
+    CHECK(write_test_file("sal_unit_test_catalog/notes.txt", "not a sound", 11));
+
+    CHECK(sl_build_catalog("sal_unit_test_catalog", index, &stats) == SL_SUCCESS);
+    CHECK(stats.fileCount == 2 && stats.probed == 2 && stats.reused == 0 && stats.failed == 1);
+
+    CHECK(sl_open_catalog(&catalog, index) == SL_SUCCESS);
+    CHECK(catalog.entryCount == 2);
+    CHECK(sl_catalog_lookup(&catalog, "sub/b.wav", &found) == SL_SUCCESS);
+    CHECK(sl_probe_wave_file("sal_unit_test_catalog/sub/b.wav", &probed) == SL_SUCCESS);
+    CHECK(found.dataChunk.waveformData == NULL && found.dataChunk.dataOffset == probed.dataChunk.dataOffset);
+    CHECK(found.dataChunk.dataChunkSize == probed.dataChunk.dataChunkSize && found.dataChunk.pcmType == probed.dataChunk.pcmType);
+    CHECK(found.formatChunk.sampleRate == probed.formatChunk.sampleRate && found.formatChunk.numChannels == probed.formatChunk.numChannels);
+    CHECK(sl_catalog_lookup(&catalog, "a.wav", &found) == SL_SUCCESS && found.dataChunk.dataChunkSize == 2 * 500);
+    CHECK(sl_catalog_find(&catalog, "a.wav") != NULL && strcmp(sl_catalog_name(&catalog, sl_catalog_find(&catalog, "a.wav")), "a.wav") == 0);
+    CHECK(sl_catalog_lookup(&catalog, "bad.wav", &found) == SL_FAIL);
+    CHECK(sl_catalog_find(&catalog, "notes.txt") == NULL);
+    sl_close_catalog(&catalog);
+
+    // nothing changed, nothing opened
+    CHECK(sl_build_catalog("sal_unit_test_catalog", index, &stats) == SL_SUCCESS);
+    CHECK(stats.fileCount == 2 && stats.reused == 2 && stats.probed == 0);
+
+    // a new size is a change even within the same second
+    CHECK(write_test_file("sal_unit_test_catalog/a.wav", wave, make_test_wave(wave, 700)));
+    CHECK(sl_build_catalog("sal_unit_test_catalog", index, &stats) == SL_SUCCESS);
+    CHECK(stats.fileCount == 2 && stats.reused == 1 && stats.probed == 1);
+    CHECK(sl_open_catalog(&catalog, index) == SL_SUCCESS);
+    CHECK(sl_catalog_lookup(&catalog, "a.wav", &found) == SL_SUCCESS && found.dataChunk.dataChunkSize == 2 * 700);
+    sl_close_catalog(&catalog);
+
+    // anything else is not a catalog
+    CHECK(sl_open_catalog(&catalog, "sal_unit_test_catalog/notes.txt") == SL_INVALID_CATALOG);
+
+    remove("sal_unit_test_catalog/a.wav");
+    remove("sal_unit_test_catalog/sub/b.wav");
+    remove("sal_unit_test_catalog/bad.wav");
+    remove("sal_unit_test_catalog/notes.txt");
+    remove_test_dir("sal_unit_test_catalog/sub");
+    remove_test_dir("sal_unit_test_catalog");
+    remove(index);
+}
+
+// every file submitted to a loader comes back once, with what reading it alone gives, on io_uring and on the thread pool
+static void check_loader(void) {
+    static SLuchar wave[44 + 2 * 9000];
+    static char names[20][40];
+    static SLuint ids[20];
+    static const SLuint flags[2] = { SL_LOADER_DEFAULT, SL_LOADER_NO_URING };
+
+    for (SLuint i = 0; i < 20; i++) {
+        sprintf(names[i], "sal_unit_test_load%u.wav", i);
+        ids[i] = i;
+        // one missing, and some bigger than the first read of a header
+        if (i != 7) CHECK(write_test_file(names[i], wave, make_test_wave(wave, i % 4 == 0 ? 9000 : 50 * (i + 1))));
+    }
+
+    for (SLuint f = 0; f < 2; f++) {
+        SL_LOADER_OPTIONS opts = { 4, 2, flags[f] };
+        SL_LOADER_RESULT results[8];
+        SL_LOADER loader;
+        SLuint seen[20] = { 0 };
+        SLuint done = 0;
+
+        CHECK(sl_create_loader(&loader, &opts) == SL_SUCCESS);
+        for (SLuint i = 0; i < 20; i++) CHECK(sl_loader_submit(&loader, names[i], &ids[i]) == SL_SUCCESS);
+
+        while (sl_loader_pending(&loader) > 0) {
+            SLuint count = sl_loader_poll(&loader, results, 8, 1);
+
+            for (SLuint r = 0; r < count; r++) {
+                SLuint i = *(SLuint*) results[r].user;
+                SL_WAV_FILE alone;
+
+                CHECK(i < 20);
+                if (i >= 20) continue;
+                seen[i]++;
+                done++;
+
+                if (i == 7) {
+                    CHECK(results[r].result != SL_SUCCESS && results[r].file.dataChunk.waveformData == NULL);
+                    continue;
+                }
+
+                CHECK(results[r].result == SL_SUCCESS && sl_read_wave_file(names[i], &alone) == SL_SUCCESS);
+                CHECK(results[r].file.dataChunk.dataChunkSize == alone.dataChunk.dataChunkSize &&
+                      memcmp(results[r].file.dataChunk.waveformData, alone.dataChunk.waveformData, alone.dataChunk.dataChunkSize) == 0);
+                sl_cleanup_wave_file(&alone);
+                sl_cleanup_wave_file(&results[r].file);
+            }
+        }
+
+        CHECK(done == 20);
+        for (SLuint i = 0; i < 20; i++) CHECK(seen[i] == 1);
+        CHECK(sl_loader_poll(&loader, results, 8, 1) == 0);
+        sl_destroy_loader(&loader);
+    }
+
+    for (SLuint i = 0; i < 20; i++) remove(names[i]);
+}
+
+// a range is the same slice of frames a full read has, and only its own bytes are read to get it
+static void check_range(void) {
+    static const char* path = "sal_unit_test_range.wav";
+    static const SLullong ranges[6][2] = { {0, 1}, {0, 9000}, {1234, 500}, {8999, 1}, {8990, 100}, {4500, 4500} };
+    static SLuchar wave[44 + 2 * 9000];
+    SLullong size = make_test_wave(wave, 9000);
+    TEST_IO user = { wave, (SLllong) size, 0, 0, 0 };
+    SL_IO io = { test_io_read, test_io_seek, test_io_tell, &user };
+    SL_WAV_FILE full, range;
+
+    CHECK(write_test_file(path, wave, size));
+    CHECK(sl_read_wave_file(path, &full) == SL_SUCCESS);
+
+    for (SLuint i = 0; i < 6; i++) {
+        SLullong first = ranges[i][0];
+        // cut short at the end
+        SLullong count = first + ranges[i][1] > 9000 ? 9000 - first : ranges[i][1];
+
+        CHECK(sl_read_wave_range(path, first, ranges[i][1], &range) == SL_SUCCESS);
+        CHECK(range.dataChunk.dataChunkSize == 2 * count && range.dataChunk.dataOffset == 44 + 2 * first);
+        CHECK(range.formatChunk.sampleRate == 22050 && range.dataChunk.pcmType == SL_SIGNED_16PCM);
+        CHECK(memcmp(range.dataChunk.waveformData, (SLuchar*) full.dataChunk.waveformData + 2 * first, (size_t) (2 * count)) == 0);
+        sl_cleanup_wave_file(&range);
+    }
+
+    // seeks past the rest of the samples instead of reading them
+    CHECK(sl_read_wave_range_io(&io, 6000, 10, &range) == SL_SUCCESS);
+    CHECK(user.bytes < 44 + 2 * 10 + 64);
+    CHECK(memcmp(range.dataChunk.waveformData, (SLuchar*) full.dataChunk.waveformData + 2 * 6000, 2 * 10) == 0);
+    sl_cleanup_wave_file(&range);
+
+    CHECK(sl_read_wave_range(path, 9000, 1, &range) == SL_INVALID_VALUE);
+    CHECK(sl_read_wave_range(path, 10, 0, &range) == SL_INVALID_VALUE);
+
+    sl_cleanup_wave_file(&full);
+    remove(path);
+}
+
+// sounds that would open or close a device on the audio thread never get into the queue
+static void check_command_queue(void) {
+    SL_COMMAND_QUEUE queue;
+    SL_SOUND sound;
+
+    memset(&sound, 0, sizeof(sound));
+    CHECK(sl_create_command_queue(&queue, 4) == SL_SUCCESS);
+    CHECK(sl_queue_play_sound(&queue, &sound) == SL_INVALID_VALUE);
+    CHECK(sl_queue_stop_sound(&queue, &sound) == SL_INVALID_VALUE);
+    CHECK(sl_queue_set_gain(&queue, NULL, 0.5f) == SL_INVALID_VALUE);
+    CHECK(sl_run_commands(&queue) == 0);
+    sl_destroy_command_queue(&queue);
+}
+
+// sounds come back out of a bank unchanged, and a bank with a broken table is refused instead of read out of bounds
+static void check_bank(void) {
+    static const char* path = "sal_unit_test.bank";
+    static SLuchar wave[44 + 2 * 300];
+    SL_WAV_FILE first, second;
+    SL_BANK_WRITER writer;
+    SL_BANK bank;
+    SL_BANK_HEADER header;
+    SL_BANK_ENTRY entry;
+    SL_WAV_FILE* found;
+    FILE* file;
+
+    CHECK(sl_read_wave_memory(wave, make_test_wave(wave, 300), &first, 0) == SL_SUCCESS);
+    CHECK(sl_read_wave_memory(wave, make_test_wave(wave, 17), &second, 0) == SL_SUCCESS);
+
+    CHECK(sl_open_bank_writer(&writer, path) == SL_SUCCESS);
+    CHECK(sl_bank_writer_add(&writer, "first", &first) == SL_SUCCESS);
+    CHECK(sl_bank_writer_add(&writer, "second", &second) == SL_SUCCESS);
+    CHECK(sl_close_bank_writer(&writer) == SL_SUCCESS);
+
+    CHECK(sl_open_bank(&bank, path) == SL_SUCCESS);
+    CHECK(bank.entryCount == 2);
+    found = sl_bank_find(&bank, "first");
+    CHECK(found != NULL && found->dataChunk.dataChunkSize == first.dataChunk.dataChunkSize &&
+          memcmp(found->dataChunk.waveformData, first.dataChunk.waveformData, first.dataChunk.dataChunkSize) == 0);
+    found = sl_bank_find(&bank, "second");
+    CHECK(found != NULL && found->formatChunk.sampleRate == 22050 && found->dataChunk.dataChunkSize == second.dataChunk.dataChunkSize &&
+          memcmp(found->dataChunk.waveformData, second.dataChunk.waveformData, second.dataChunk.dataChunkSize) == 0);
+    CHECK(sl_bank_find(&bank, "third") == NULL);
+    sl_close_bank(&bank);
+
+    // an entry whose samples would start past the table
+    file = fopen(path, "r+b");
+    CHECK(file != NULL);
+    if (file != NULL) {
+        CHECK(fread(&header, sizeof(header), 1, file) == 1);
+        fseek(file, (long) header.tocOffset, SEEK_SET);
+        CHECK(fread(&entry, sizeof(entry), 1, file) == 1);
+        entry.dataOffset = (header.tocOffset / SL_BANK_ALIGN + 1) * SL_BANK_ALIGN;
+        fseek(file, (long) header.tocOffset, SEEK_SET);
+        CHECK(fwrite(&entry, sizeof(entry), 1, file) == 1);
+        fclose(file);
+    }
+    CHECK(sl_open_bank(&bank, path) == SL_INVALID_BANK);
+
+    // a bank cut short
+    CHECK(sl_open_bank_writer(&writer, path) == SL_SUCCESS);
+    CHECK(sl_bank_writer_add(&writer, "first", &first) == SL_SUCCESS);
+    CHECK(sl_close_bank_writer(&writer) == SL_SUCCESS);
+    file = fopen(path, "rb");
+    CHECK(file != NULL);
+    if (file != NULL) {
+        static SLuchar bytes[4 * SL_BANK_ALIGN];
+        size_t size = fread(bytes, 1, sizeof(bytes), file);
+        fclose(file);
+
+        file = fopen(path, "wb");
+        CHECK(file != NULL && size > 8);
+        if (file != NULL) {
+            fwrite(bytes, 1, size - 8, file);
+            fclose(file);
+        }
+    }
+    CHECK(sl_open_bank(&bank, path) == SL_INVALID_BANK);
+
+    remove(path);
+    sl_cleanup_wave_file(&first);
+    sl_cleanup_wave_file(&second);
+}
+
+// a ratio with more phases than the filter keeps still lands between them, and a resampled file says how big it is now
+static void check_resample(void) {
+    static SLfloat in[4000], out[4100];
+    static SLuchar wave[44 + 2 * 1000];
+    const SLdouble pi = 3.14159265358979323846;
+    SL_RESAMPLER resampler;
+    SL_WAV_FILE wavBuf, resampled;
+    SLdouble worst = 0;
+    SLullong made;
+
+    for (SLuint i = 0; i < 4000; i++) in[i] = (SLfloat) sin(2 * pi * 3000.0 * i / 44100);
+
+    CHECK(sl_create_resampler(&resampler, 44100, 44101, 1, SL_RESAMPLE_BEST) == SL_SUCCESS);
+    CHECK(resampler.up > SL_RESAMPLE_MAX_PHASES);
+    made = sl_resample(&resampler, in, 4000, out);
+    made += sl_flush_resampler(&resampler, out + made);
+    CHECK(made == 4001);
+
+    // away from the ends, where the filter sees the zeros before and after
+    for (SLullong i = 100; i + 100 < made; i++) {
+        SLdouble error = fabs(out[i] - sin(2 * pi * 3000.0 * i / 44101));
+        if (error > worst) worst = error;
+    }
+    CHECK(worst < 1e-4);
+    sl_destroy_resampler(&resampler);
+
+    CHECK(sl_read_wave_memory(wave, make_test_wave(wave, 1000), &wavBuf, 0) == SL_SUCCESS);
+    CHECK(sl_resample_wave_file(&wavBuf, 44100, SL_RESAMPLE_FAST, &resampled) == SL_SUCCESS);
+    CHECK(resampled.formatChunk.sampleRate == 44100 && resampled.dataChunk.dataChunkSize == 2 * 2000);
+    CHECK(resampled.descriptorChunk.descriptorChunkSize == 4 + 8 + 16 + 8 + 2 * 2000);
+    sl_cleanup_wave_file(&resampled);
+    sl_cleanup_wave_file(&wavBuf);
+}
+
+// two mono IMA ADPCM blocks of 9 frames, worked out by hand from the step and index tables. the second one clamps at full scale
+static void check_adpcm_decode(void) {
+    static const SLshort expected[18] = {
+        0, 11, 41, 104, 240, 221, 238, -5, 237,
+        32700, 32767, -28669, -24574, -20850, -17465, -14388, -11590, -9047
+    };
+    static const SLuchar blocks[16] = {
+        0x00, 0x00, 0, 0, 0x77, 0x77, 0x08, 0x3f,
+        0xbc, 0x7f, 88, 0, 0xf7, 0x00, 0x00, 0x00
+    };
+    static const char* path = "sal_unit_test_adpcm.wav";
+    SLuchar wave[48 + sizeof(blocks)];
+    SLuchar buffer[sizeof(expected)];
+    SLshort out[18];
+    SL_ADPCM_DECODER decoder;
+    SL_MEMORY_IO mem;
+    SL_IO io;
+    SL_WAV_FILE wavBuf;
+    FILE* file;
+
+    memcpy(wave, "RIFF", 4);
+    put_le(wave + 4, 40 + sizeof(blocks), 4);
+    memcpy(wave + 8, "WAVEfmt ", 8);
+    put_le(wave + 16, 20, 4);
+    put_le(wave + 20, 0x11, 2);
+    put_le(wave + 22, 1, 2);
+    put_le(wave + 24, 8000, 4);
+    put_le(wave + 28, 8000 * 8 / 9, 4);
+    put_le(wave + 32, 8, 2);
+    put_le(wave + 34, 4, 2);
+    put_le(wave + 36, 2, 2);
+    put_le(wave + 38, 9, 2);
+    memcpy(wave + 40, "data", 4);
+    put_le(wave + 44, sizeof(blocks), 4);
+    memcpy(wave + 48, blocks, sizeof(blocks));
+
+    // asked to stay compressed
+    sl_io_from_memory(&io, &mem, wave, sizeof(wave));
+    CHECK(sl_read_wave_io_b(&io, &wavBuf, SL_READ_KEEP_COMPRESSED) == SL_SUCCESS);
+    CHECK(wavBuf.dataChunk.pcmType == SL_IMA_ADPCM && sl_wave_frame_count(&wavBuf) == 18);
+    CHECK(sl_decode_adpcm(&wavBuf, NULL, 0, out, 18) == 18);
+    CHECK(memcmp(out, expected, sizeof(expected)) == 0);
+
+    // starting inside a block, then carrying on with the same decoder
+    memset(&decoder, 0, sizeof(decoder));
+    CHECK(sl_decode_adpcm(&wavBuf, &decoder, 3, out, 4) == 4);
+    CHECK(sl_decode_adpcm(&wavBuf, &decoder, 7, out + 4, 20) == 11);
+    CHECK(memcmp(out, expected + 3, 15 * sizeof(SLshort)) == 0);
+    sl_cleanup_wave_file(&wavBuf);
+
+    // every other way in decodes it, aliased and mapped ones into a buffer of their own
+    for (SLbool alias = 0; alias <= 1; alias++) {
+        CHECK(sl_read_wave_memory(wave, sizeof(wave), &wavBuf, alias) == SL_SUCCESS);
+        CHECK(wavBuf.dataChunk.pcmType == SL_SIGNED_16PCM && wavBuf.dataChunk.dataChunkSize == sizeof(expected));
+        CHECK(wavBuf.storage == SL_STORAGE_OWNED && wavBuf.dataChunk.waveformData != (SLvoid) (wave + 48));
+        CHECK(memcmp(wavBuf.dataChunk.waveformData, expected, sizeof(expected)) == 0);
+        sl_cleanup_wave_file(&wavBuf);
+    }
+
+    // a range across both blocks comes back decoded
+    sl_io_from_memory(&io, &mem, wave, sizeof(wave));
+    CHECK(sl_read_wave_range_io(&io, 5, 10, &wavBuf) == SL_SUCCESS);
+    CHECK(wavBuf.dataChunk.pcmType == SL_SIGNED_16PCM && wavBuf.dataChunk.dataChunkSize == 10 * sizeof(SLshort));
+    CHECK(memcmp(wavBuf.dataChunk.waveformData, expected + 5, 10 * sizeof(SLshort)) == 0);
+    sl_cleanup_wave_file(&wavBuf);
+
+    file = fopen(path, "wb");
+    CHECK(file != NULL);
+    if (file == NULL) return;
+    CHECK(fwrite(wave, 1, sizeof(wave), file) == sizeof(wave));
+    fclose(file);
+
+    CHECK(sl_map_wave_file(path, &wavBuf, SL_MAP_ADVICE_NORMAL) == SL_SUCCESS);
+    CHECK(wavBuf.dataChunk.pcmType == SL_SIGNED_16PCM && wavBuf.storage == SL_STORAGE_OWNED);
+    CHECK(memcmp(wavBuf.dataChunk.waveformData, expected, sizeof(expected)) == 0);
+    sl_cleanup_wave_file(&wavBuf);
+
+    // a caller's buffer has nowhere to decode from
+    CHECK(sl_read_wave_file_into(path, &wavBuf, buffer, sizeof(buffer)) == SL_INVALID_CHUNK_FMT_AUDIO_FORMAT);
+    CHECK(wavBuf.dataChunk.waveformData == NULL);
+
+    remove(path);
+}
+
+int main(void) {
+    check_simd_parity();
+    check_map();
+    check_stream();
+    check_cache();
+    check_memory_io();
+    check_batch();
+    check_rifx();
+    check_writer();
+    check_probe();
+    check_catalog();
+    check_loader();
+    check_range();
+    check_bank();
+    check_resample();
+    check_command_queue();
+    check_adpcm_decode();
+
+    if (failures == 0) printf("All checks passed.\n");
+    return failures == 0 ? 0 : 1;
+}
+
+#elif defined(PARSER_TEST)
 int main(void) {
     SL_RETURN_CODE out = SL_FAIL;
     SL_WAV_FILE buf;